@@ -20,34 +20,30 @@
  */
 
 #include <float.h>
+#include <string.h>
 #include "animation.h"
+#include "easinglut.h"
 #include "log.h"
 #include "math_utils.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "utils.h"
 
-static int get_kf_id(struct ngl_node * const *animkf, int nb_animkf, int start, double t)
+static inline double get_kf_time(struct ngl_node * const *animkf, int i)
 {
-    int ret = -1;
-
-    for (int i = start; i < nb_animkf; i++) {
-        const struct animkeyframe_priv *kf = animkf[i]->priv_data;
-        if (kf->time > t)
-            break;
-        ret = i;
-    }
-    return ret;
+    const struct animkeyframe_priv *kf = animkf[i]->priv_data;
+    return kf->time;
 }
 
+NGLI_DEFINE_MONOTONIC_SEARCH_FUNC(get_kf_id, struct ngl_node * const *, double, get_kf_time)
+
 int ngli_animation_evaluate(struct animation *s, void *dst, double t)
 {
     struct ngl_node * const *animkf = s->kfs;
     const int nb_animkf = s->nb_kfs;
     if (!nb_animkf)
         return 0;
-    int kf_id = get_kf_id(animkf, nb_animkf, s->current_kf, t);
-    if (kf_id < 0)
-        kf_id = get_kf_id(animkf, nb_animkf, 0, t);
+    const int kf_id = get_kf_id(animkf, nb_animkf, s->current_kf, t);
     if (kf_id >= 0 && kf_id < nb_animkf - 1) {
         const struct animkeyframe_priv *kf0 = animkf[kf_id    ]->priv_data;
         const struct animkeyframe_priv *kf1 = animkf[kf_id + 1]->priv_data;
@@ -55,11 +51,16 @@ int ngli_animation_evaluate(struct animation *s, void *dst, double t)
         const double t1 = kf1->time;
 
         double tnorm = NGLI_LINEAR_INTERP(t0, t1, t);
-        if (kf1->scale_boundaries)
-            tnorm = (kf1->offsets[1] - kf1->offsets[0]) * tnorm + kf1->offsets[0];
-        double ratio = kf1->function(tnorm, kf1->nb_args, kf1->args);
-        if (kf1->scale_boundaries)
-            ratio = NGLI_LINEAR_INTERP(kf1->boundaries[0], kf1->boundaries[1], ratio);
+        double ratio;
+        if (kf1->lut) {
+            ratio = ngli_easinglut_evaluate(kf1->lut, tnorm);
+        } else {
+            if (kf1->scale_boundaries)
+                tnorm = (kf1->offsets[1] - kf1->offsets[0]) * tnorm + kf1->offsets[0];
+            ratio = kf1->function(tnorm, kf1->nb_args, kf1->args);
+            if (kf1->scale_boundaries)
+                ratio = NGLI_LINEAR_INTERP(kf1->boundaries[0], kf1->boundaries[1], ratio);
+        }
 
         s->current_kf = kf_id;
         s->mix_func(s->user_arg, dst, kf0, kf1, ratio);
@@ -72,6 +73,43 @@ int ngli_animation_evaluate(struct animation *s, void *dst, double t)
     return 0;
 }
 
+static int same_kf_values(const struct animkeyframe_priv *kf0,
+                          const struct animkeyframe_priv *kf1)
+{
+    return kf0->scalar == kf1->scalar &&
+           !memcmp(kf0->value, kf1->value, sizeof(kf0->value)) &&
+           kf0->data_size == kf1->data_size &&
+           (!kf0->data_size || !memcmp(kf0->data, kf1->data, kf0->data_size));
+}
+
+/*
+ * Restrict the range to the time interval around t over which the animation
+ * value does not change: before the first key frame, after the last one, or
+ * between two key frames holding the same value.
+ */
+void ngli_animation_get_invariance(const struct animation *s, double t, double *range)
+{
+    struct ngl_node * const *animkf = s->kfs;
+    const int nb_animkf = s->nb_kfs;
+    if (!nb_animkf)
+        return;
+    const int kf_id = get_kf_id(animkf, nb_animkf, s->current_kf, t);
+    if (kf_id < 0) {
+        range[1] = NGLI_MIN(range[1], get_kf_time(animkf, 0));
+    } else if (kf_id == nb_animkf - 1) {
+        range[0] = NGLI_MAX(range[0], get_kf_time(animkf, kf_id));
+    } else {
+        const struct animkeyframe_priv *kf0 = animkf[kf_id    ]->priv_data;
+        const struct animkeyframe_priv *kf1 = animkf[kf_id + 1]->priv_data;
+        if (same_kf_values(kf0, kf1)) {
+            range[0] = NGLI_MAX(range[0], kf0->time);
+            range[1] = NGLI_MIN(range[1], kf1->time);
+        } else {
+            range[0] = range[1] = t;
+        }
+    }
+}
+
 int ngli_animation_init(struct animation *s, void *user_arg,
                         struct ngl_node * const *kfs, int nb_kfs,
                         ngli_animation_mix_func_type mix_func,
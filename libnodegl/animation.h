@@ -49,5 +49,6 @@ int ngli_animation_init(struct animation *s, void *user_arg,
                         ngli_animation_cpy_func_type cpy_func);
 
 int ngli_animation_evaluate(struct animation *s, void *dst, double t);
+void ngli_animation_get_invariance(const struct animation *s, double t, double *range);
 
 #endif
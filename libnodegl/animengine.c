@@ -0,0 +1,403 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "animengine.h"
+#include "easinglut.h"
+#include "log.h"
+#include "math_utils.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "utils.h"
+
+struct animengine_anim {
+    struct ngl_node *node;
+    float *dst;
+    int nb_comps;
+    int kf_offset;
+    int nb_kfs;
+    int current_kf;
+};
+
+struct animengine_easing {
+    easing_function function;
+    int nb_args;
+    const double *args;
+    int scale_boundaries;
+    double offsets[2];
+    double boundaries[2];
+    const struct easinglut *lut;
+};
+
+struct animengine_update {
+    struct ngl_node *node;
+    int wave;
+    int ret;
+};
+
+static int get_nb_comps(int class_id)
+{
+    switch (class_id) {
+    case NGL_NODE_ANIMATEDFLOAT: return 1;
+    case NGL_NODE_ANIMATEDVEC2:  return 2;
+    case NGL_NODE_ANIMATEDVEC3:  return 3;
+    case NGL_NODE_ANIMATEDVEC4:  return 4;
+    }
+    return 0;
+}
+
+static int is_cpu_update(int class_id)
+{
+    switch (class_id) {
+    case NGL_NODE_ANIMATEDTIME:
+    case NGL_NODE_ANIMATEDQUAT:
+    case NGL_NODE_ANIMATEDBUFFERFLOAT:
+    case NGL_NODE_ANIMATEDBUFFERVEC2:
+    case NGL_NODE_ANIMATEDBUFFERVEC3:
+    case NGL_NODE_ANIMATEDBUFFERVEC4:
+    case NGL_NODE_STREAMEDINT:
+    case NGL_NODE_STREAMEDIVEC2:
+    case NGL_NODE_STREAMEDIVEC3:
+    case NGL_NODE_STREAMEDIVEC4:
+    case NGL_NODE_STREAMEDUINT:
+    case NGL_NODE_STREAMEDUIVEC2:
+    case NGL_NODE_STREAMEDUIVEC3:
+    case NGL_NODE_STREAMEDUIVEC4:
+    case NGL_NODE_STREAMEDFLOAT:
+    case NGL_NODE_STREAMEDVEC2:
+    case NGL_NODE_STREAMEDVEC3:
+    case NGL_NODE_STREAMEDVEC4:
+    case NGL_NODE_STREAMEDMAT4:
+    case NGL_NODE_STREAMEDBUFFERINT:
+    case NGL_NODE_STREAMEDBUFFERIVEC2:
+    case NGL_NODE_STREAMEDBUFFERIVEC3:
+    case NGL_NODE_STREAMEDBUFFERIVEC4:
+    case NGL_NODE_STREAMEDBUFFERUINT:
+    case NGL_NODE_STREAMEDBUFFERUIVEC2:
+    case NGL_NODE_STREAMEDBUFFERUIVEC3:
+    case NGL_NODE_STREAMEDBUFFERUIVEC4:
+    case NGL_NODE_STREAMEDBUFFERFLOAT:
+    case NGL_NODE_STREAMEDBUFFERVEC2:
+    case NGL_NODE_STREAMEDBUFFERVEC3:
+    case NGL_NODE_STREAMEDBUFFERVEC4:
+    case NGL_NODE_STREAMEDBUFFERMAT4:
+        return 1;
+    }
+    return 0;
+}
+
+static inline double get_time(const double *times, int i)
+{
+    return times[i];
+}
+
+NGLI_DEFINE_MONOTONIC_SEARCH_FUNC(get_kf_id, const double *, double, get_time)
+
+void ngli_animengine_init(struct animengine *s)
+{
+    ngli_darray_init(&s->nodes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->anims, sizeof(struct animengine_anim), 0);
+    ngli_darray_init(&s->times, sizeof(double), 0);
+    ngli_darray_init(&s->values, 4 * sizeof(double), 0);
+    ngli_darray_init(&s->easings, sizeof(struct animengine_easing), 0);
+    ngli_darray_init(&s->updates, sizeof(struct animengine_update), 0);
+    ngli_darray_init(&s->waves, sizeof(int), 0);
+    s->packed = 0;
+}
+
+int ngli_animengine_register(struct animengine *s, struct ngl_node *node)
+{
+    ngli_assert(get_nb_comps(node->class->id) || is_cpu_update(node->class->id));
+    if (!ngli_darray_push(&s->nodes, &node))
+        return NGL_ERROR_MEMORY;
+    s->packed = 0;
+    return 0;
+}
+
+void ngli_animengine_unregister(struct animengine *s, struct ngl_node *node)
+{
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes);
+    for (int i = 0; i < ngli_darray_count(&s->nodes); i++) {
+        if (nodes[i] == node) {
+            ngli_darray_remove(&s->nodes, i);
+            s->packed = 0;
+            return;
+        }
+    }
+}
+
+static int pack_animation(struct animengine *s, struct ngl_node *node)
+{
+    struct variable_priv *priv = node->priv_data;
+    const struct animengine_anim anim = {
+        .node      = node,
+        .dst       = priv->data,
+        .nb_comps  = get_nb_comps(node->class->id),
+        .kf_offset = ngli_darray_count(&s->times),
+        .nb_kfs    = priv->nb_animkf,
+    };
+    if (!ngli_darray_push(&s->anims, &anim))
+        return NGL_ERROR_MEMORY;
+
+    for (int i = 0; i < priv->nb_animkf; i++) {
+        const struct animkeyframe_priv *kf = priv->animkf[i]->priv_data;
+        double value[4] = {0};
+        if (anim.nb_comps == 1) {
+            value[0] = kf->scalar;
+        } else {
+            for (int c = 0; c < anim.nb_comps; c++)
+                value[c] = kf->value[c];
+        }
+        const struct animengine_easing easing = {
+            .function         = kf->function,
+            .nb_args          = kf->nb_args,
+            .args             = kf->args,
+            .scale_boundaries = kf->scale_boundaries,
+            .offsets          = {kf->offsets[0], kf->offsets[1]},
+            .boundaries       = {kf->boundaries[0], kf->boundaries[1]},
+            .lut              = kf->lut,
+        };
+        if (!ngli_darray_push(&s->times, &kf->time) ||
+            !ngli_darray_push(&s->values, value) ||
+            !ngli_darray_push(&s->easings, &easing))
+            return NGL_ERROR_MEMORY;
+    }
+    return 0;
+}
+
+/*
+ * A node is updated in the wave following the ones of all its registered
+ * descendants, which are thus already updated for the current time when its
+ * own update runs.
+ */
+static int get_wave(const struct ngl_node *node)
+{
+    int wave = 0;
+    const struct darray *children_array = &node->children;
+    struct ngl_node **children = ngli_darray_data(children_array);
+    for (int i = 0; i < ngli_darray_count(children_array); i++) {
+        const struct ngl_node *child = children[i];
+        if (is_cpu_update(child->class->id))
+            wave = NGLI_MAX(wave, get_wave(child) + 1);
+    }
+    return wave;
+}
+
+static int cmp_update(const void *a, const void *b)
+{
+    const struct animengine_update *u0 = a;
+    const struct animengine_update *u1 = b;
+    return u0->wave - u1->wave;
+}
+
+static int pack_updates(struct animengine *s)
+{
+    ngli_darray_clear(&s->updates);
+    ngli_darray_clear(&s->waves);
+
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes);
+    for (int i = 0; i < ngli_darray_count(&s->nodes); i++) {
+        struct ngl_node *node = nodes[i];
+        if (!is_cpu_update(node->class->id))
+            continue;
+        const struct animengine_update update = {.node = node, .wave = get_wave(node)};
+        if (!ngli_darray_push(&s->updates, &update))
+            return NGL_ERROR_MEMORY;
+    }
+
+    struct animengine_update *updates = ngli_darray_data(&s->updates);
+    const int nb_updates = ngli_darray_count(&s->updates);
+    qsort(updates, nb_updates, sizeof(*updates), cmp_update);
+
+    for (int i = 0; i < nb_updates; i++) {
+        if (i == nb_updates - 1 || updates[i].wave != updates[i + 1].wave) {
+            const int end = i + 1;
+            if (!ngli_darray_push(&s->waves, &end))
+                return NGL_ERROR_MEMORY;
+        }
+    }
+    return 0;
+}
+
+static int pack_animations(struct animengine *s)
+{
+    ngli_darray_clear(&s->anims);
+    ngli_darray_clear(&s->times);
+    ngli_darray_clear(&s->values);
+    ngli_darray_clear(&s->easings);
+
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes);
+    for (int i = 0; i < ngli_darray_count(&s->nodes); i++) {
+        if (!get_nb_comps(nodes[i]->class->id))
+            continue;
+        int ret = pack_animation(s, nodes[i]);
+        if (ret < 0)
+            return ret;
+    }
+
+    int ret = pack_updates(s);
+    if (ret < 0)
+        return ret;
+
+    LOG(DEBUG, "packed %d animations with a total of %d key frames, "
+        "and %d other nodes in %d waves",
+        ngli_darray_count(&s->anims), ngli_darray_count(&s->times),
+        ngli_darray_count(&s->updates), ngli_darray_count(&s->waves));
+    s->packed = 1;
+    return 0;
+}
+
+/*
+ * This mirrors ngli_animation_evaluate() and the mix/copy functions of the
+ * animated nodes, using the packed key frames instead of the node private
+ * data.
+ */
+static void evaluate_animation(struct animengine_anim *anim,
+                               const double *times,
+                               const double (*values)[4],
+                               const struct animengine_easing *easings,
+                               double t)
+{
+    const double *kf_times = times + anim->kf_offset;
+    const double (*kf_values)[4] = values + anim->kf_offset;
+    const int nb_kfs = anim->nb_kfs;
+    const int kf_id = get_kf_id(kf_times, nb_kfs, anim->current_kf, t);
+    if (kf_id >= 0 && kf_id < nb_kfs - 1) {
+        const struct animengine_easing *easing = &easings[anim->kf_offset + kf_id + 1];
+        const double *v0 = kf_values[kf_id];
+        const double *v1 = kf_values[kf_id + 1];
+
+        double tnorm = NGLI_LINEAR_INTERP(kf_times[kf_id], kf_times[kf_id + 1], t);
+        double ratio;
+        if (easing->lut) {
+            ratio = ngli_easinglut_evaluate(easing->lut, tnorm);
+        } else {
+            if (easing->scale_boundaries)
+                tnorm = (easing->offsets[1] - easing->offsets[0]) * tnorm + easing->offsets[0];
+            ratio = easing->function(tnorm, easing->nb_args, easing->args);
+            if (easing->scale_boundaries)
+                ratio = NGLI_LINEAR_INTERP(easing->boundaries[0], easing->boundaries[1], ratio);
+        }
+
+        anim->current_kf = kf_id;
+        for (int c = 0; c < anim->nb_comps; c++)
+            anim->dst[c] = NGLI_MIX(v0[c], v1[c], ratio);
+    } else {
+        const double *v = t < kf_times[0] ? kf_values[0] : kf_values[nb_kfs - 1];
+        for (int c = 0; c < anim->nb_comps; c++)
+            anim->dst[c] = v[c];
+    }
+}
+
+#define ANIMS_PER_JOB 64
+
+struct evaluate_params {
+    struct animengine *s;
+    double t;
+    struct animengine_update *updates;
+};
+
+static void evaluate_animations(void *user_arg, int job_id)
+{
+    const struct evaluate_params *params = user_arg;
+    const struct animengine *s = params->s;
+    const double t = params->t;
+
+    const double *times = ngli_darray_data(&s->times);
+    const double (*values)[4] = ngli_darray_data(&s->values);
+    const struct animengine_easing *easings = ngli_darray_data(&s->easings);
+    struct animengine_anim *anims = ngli_darray_data(&s->anims);
+    const int start = job_id * ANIMS_PER_JOB;
+    const int end = NGLI_MIN(start + ANIMS_PER_JOB, ngli_darray_count(&s->anims));
+    for (int i = start; i < end; i++) {
+        struct animengine_anim *anim = &anims[i];
+        struct ngl_node *node = anim->node;
+        if (!node->is_active || node->visit_time != t ||
+            !anim->nb_kfs || node->last_update_time == t)
+            continue;
+
+        /* Flag the node as updated so ngli_node_update() skips it */
+        if (ngli_node_is_invariant(node, t)) {
+            node->last_update_time = t;
+            continue;
+        }
+        evaluate_animation(anim, times, values, easings, t);
+        node->last_update_time = t;
+        node->last_eval_time = t;
+        node->draw_count = 0;
+        ngli_node_update_invariance(node, t);
+    }
+}
+
+static void update_node(void *user_arg, int job_id)
+{
+    const struct evaluate_params *params = user_arg;
+    struct animengine_update *update = &params->updates[job_id];
+    struct ngl_node *node = update->node;
+
+    update->ret = 0;
+    if (!node->is_active || node->visit_time != params->t)
+        return;
+    update->ret = ngli_node_update(node, params->t);
+}
+
+int ngli_animengine_evaluate(struct animengine *s, struct workpool *workpool, double t)
+{
+    if (!s->packed) {
+        int ret = pack_animations(s);
+        if (ret < 0)
+            return ret;
+    }
+
+    struct evaluate_params params = {.s = s, .t = t};
+
+    const int nb_anims = ngli_darray_count(&s->anims);
+    const int nb_jobs = (nb_anims + ANIMS_PER_JOB - 1) / ANIMS_PER_JOB;
+    ngli_workpool_run(workpool, evaluate_animations, &params, nb_jobs);
+
+    struct animengine_update *updates = ngli_darray_data(&s->updates);
+    const int *waves = ngli_darray_data(&s->waves);
+    int start = 0;
+    for (int i = 0; i < ngli_darray_count(&s->waves); i++) {
+        const int end = waves[i];
+        params.updates = updates + start;
+        ngli_workpool_run(workpool, update_node, &params, end - start);
+        for (int j = start; j < end; j++)
+            if (updates[j].ret < 0)
+                return updates[j].ret;
+        start = end;
+    }
+    return 0;
+}
+
+void ngli_animengine_reset(struct animengine *s)
+{
+    ngli_darray_reset(&s->nodes);
+    ngli_darray_reset(&s->anims);
+    ngli_darray_reset(&s->times);
+    ngli_darray_reset(&s->values);
+    ngli_darray_reset(&s->easings);
+    ngli_darray_reset(&s->updates);
+    ngli_darray_reset(&s->waves);
+    s->packed = 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef ANIMENGINE_H
+#define ANIMENGINE_H
+
+#include "darray.h"
+#include "nodegl.h"
+#include "workpool.h"
+
+/*
+ * Evaluates all the scalar and vector animations of a context in a single
+ * pass. The key frames of the registered animations are packed into
+ * contiguous arrays (times, values and easings) the first time they are
+ * evaluated after the set of animations changed.
+ *
+ * The other registered nodes are the ones with an update only made of CPU
+ * computations on their own data (time and quaternion animations, animated
+ * buffers and streamed values). Their update is run ahead of the scene
+ * update, sorted in waves where every node only depends on nodes of the
+ * previous waves, so each wave can be spread over a work pool.
+ */
+struct animengine {
+    struct darray nodes;    // struct ngl_node *, registered animated nodes
+    int packed;
+    struct darray anims;    // struct animengine_anim, one per registered scalar or vector animation
+    struct darray times;    // double, key frame times of all the animations
+    struct darray values;   // double[4], key frame values of all the animations
+    struct darray easings;  // struct animengine_easing, one per key frame
+    struct darray updates;  // struct animengine_update, other registered nodes sorted by wave
+    struct darray waves;    // int, end offset of each wave in updates
+};
+
+void ngli_animengine_init(struct animengine *s);
+int ngli_animengine_register(struct animengine *s, struct ngl_node *node);
+void ngli_animengine_unregister(struct animengine *s, struct ngl_node *node);
+int ngli_animengine_evaluate(struct animengine *s, struct workpool *workpool, double t);
+void ngli_animengine_reset(struct animengine *s);
+
+#endif
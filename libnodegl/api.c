@@ -33,7 +33,9 @@
 #include "jni_utils.h"
 #endif
 
+#include "animengine.h"
 #include "darray.h"
+#include "easinglut.h"
 #include "gctx.h"
 #include "graphicstate.h"
 #include "log.h"
@@ -42,7 +44,9 @@
 #include "nodegl.h"
 #include "nodes.h"
 #include "pgcache.h"
+#include "texturepool.h"
 #include "rnode.h"
+#include "workpool.h"
 
 #if defined(HAVE_VAAPI)
 #include "vaapi.h"
@@ -87,7 +91,10 @@ static int cmd_stop(struct ngl_ctx *s, void *arg)
 #endif
     ngli_texture_freep(&s->font_atlas); // allocated by the first node text
     ngli_pgcache_reset(&s->pgcache);
+    ngli_texturepool_reset(&s->texturepool);
     ngli_hud_freep(&s->hud);
+    ngli_workpool_freep(&s->workpool);
+    s->has_drawn_frame = 0;
     ngli_gctx_freep(&s->gctx);
 
     return 0;
@@ -133,6 +140,16 @@ static int cmd_configure(struct ngl_ctx *s, void *arg)
     if (ret < 0)
         return ret;
 
+    ret = ngli_texturepool_init(&s->texturepool, s->gctx, config->texture_pool_size);
+    if (ret < 0)
+        return ret;
+
+    if (config->update_threads > 1) {
+        s->workpool = ngli_workpool_create(config->update_threads);
+        if (!s->workpool)
+            return NGL_ERROR_MEMORY;
+    }
+
 #if defined(HAVE_VAAPI)
     ret = ngli_vaapi_init(s);
     if (ret < 0)
@@ -153,6 +170,7 @@ static int cmd_configure(struct ngl_ctx *s, void *arg)
         return NGL_ERROR_MEMORY;
 
     if (s->scene) {
+        s->prepare_generation++;
         ret = ngli_node_attach_ctx(s->scene, s);
         if (ret < 0) {
             ngli_node_detach_ctx(s->scene, s);
@@ -184,6 +202,7 @@ struct resize_params {
 static int cmd_resize(struct ngl_ctx *s, void *arg)
 {
     const struct resize_params *params = arg;
+    s->has_drawn_frame = 0;
     return ngli_gctx_resize(s->gctx, params->width, params->height, params->viewport);
 }
 
@@ -191,6 +210,8 @@ static int cmd_set_capture_buffer(struct ngl_ctx *s, void *capture_buffer)
 {
     struct ngl_config *config = &s->config;
 
+    s->has_drawn_frame = 0;
+
     int ret = ngli_gctx_set_capture_buffer(s->gctx, capture_buffer);
     if (ret < 0) {
         if (s->scene) {
@@ -209,26 +230,49 @@ static int cmd_set_capture_buffer(struct ngl_ctx *s, void *capture_buffer)
 
 static int cmd_set_scene(struct ngl_ctx *s, void *arg)
 {
-    if (s->scene) {
-        ngli_node_detach_ctx(s->scene, s);
-        ngl_node_unrefp(&s->scene);
-    }
+    s->has_drawn_frame = 0;
+
     ngli_rnode_clear(&s->rnode);
 
     s->rnode_pos->graphicstate = NGLI_GRAPHICSTATE_DEFAULTS;
     s->rnode_pos->rendertarget_desc = *ngli_gctx_get_default_rendertarget_desc(s->gctx);
+    s->prepare_generation++;
+
+    /*
+     * The new scene is attached before the previous one is detached: the
+     * nodes present in both graphs are only prepared again for their new
+     * position and keep their resources (textures, media, buffers,
+     * pipelines, ...) instead of being released and initialized again.
+     */
+    struct ngl_node *prev_scene = s->scene;
+    s->scene = NULL;
 
     struct ngl_node *scene = arg;
-    if (!scene)
-        return 0;
+    if (scene) {
+        int ret = ngli_node_attach_ctx(scene, s);
+        if (ret < 0) {
+            /*
+             * The new scene may be partially attached: the previous scene
+             * must be detached first so the nodes still initialized only
+             * belong to the new one.
+             */
+            if (prev_scene) {
+                ngli_node_detach_ctx(prev_scene, s);
+                ngl_node_unrefp(&prev_scene);
+            }
+            ngli_node_detach_ctx(scene, s);
+            return ret;
+        }
+        s->scene = ngl_node_ref(scene);
+    }
 
-    int ret = ngli_node_attach_ctx(scene, s);
-    if (ret < 0) {
-        ngli_node_detach_ctx(scene, s);
-        return ret;
+    if (prev_scene) {
+        ngli_node_detach_ctx(prev_scene, s);
+        ngl_node_unrefp(&prev_scene);
     }
 
-    s->scene = ngl_node_ref(scene);
+    if (!scene)
+        return 0;
 
     const struct ngl_config *config = &s->config;
     if (config->hud) {
@@ -238,7 +282,7 @@ static int cmd_set_scene(struct ngl_ctx *s, void *arg)
         if (!s->hud)
             return NGL_ERROR_MEMORY;
 
-        ret = ngli_hud_init(s->hud);
+        int ret = ngli_hud_init(s->hud);
         if (ret < 0)
             return ret;
     }
@@ -260,6 +304,7 @@ static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
     const int64_t start_time = s->hud ? ngli_gettime_relative() : 0;
 
     ngli_darray_clear(&s->activitycheck_nodes);
+    s->activation_time = t;
     int ret = ngli_node_visit(scene, 1, t);
     if (ret < 0)
         return ret;
@@ -268,6 +313,10 @@ static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
     if (ret < 0)
         return ret;
 
+    ret = ngli_animengine_evaluate(&s->animengine, s->workpool, t);
+    if (ret < 0)
+        return ret;
+
     ret = ngli_node_update(scene, t);
     if (ret < 0)
         return ret;
@@ -277,6 +326,21 @@ static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
     return 0;
 }
 
+/*
+ * The scene output can only differ from the previously drawn frame if the
+ * root node has been evaluated again: an update skipped for being time
+ * invariant means nothing changed in the whole graph since its last
+ * evaluation, which happened at the latest for the previously drawn frame.
+ */
+static int is_frame_static(const struct ngl_ctx *s, double t)
+{
+    const struct ngl_config *config = &s->config;
+    const struct ngl_node *scene = s->scene;
+    return config->elide_static_frames && !s->hud && !config->set_surface_pts &&
+           s->has_drawn_frame && scene && scene->class->update &&
+           scene->last_update_time == t && scene->last_eval_time != t;
+}
+
 static int cmd_draw(struct ngl_ctx *s, void *arg)
 {
     const double t = *(double *)arg;
@@ -285,6 +349,12 @@ static int cmd_draw(struct ngl_ctx *s, void *arg)
     if (ret < 0)
         return ret;
 
+    if (is_frame_static(s, t)) {
+        LOG(DEBUG, "scene unchanged @ t=%f, skip drawing", t);
+        return 0;
+    }
+    s->has_drawn_frame = 0;
+
     ret = ngli_gctx_begin_draw(s->gctx, t);
     if (ret < 0)
         goto end;
@@ -321,6 +391,8 @@ end:;
     if (end_ret < 0)
         return end_ret;
 
+    s->has_drawn_frame = ret >= 0;
+
     return ret;
 }
 
@@ -583,6 +655,11 @@ struct ngl_ctx *ngl_create(void)
     ngli_darray_init(&s->modelview_matrix_stack, 4 * 4 * sizeof(float), 1);
     ngli_darray_init(&s->projection_matrix_stack, 4 * 4 * sizeof(float), 1);
     ngli_darray_init(&s->activitycheck_nodes, sizeof(struct ngl_node *), 0);
+    ngli_animengine_init(&s->animengine);
+
+    s->easingluts = ngli_easinglut_cache_create();
+    if (!s->easingluts)
+        goto fail;
 
     static const NGLI_ALIGNED_MAT(id_matrix) = NGLI_MAT4_IDENTITY;
     if (!ngli_darray_push(&s->modelview_matrix_stack, id_matrix) ||
@@ -726,6 +803,8 @@ void ngl_freep(struct ngl_ctx **ss)
     ngli_darray_reset(&s->modelview_matrix_stack);
     ngli_darray_reset(&s->projection_matrix_stack);
     ngli_darray_reset(&s->activitycheck_nodes);
+    ngli_animengine_reset(&s->animengine);
+    ngli_hmap_freep(&s->easingluts);
     ngli_freep(ss);
 }
 
@@ -116,6 +116,7 @@ static const struct gldefinition {
     {"glGetUniformiv", offsetof(struct glfunctions, GetUniformiv), M},
     {"glInvalidateFramebuffer", offsetof(struct glfunctions, InvalidateFramebuffer), 0},
     {"glLinkProgram", offsetof(struct glfunctions, LinkProgram), M},
+    {"glMapBufferRange", offsetof(struct glfunctions, MapBufferRange), 0},
     {"glMemoryBarrier", offsetof(struct glfunctions, MemoryBarrier), 0},
     {"glPixelStorei", offsetof(struct glfunctions, PixelStorei), M},
     {"glPolygonMode", offsetof(struct glfunctions, PolygonMode), 0},
@@ -159,6 +160,7 @@ static const struct gldefinition {
     {"glUniformMatrix2fv", offsetof(struct glfunctions, UniformMatrix2fv), M},
     {"glUniformMatrix3fv", offsetof(struct glfunctions, UniformMatrix3fv), M},
     {"glUniformMatrix4fv", offsetof(struct glfunctions, UniformMatrix4fv), M},
+    {"glUnmapBuffer", offsetof(struct glfunctions, UnmapBuffer), 0},
     {"glUseProgram", offsetof(struct glfunctions, UseProgram), M},
     {"glVertexAttribDivisor", offsetof(struct glfunctions, VertexAttribDivisor), 0},
     {"glVertexAttribPointer", offsetof(struct glfunctions, VertexAttribPointer), M},
@@ -287,5 +287,13 @@ static const struct glfeature {
         .version        = 300,
         .es_version     = 300,
         .es_extensions  = (const char*[]){"GL_EXT_shader_texture_lod", NULL},
+    }, {
+        .name           = "pixel_buffer_object",
+        .flag           = NGLI_FEATURE_PIXEL_BUFFER_OBJECT,
+        .version        = 300,
+        .es_version     = 300,
+        .funcs_offsets  = (const size_t[]){OFFSET(MapBufferRange),
+                                           OFFSET(UnmapBuffer),
+                                           -1}
     }
 };
@@ -215,6 +215,9 @@ typedef void (NGLI_GL_APIENTRY *GLDEBUGPROC)(GLenum source, GLenum type, GLuint
 # define GL_STATIC_COPY                        0x88E6
 # define GL_DYNAMIC_READ                       0x88E9
 # define GL_DYNAMIC_COPY                       0x88EA
+# define GL_PIXEL_UNPACK_BUFFER                0x88EC
+# define GL_MAP_WRITE_BIT                      0x0002
+# define GL_MAP_INVALIDATE_BUFFER_BIT          0x0008
 # define GL_INVALID_INDEX                      0xFFFFFFFFU
 # define GL_POLYGON_MODE                       0x0B40
 # define GL_FILL                               0x1B02
@@ -186,6 +186,83 @@ static void texture_set_sub_image(struct texture *s, const uint8_t *data, int li
         ngli_glPixelStorei(gl, GL_UNPACK_ROW_LENGTH, 0);
 }
 
+/*
+ * Dynamic 2D textures are streamed through a ring of pixel unpack buffers:
+ * the CPU copy lands in a freshly orphaned buffer and glTexSubImage2D()
+ * returns immediately, leaving the actual transfer to the driver instead of
+ * stalling until the previous upload has been consumed by the GPU.
+ */
+static int texture2d_stream_sub_image(struct texture *s, const uint8_t *data, int linesize)
+{
+    struct texture_gl *s_priv = (struct texture_gl *)s;
+    struct gctx_gl *gctx_gl = (struct gctx_gl *)s->gctx;
+    struct glcontext *gl = gctx_gl->glcontext;
+    const struct texture_params *params = &s->params;
+
+    if (!linesize)
+        linesize = params->width;
+
+    const int src_linesize = linesize * s->bytes_per_pixel;
+    const int dst_linesize = params->width * s->bytes_per_pixel;
+    const int size = dst_linesize * params->height;
+
+    s_priv->pbo_index = (s_priv->pbo_index + 1) % s_priv->nb_pbos;
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, s_priv->pbo_ids[s_priv->pbo_index]);
+
+    uint8_t *dst = ngli_glMapBufferRange(gl, GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!dst) {
+        ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    if (src_linesize == dst_linesize) {
+        memcpy(dst, data, size);
+    } else {
+        for (int y = 0; y < params->height; y++) {
+            memcpy(dst, data, dst_linesize);
+            dst += dst_linesize;
+            data += src_linesize;
+        }
+    }
+
+    if (!ngli_glUnmapBuffer(gl, GL_PIXEL_UNPACK_BUFFER)) {
+        ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+        return NGL_ERROR_EXTERNAL;
+    }
+
+    const int alignment = NGLI_MIN(dst_linesize & ~(dst_linesize - 1), 8);
+    ngli_glPixelStorei(gl, GL_UNPACK_ALIGNMENT, alignment);
+    ngli_glTexSubImage2D(gl, GL_TEXTURE_2D, 0, 0, 0, params->width, params->height, s_priv->format, s_priv->format_type, NULL);
+    ngli_glPixelStorei(gl, GL_UNPACK_ALIGNMENT, 4);
+
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return 0;
+}
+
+static void texture_init_pbos(struct texture *s)
+{
+    struct texture_gl *s_priv = (struct texture_gl *)s;
+    struct gctx_gl *gctx_gl = (struct gctx_gl *)s->gctx;
+    struct glcontext *gl = gctx_gl->glcontext;
+    const struct texture_params *params = &s->params;
+
+    if (!(params->usage & NGLI_TEXTURE_USAGE_DYNAMIC_BIT) ||
+        !(gl->features & NGLI_FEATURE_PIXEL_BUFFER_OBJECT) ||
+        s_priv->target != GL_TEXTURE_2D)
+        return;
+
+    const int size = params->width * params->height * s->bytes_per_pixel;
+    ngli_glGenBuffers(gl, NGLI_TEXTURE_GL_NB_PBOS, s_priv->pbo_ids);
+    for (int i = 0; i < NGLI_TEXTURE_GL_NB_PBOS; i++) {
+        ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, s_priv->pbo_ids[i]);
+        ngli_glBufferData(gl, GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+    ngli_glBindBuffer(gl, GL_PIXEL_UNPACK_BUFFER, 0);
+    s_priv->nb_pbos = NGLI_TEXTURE_GL_NB_PBOS;
+}
+
 static void texture_set_storage(struct texture *s)
 {
     struct texture_gl *s_priv = (struct texture_gl *)s;
@@ -367,6 +444,7 @@ int ngli_texture_gl_init(struct texture *s, const struct texture_params *params)
             } else {
                 texture_set_image(s, NULL);
             }
+            texture_init_pbos(s);
         }
     }
 
@@ -434,15 +512,19 @@ int ngli_texture_gl_upload(struct texture *s, const uint8_t *data, int linesize)
     ngli_assert(!s->external_storage);
     ngli_assert(params->usage & NGLI_TEXTURE_USAGE_TRANSFER_DST_BIT);
 
+    int ret = 0;
     ngli_glBindTexture(gl, s_priv->target, s_priv->id);
     if (data) {
-        texture_set_sub_image(s, data, linesize);
-        if (ngli_texture_gl_has_mipmap(s))
+        if (s_priv->nb_pbos)
+            ret = texture2d_stream_sub_image(s, data, linesize);
+        else
+            texture_set_sub_image(s, data, linesize);
+        if (ret >= 0 && ngli_texture_gl_has_mipmap(s))
             ngli_glGenerateMipmap(gl, s_priv->target);
     }
     ngli_glBindTexture(gl, s_priv->target, 0);
 
-    return 0;
+    return ret;
 }
 
 int ngli_texture_gl_generate_mipmap(struct texture *s)
@@ -477,5 +559,8 @@ void ngli_texture_gl_freep(struct texture **sp)
             ngli_glDeleteTextures(gl, 1, &s_priv->id);
     }
 
+    if (s_priv->nb_pbos)
+        ngli_glDeleteBuffers(gl, s_priv->nb_pbos, s_priv->pbo_ids);
+
     ngli_freep(sp);
 }
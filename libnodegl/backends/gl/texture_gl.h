@@ -29,6 +29,8 @@ GLint ngli_texture_get_gl_min_filter(int min_filter, int mipmap_filter);
 GLint ngli_texture_get_gl_mag_filter(int mag_filter);
 GLint ngli_texture_get_gl_wrap(int wrap);
 
+#define NGLI_TEXTURE_GL_NB_PBOS 3
+
 struct texture_gl {
     struct texture parent;
     GLenum target;
@@ -36,6 +38,9 @@ struct texture_gl {
     GLint format;
     GLint internal_format;
     GLenum format_type;
+    GLuint pbo_ids[NGLI_TEXTURE_GL_NB_PBOS];
+    int nb_pbos;
+    int pbo_index;
 };
 
 struct texture *ngli_texture_gl_create(struct gctx *gctx);
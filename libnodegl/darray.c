@@ -107,6 +107,15 @@ void *ngli_darray_get(const struct darray *darray, int index)
     return darray->data + index * darray->element_size;
 }
 
+void ngli_darray_remove(struct darray *darray, int index)
+{
+    ngli_assert(index >= 0 && index < darray->count);
+    uint8_t *element = darray->data + index * darray->element_size;
+    const int nb_next = darray->count - index - 1;
+    memmove(element, element + darray->element_size, nb_next * darray->element_size);
+    darray->count--;
+}
+
 void ngli_darray_reset(struct darray *darray)
 {
     if (darray->release)
@@ -24,11 +24,14 @@
 #include <string.h>
 
 #include "darray.h"
+#include "deserialize.h"
+#include "hexfloat.h"
 #include "log.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "params.h"
+#include "workpool.h"
 
 #define CASE_LITERAL(param_type, type, parse_func)      \
 case param_type: {                                      \
@@ -44,13 +47,10 @@ case param_type: {                                      \
 
 #define CASE_VEC(parse_func, vals, expected_nb_vals) do {       \
     int nb_vals;                                                \
-    len = parse_func(str, &vals, &nb_vals);                     \
-    if (len < 0 || nb_vals != expected_nb_vals) {               \
-        ngli_free(vals);                                        \
+    len = parse_func(str, vals, expected_nb_vals, &nb_vals);    \
+    if (len < 0 || nb_vals != expected_nb_vals)                 \
         return NGL_ERROR_INVALID_DATA;                          \
-    }                                                           \
     int ret = ngli_params_vset(base_ptr, par, vals);            \
-    ngli_free(vals);                                            \
     if (ret < 0)                                                \
         return ret;                                             \
 } while (0)
@@ -94,141 +94,92 @@ static int parse_bool(const char *s, int *valp)
     return ret;
 }
 
-#define DECLARE_FLT_PARSE_FUNC(type, nbit, shift_exp, expected_z)           \
-static int parse_##type(const char *s, type *valp)                          \
-{                                                                           \
-    int consumed = 0;                                                       \
-    union { uint##nbit##_t i; type f; } u = {.i = 0};                       \
-                                                                            \
-    if (*s == '-') {                                                        \
-        u.i = 1ULL << (nbit - 1);                                           \
-        consumed++;                                                         \
-    }                                                                       \
-                                                                            \
-    char *endptr = NULL;                                                    \
-    uint##nbit##_t exp = nbit == 64 ? strtoull(s + consumed, &endptr, 16)   \
-                                    : strtoul(s + consumed, &endptr, 16);   \
-    if (*endptr++ != expected_z)                                            \
-        return NGL_ERROR_INVALID_DATA;                                      \
-    uint##nbit##_t mant = nbit == 64 ? strtoull(endptr, &endptr, 16)        \
-                                     : strtoul(endptr, &endptr, 16);        \
-                                                                            \
-    u.i |= exp<<shift_exp | mant;                                           \
-                                                                            \
-    *valp = u.f;                                                            \
-    return (int)(endptr - s);                                               \
-}
-
-DECLARE_FLT_PARSE_FUNC(float,  32, 23, 'z')
-DECLARE_FLT_PARSE_FUNC(double, 64, 52, 'Z')
-
+/*
+ * Lists are parsed in place into a destination of max_vals elements, which
+ * is sized by the caller (see count_list_elems()) so no intermediate array
+ * is needed.
+ */
 #define DECLARE_PARSE_LIST_FUNC(type, parse_func)                           \
-static int parse_func##s(const char *s, type **valsp, int *nb_valsp)        \
+static int parse_func##s(const char *s, type *vals, int max_vals,           \
+                         int *nb_valsp)                                     \
 {                                                                           \
-    type *vals = NULL;                                                      \
-    int nb_vals = 0, consumed = 0, len;                                     \
+    int nb_vals = 0, consumed = 0;                                          \
                                                                             \
     for (;;) {                                                              \
-        type v;                                                             \
-        len = parse_func(s, &v);                                            \
-        if (len < 0) {                                                      \
-            consumed = -1;                                                  \
-            break;                                                          \
-        }                                                                   \
-        type *new_vals = ngli_realloc(vals,                                 \
-                                      (nb_vals + 1) * sizeof(*new_vals));   \
-        if (!new_vals) {                                                    \
-            consumed = -1;                                                  \
-            break;                                                          \
-        }                                                                   \
+        if (nb_vals == max_vals)                                            \
+            return NGL_ERROR_INVALID_DATA;                                  \
+        const int len = parse_func(s, &vals[nb_vals]);                      \
+        if (len < 0)                                                        \
+            return len;                                                     \
         s += len;                                                           \
         consumed += len;                                                    \
-        new_vals[nb_vals++] = v;                                            \
-        vals = new_vals;                                                    \
+        nb_vals++;                                                          \
         if (*s != ',')                                                      \
             break;                                                          \
         s++;                                                                \
         consumed++;                                                         \
     }                                                                       \
-    if (consumed < 0) {                                                     \
-        ngli_freep(&vals);                                                  \
-        nb_vals = 0;                                                        \
-    }                                                                       \
-    *valsp = vals;                                                          \
     *nb_valsp = nb_vals;                                                    \
     return consumed;                                                        \
 }
 
-DECLARE_PARSE_LIST_FUNC(float,    parse_float)
-DECLARE_PARSE_LIST_FUNC(double,   parse_double)
-DECLARE_PARSE_LIST_FUNC(int,      parse_hexint)
 DECLARE_PARSE_LIST_FUNC(int,      parse_int)
 DECLARE_PARSE_LIST_FUNC(unsigned, parse_uint)
 
-#define FREE_KVS(count, keys, vals) do {                                    \
-    for (int k = 0; k < (count); k++)                                       \
-        ngli_free((keys)[k]);                                               \
-    ngli_freep(&keys);                                                      \
-    ngli_freep(&vals);                                                      \
-} while (0)
+static int count_list_elems(const char *s, const char *end)
+{
+    int n = 1;
+    for (; s < end && *s != ' ' && *s != '\n'; s++)
+        n += *s == ',';
+    return n;
+}
+
+/*
+ * Node references are relative to the node being parsed, which is the last
+ * one of the nb_nodes nodes and cannot reference itself.
+ */
+static struct ngl_node **get_abs_node(struct ngl_node **nodes, int nb_nodes, int id)
+{
+    const int index = nb_nodes - id - 1;
+    if (index < 0 || index >= nb_nodes - 1)
+        return NULL;
+    return &nodes[index];
+}
 
-static int parse_kvs(const char *s, int *nb_kvsp, char ***keysp, int **valsp)
+static int parse_kvs(struct ngl_node **nodes, int nb_nodes, uint8_t *base_ptr,
+                     const struct node_param *par, const char *s, const char *end)
 {
-    char **keys = NULL;
-    int *vals = NULL;
-    int nb_vals = 0, consumed = 0, len;
+    int consumed = 0;
 
     for (;;) {
         char key[63 + 1];
-        int val;
-        int n = sscanf(s, "%63[^=]=%x%n", key, &val, &len);
-        if (n != 2) {
-            consumed = -1;
-            break;
-        }
-
-        char **new_keys = ngli_realloc(keys, (nb_vals + 1) * sizeof(*new_keys));
-        if (!new_keys) {
-            consumed = -1;
-            break;
-        }
-        keys = new_keys;
+        const size_t key_len = strcspn(s, "=, \n");
+        if (key_len >= sizeof(key) || s + key_len >= end || s[key_len] != '=')
+            return NGL_ERROR_INVALID_DATA;
+        memcpy(key, s, key_len);
+        key[key_len] = 0;
 
-        int *new_vals = ngli_realloc(vals, (nb_vals + 1) * sizeof(*new_vals));
-        if (!new_vals) {
-            consumed = -1;
-            break;
-        }
-        vals = new_vals;
+        int node_id;
+        const int len = parse_hexint(s + key_len + 1, &node_id);
+        if (len <= 0)
+            return NGL_ERROR_INVALID_DATA;
+        struct ngl_node **nodep = get_abs_node(nodes, nb_nodes, node_id);
+        if (!nodep)
+            return NGL_ERROR_INVALID_DATA;
+        int ret = ngli_params_vset(base_ptr, par, key, *nodep);
+        if (ret < 0)
+            return ret;
 
-        s += len;
-        consumed += len;
-        keys[nb_vals] = ngli_strdup(key);
-        vals[nb_vals] = val;
-        nb_vals++;
+        s += key_len + 1 + len;
+        consumed += key_len + 1 + len;
         if (*s != ',')
             break;
         s++;
         consumed++;
     }
-    if (consumed < 0) {
-        FREE_KVS(nb_vals, keys, vals);
-        nb_vals = 0;
-    }
-    *keysp = keys;
-    *valsp = vals;
-    *nb_kvsp = nb_vals;
     return consumed;
 }
 
-static struct ngl_node **get_abs_node(struct darray *nodes_array, int id)
-{
-    const int index = ngli_darray_count(nodes_array) - id - 1;
-    if (index < 0 || index >= ngli_darray_count(nodes_array))
-        return NULL;
-    struct ngl_node **nodes = ngli_darray_data(nodes_array);
-    return &nodes[index];
-}
 
 static const uint8_t hexm[256] = {
     ['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3,
@@ -239,8 +190,12 @@ static const uint8_t hexm[256] = {
 
 #define CHR_FROM_HEX(s) (hexm[(uint8_t)(s)[0]]<<4 | hexm[(uint8_t)(s)[1]])
 
-static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
-                       const struct node_param *par, const char *str)
+/*
+ * Parameters are parsed from a line delimited by end, which is not required
+ * to be nul terminated (but must be followed by a '\n' or a nul character).
+ */
+static int parse_param(struct ngl_node **nodes, int nb_nodes, uint8_t *base_ptr,
+                       const struct node_param *par, const char *str, const char *end)
 {
     int len = -1;
 
@@ -249,14 +204,18 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         CASE_LITERAL(PARAM_TYPE_UINT, unsigned, parse_uint)
         CASE_LITERAL(PARAM_TYPE_BOOL, int,      parse_bool)
         CASE_LITERAL(PARAM_TYPE_I64,  int64_t,  parse_i64)
-        CASE_LITERAL(PARAM_TYPE_DBL,  double,   parse_double)
+        CASE_LITERAL(PARAM_TYPE_DBL,  double,   ngli_hexfloat_read_f64)
 
         case PARAM_TYPE_RATIONAL: {
             int r[2] = {0};
-            int ret = sscanf(str, "%d/%d%n", &r[0], &r[1], &len);
-            if (ret != 2)
+            const int num_len = parse_int(str, &r[0]);
+            if (num_len <= 0 || str[num_len] != '/')
                 return NGL_ERROR_INVALID_DATA;
-            ret = ngli_params_vset(base_ptr, par, r[0], r[1]);
+            const int den_len = parse_int(str + num_len + 1, &r[1]);
+            if (den_len <= 0)
+                return NGL_ERROR_INVALID_DATA;
+            len = num_len + 1 + den_len;
+            int ret = ngli_params_vset(base_ptr, par, r[0], r[1]);
             if (ret < 0)
                 return ret;
             break;
@@ -301,30 +260,24 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
 
         case PARAM_TYPE_DATA: {
             int size = 0;
-            int consumed = 0;
-            const char *cur = str;
-            const char *end = str + strlen(str);
-            int ret = sscanf(str, "%d,%n", &size, &consumed);
-            if (ret != 1)
+            const int size_len = parse_int(str, &size);
+            if (size_len <= 0 || str[size_len] != ',' || size < 0)
                 return NGL_ERROR_INVALID_DATA;
             if (!size)
                 break;
-            if (cur >= end - consumed)
+            const char *cur = str + size_len + 1;
+            if (end - cur < 2LL * size)
                 return NGL_ERROR_INVALID_DATA;
-            cur += consumed;
-            uint8_t *data = ngli_calloc(size, sizeof(*data));
+
+            /* The data is decoded into a buffer handed over to the parameter */
+            uint8_t *data = ngli_malloc(size);
             if (!data)
                 return NGL_ERROR_MEMORY;
             for (int i = 0; i < size; i++) {
-                if (cur > end - 2) {
-                    ngli_free(data);
-                    return NGL_ERROR_INVALID_DATA;
-                }
                 data[i] = CHR_FROM_HEX(cur);
                 cur += 2;
             }
-            ret = ngli_params_vset(base_ptr, par, size, data);
-            ngli_free(data);
+            int ret = ngli_params_take(base_ptr, par, size, data);
             if (ret < 0)
                 return ret;
             len = cur - str;
@@ -334,7 +287,7 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         case PARAM_TYPE_IVEC2:
         case PARAM_TYPE_IVEC3:
         case PARAM_TYPE_IVEC4: {
-            int *iv = NULL;
+            int iv[4];
             CASE_VEC(parse_ints, iv, par->type - PARAM_TYPE_IVEC2 + 2);
             break;
         }
@@ -342,7 +295,7 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         case PARAM_TYPE_UIVEC2:
         case PARAM_TYPE_UIVEC3:
         case PARAM_TYPE_UIVEC4: {
-            unsigned *uv = NULL;
+            unsigned uv[4];
             CASE_VEC(parse_uints, uv, par->type - PARAM_TYPE_UIVEC2 + 2);
             break;
         }
@@ -350,23 +303,23 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         case PARAM_TYPE_VEC2:
         case PARAM_TYPE_VEC3:
         case PARAM_TYPE_VEC4: {
-            float *v = NULL;
-            CASE_VEC(parse_floats, v, par->type - PARAM_TYPE_VEC2 + 2);
+            float v[4];
+            CASE_VEC(ngli_hexfloat_read_f32s, v, par->type - PARAM_TYPE_VEC2 + 2);
             break;
         }
 
         case PARAM_TYPE_MAT4: {
-            float *m = NULL;
-            CASE_VEC(parse_floats, m, 16);
+            float m[4 * 4];
+            CASE_VEC(ngli_hexfloat_read_f32s, m, 16);
             break;
         }
 
         case PARAM_TYPE_NODE: {
             int node_id;
             len = parse_hexint(str, &node_id);
-            if (len < 0)
+            if (len <= 0)
                 return NGL_ERROR_INVALID_DATA;
-            struct ngl_node **nodep = get_abs_node(nodes_array, node_id);
+            struct ngl_node **nodep = get_abs_node(nodes, nb_nodes, node_id);
             if (!nodep)
                 return NGL_ERROR_INVALID_DATA;
             int ret = ngli_params_vset(base_ptr, par, *nodep);
@@ -376,59 +329,56 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         }
 
         case PARAM_TYPE_NODELIST: {
-            int *node_ids, nb_node_ids;
-            len = parse_hexints(str, &node_ids, &nb_node_ids);
-            if (len < 0)
-                return len;
-            for (int i = 0; i < nb_node_ids; i++) {
-                struct ngl_node **nodep = get_abs_node(nodes_array, node_ids[i]);
-                if (!nodep) {
-                    ngli_free(node_ids);
+            /* The nodes are decoded into a buffer handed over to the parameter */
+            const int max_nodes = count_list_elems(str, end);
+            struct ngl_node **elems = ngli_calloc(max_nodes, sizeof(*elems));
+            if (!elems)
+                return NGL_ERROR_MEMORY;
+            int nb_elems = 0;
+            const char *cur = str;
+            for (;;) {
+                int node_id;
+                const int id_len = parse_hexint(cur, &node_id);
+                struct ngl_node **nodep = get_abs_node(nodes, nb_nodes, node_id);
+                if (id_len <= 0 || !nodep || nb_elems == max_nodes) {
+                    ngli_free(elems);
                     return NGL_ERROR_INVALID_DATA;
                 }
-                int ret = ngli_params_add(base_ptr, par, 1, nodep);
-                if (ret < 0) {
-                    ngli_free(node_ids);
-                    return ret;
-                }
+                elems[nb_elems++] = *nodep;
+                cur += id_len;
+                if (*cur != ',')
+                    break;
+                cur++;
             }
-            ngli_free(node_ids);
+            int ret = ngli_params_take(base_ptr, par, nb_elems, elems);
+            if (ret < 0)
+                return ret;
+            len = cur - str;
             break;
         }
 
         case PARAM_TYPE_DBLLIST: {
-            double *dbls;
+            /* The doubles are decoded into a buffer handed over to the parameter */
+            const int max_dbls = count_list_elems(str, end);
+            double *elems = ngli_calloc(max_dbls, sizeof(*elems));
+            if (!elems)
+                return NGL_ERROR_MEMORY;
             int nb_dbls;
-            len = parse_doubles(str, &dbls, &nb_dbls);
-            if (len < 0)
+            len = ngli_hexfloat_read_f64s(str, elems, max_dbls, &nb_dbls);
+            if (len < 0) {
+                ngli_free(elems);
                 return len;
-            int ret = ngli_params_add(base_ptr, par, nb_dbls, dbls);
-            ngli_free(dbls);
+            }
+            int ret = ngli_params_take(base_ptr, par, nb_dbls, elems);
             if (ret < 0)
                 return ret;
             break;
         }
 
         case PARAM_TYPE_NODEDICT: {
-            char **node_keys;
-            int *node_ids, nb_nodes;
-            len = parse_kvs(str, &nb_nodes, &node_keys, &node_ids);
+            len = parse_kvs(nodes, nb_nodes, base_ptr, par, str, end);
             if (len < 0)
                 return len;
-            for (int i = 0; i < nb_nodes; i++) {
-                const char *key = node_keys[i];
-                struct ngl_node **nodep = get_abs_node(nodes_array, node_ids[i]);
-                if (!nodep) {
-                    FREE_KVS(nb_nodes, node_keys, node_ids);
-                    return NGL_ERROR_INVALID_DATA;
-                }
-                int ret = ngli_params_vset(base_ptr, par, key, *nodep);
-                if (ret < 0) {
-                    FREE_KVS(nb_nodes, node_keys, node_ids);
-                    return ret;
-                }
-            }
-            FREE_KVS(nb_nodes, node_keys, node_ids);
             break;
         }
 
@@ -439,8 +389,32 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
     return len;
 }
 
-static int set_node_params(struct darray *nodes_array, char *str,
-                           const struct ngl_node *node)
+int ngli_deserialize_param(uint8_t *base_ptr, const struct node_param *par,
+                           const char *str, const char *end)
+{
+    return parse_param(NULL, 0, base_ptr, par, str, end);
+}
+
+enum {
+    PARSE_ALL,
+    PARSE_DATA, /* every parameter except the node references */
+    PARSE_REFS, /* only the node references */
+};
+
+static int is_node_ref(int type)
+{
+    return type == PARAM_TYPE_NODE ||
+           type == PARAM_TYPE_NODELIST ||
+           type == PARAM_TYPE_NODEDICT;
+}
+
+/*
+ * In PARSE_DATA mode, the nodes are not accessed so this can run
+ * concurrently on different nodes.
+ */
+static int set_node_params(struct ngl_node **nodes, int nb_nodes,
+                           const char *str, const char *end,
+                           const struct ngl_node *node, int mode)
 {
     uint8_t *base_ptr = node->priv_data;
     const struct node_param *params = node->class->params;
@@ -448,21 +422,36 @@ static int set_node_params(struct darray *nodes_array, char *str,
     if (!params)
         return 0;
 
-    for (;;) {
-        char *eok = strchr(str, ':');
+    while (str < end) {
+        const char *eok = memchr(str, ':', end - str);
         if (!eok)
             break;
-        *eok = 0;
 
-        const struct node_param *par = ngli_node_param_find(node, str, &base_ptr);
+        char key[63 + 1];
+        const size_t key_len = eok - str;
+        if (key_len >= sizeof(key)) {
+            LOG(ERROR, "invalid parameter name in %s", node->class->name);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        memcpy(key, str, key_len);
+        key[key_len] = 0;
+
+        const struct node_param *par = ngli_node_param_find(node, key, &base_ptr);
         if (!par) {
             LOG(ERROR, "unable to find parameter %s.%s",
-                node->class->name, str);
+                node->class->name, key);
             return NGL_ERROR_INVALID_DATA;
         }
 
         str = eok + 1;
-        int ret = parse_param(nodes_array, base_ptr, par, str);
+        int ret;
+        if (mode != PARSE_ALL && (mode == PARSE_REFS) != is_node_ref(par->type)) {
+            /* Parameter values never contain spaces */
+            const char *eov = memchr(str, ' ', end - str);
+            ret = (int)((eov ? eov : end) - str);
+        } else {
+            ret = parse_param(nodes, nb_nodes, base_ptr, par, str, end);
+        }
         if (ret < 0) {
             LOG(ERROR, "unable to set node param %s.%s: %s",
                 node->class->name, par->key, NGLI_RET_STR(ret));
@@ -470,7 +459,7 @@ static int set_node_params(struct darray *nodes_array, char *str,
         }
 
         str += ret;
-        if (*str != ' ')
+        if (str >= end || *str != ' ')
             break;
         str++;
     }
@@ -478,72 +467,272 @@ static int set_node_params(struct darray *nodes_array, char *str,
     return 0;
 }
 
-struct ngl_node *ngl_node_deserialize(const char *str)
-{
-    struct ngl_node *node = NULL;
+struct deserializer {
     struct darray nodes_array;
+    int has_header;
+};
 
-    ngli_darray_init(&nodes_array, sizeof(struct ngl_node *), 0);
-
-    char *s = ngli_strdup(str);
-    if (!s)
-        return NULL;
-
-    char *sstart = s;
-    char *send = s + strlen(s);
+static void deserializer_init(struct deserializer *s)
+{
+    memset(s, 0, sizeof(*s));
+    ngli_darray_init(&s->nodes_array, sizeof(struct ngl_node *), 0);
+}
 
+static int parse_header(const char *line)
+{
     int major, minor, micro;
-    int n = sscanf(s, "# Node.GL v%d.%d.%d", &major, &minor, &micro);
+    int n = sscanf(line, "# Node.GL v%d.%d.%d", &major, &minor, &micro);
     if (n != 3) {
         LOG(ERROR, "invalid serialized scene");
-        goto end;
+        return NGL_ERROR_INVALID_DATA;
     }
     if (NODEGL_VERSION_INT != NODEGL_GET_VERSION(major, minor, micro)) {
         LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
             major, minor, micro,
             NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
-        goto end;
+        return NGL_ERROR_INVALID_DATA;
     }
-    s += strcspn(s, "\n");
-    if (*s == '\n')
-        s++;
+    return 0;
+}
 
-    while (s < send - 4) {
-        const int type = NGLI_FOURCC(s[0], s[1], s[2], s[3]);
-        s += 4;
-        if (*s == ' ')
-            s++;
+/* Create the node of a line and return the position of its parameters */
+static int create_node(struct deserializer *s, const char *line, const char *end,
+                       const char **paramsp)
+{
+    if (end - line < 4)
+        return NGL_ERROR_INVALID_DATA;
 
-        node = ngl_node_create(type);
-        if (!node)
-            break;
+    const int type = NGLI_FOURCC(line[0], line[1], line[2], line[3]);
+    line += 4;
+    if (line < end && *line == ' ')
+        line++;
+
+    struct ngl_node *node = ngl_node_create(type);
+    if (!node)
+        return NGL_ERROR_INVALID_DATA;
+
+    if (!ngli_darray_push(&s->nodes_array, &node)) {
+        ngl_node_unrefp(&node);
+        return NGL_ERROR_MEMORY;
+    }
+
+    *paramsp = line;
+    return 0;
+}
+
+/* The line is delimited by end, which must point to a '\n' or a nul character */
+static int parse_line(struct deserializer *s, const char *line, const char *end)
+{
+    if (!s->has_header) {
+        /* The header line is short so a bounded copy is cheap */
+        char header[64];
+        const size_t len = NGLI_MIN(end - line, sizeof(header) - 1);
+        memcpy(header, line, len);
+        header[len] = 0;
+        int ret = parse_header(header);
+        if (ret < 0)
+            return ret;
+        s->has_header = 1;
+        return 0;
+    }
+
+    if (line == end)
+        return 0;
+
+    const char *params;
+    int ret = create_node(s, line, end, &params);
+    if (ret < 0)
+        return ret;
+
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes_array);
+    const int nb_nodes = ngli_darray_count(&s->nodes_array);
+    return set_node_params(nodes, nb_nodes, params, end, nodes[nb_nodes - 1], PARSE_ALL);
+}
+
+/* Return the root node (last one) on success and release the graph */
+static struct ngl_node *deserializer_end(struct deserializer *s, int ret)
+{
+    struct ngl_node *node = NULL;
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes_array);
+    const int nb_nodes = ngli_darray_count(&s->nodes_array);
+
+    if (ret >= 0 && nb_nodes)
+        node = ngl_node_ref(nodes[nb_nodes - 1]);
+
+    for (int i = 0; i < nb_nodes; i++)
+        ngl_node_unrefp(&nodes[i]);
+    ngli_darray_reset(&s->nodes_array);
+    return node;
+}
 
-        if (!ngli_darray_push(&nodes_array, &node)) {
-            ngl_node_unrefp(&node);
+struct ngl_node *ngl_node_deserialize(const char *str)
+{
+    struct deserializer s;
+    deserializer_init(&s);
+
+    int ret = 0;
+    while (*str) {
+        const char *eol = str + strcspn(str, "\n");
+        ret = parse_line(&s, str, eol);
+        if (ret < 0)
             break;
+        str = *eol ? eol + 1 : eol;
+    }
+
+    return deserializer_end(&s, ret);
+}
+
+#define READ_CHUNK_SIZE (64 * 1024)
+
+struct ngl_node *ngl_node_deserialize_stream(void *arg, int (*read_func)(void *arg, char *buf, int size))
+{
+    struct deserializer s;
+    deserializer_init(&s);
+
+    /*
+     * Only the line being parsed (and the following chunk) is held in
+     * memory; buf[start:size] is the pending data and scan the position
+     * from which a line feed is searched.
+     */
+    char *buf = NULL;
+    size_t size = 0, cap = 0, start = 0, scan = 0;
+    int eof = 0;
+    int ret = 0;
+
+    for (;;) {
+        char *eol = scan < size ? memchr(buf + scan, '\n', size - scan) : NULL;
+        if (!eol && eof) {
+            if (start == size)
+                break;
+            eol = buf + size;
         }
 
-        size_t eol = strcspn(s, "\n");
-        s[eol] = 0;
+        if (eol) {
+            *eol = 0;
+            ret = parse_line(&s, buf + start, eol);
+            if (ret < 0)
+                break;
+            start = scan = eol - buf + 1;
+            if (start > size)
+                start = scan = size;
+            continue;
+        }
 
-        int ret = set_node_params(&nodes_array, s, node);
-        if (ret < 0) {
-            node = NULL;
+        if (start) {
+            memmove(buf, buf + start, size - start);
+            size -= start;
+            start = 0;
+        }
+        scan = size;
+
+        /* Always keep room for a nul character after the data */
+        if (cap - size < READ_CHUNK_SIZE + 1) {
+            const size_t new_cap = NGLI_MAX(cap * 2, size + READ_CHUNK_SIZE + 1);
+            char *new_buf = ngli_realloc(buf, new_cap);
+            if (!new_buf) {
+                ret = NGL_ERROR_MEMORY;
+                break;
+            }
+            buf = new_buf;
+            cap = new_cap;
+        }
+
+        const int n = read_func(arg, buf + size, READ_CHUNK_SIZE);
+        if (n < 0) {
+            LOG(ERROR, "unable to read serialized scene: %s", NGLI_RET_STR(n));
+            ret = n;
             break;
         }
+        eof = !n;
+        size += n;
+    }
+
+    ngli_free(buf);
+    return deserializer_end(&s, ret);
+}
+
+struct node_line {
+    const char *params;
+    const char *end;
+    int ret;
+};
+
+struct parallel_parse {
+    struct ngl_node **nodes;
+    struct node_line *lines;
+};
+
+static void parse_data_job(void *user_arg, int job_id)
+{
+    struct parallel_parse *s = user_arg;
+    struct node_line *line = &s->lines[job_id];
+    line->ret = set_node_params(NULL, 0, line->params, line->end, s->nodes[job_id], PARSE_DATA);
+}
+
+struct ngl_node *ngl_node_deserialize_parallel(const char *str, int nb_threads)
+{
+    struct deserializer s;
+    deserializer_init(&s);
+
+    struct darray lines_array;
+    ngli_darray_init(&lines_array, sizeof(struct node_line), 0);
+
+    /*
+     * The lines are split and their nodes created serially: this is cheap
+     * compared to the parsing of the parameters.
+     */
+    int ret = 0;
+    while (*str) {
+        const char *eol = strchr(str, '\n');
+        if (!eol)
+            eol = str + strlen(str);
+        if (!s.has_header) {
+            ret = parse_line(&s, str, eol);
+        } else if (eol != str) {
+            struct node_line line = {.end = eol};
+            ret = create_node(&s, str, eol, &line.params);
+            if (ret >= 0 && !ngli_darray_push(&lines_array, &line))
+                ret = NGL_ERROR_MEMORY;
+        }
+        if (ret < 0)
+            goto end;
+        str = *eol ? eol + 1 : eol;
+    }
 
-        s += eol + 1;
+    struct workpool *workpool = NULL;
+    if (nb_threads > 1) {
+        workpool = ngli_workpool_create(nb_threads);
+        if (!workpool) {
+            ret = NGL_ERROR_MEMORY;
+            goto end;
+        }
     }
 
-    if (node)
-        ngl_node_ref(node);
+    /* Every node owns its parameters so they can be parsed concurrently */
+    struct ngl_node **nodes = ngli_darray_data(&s.nodes_array);
+    struct node_line *lines = ngli_darray_data(&lines_array);
+    const int nb_lines = ngli_darray_count(&lines_array);
+    struct parallel_parse parse = {.nodes = nodes, .lines = lines};
+    ngli_workpool_run(workpool, parse_data_job, &parse, nb_lines);
+    ngli_workpool_freep(&workpool);
+
+    for (int i = 0; i < nb_lines; i++) {
+        ret = lines[i].ret;
+        if (ret < 0)
+            goto end;
+    }
 
-    struct ngl_node **nodes = ngli_darray_data(&nodes_array);
-    for (int i = 0; i < ngli_darray_count(&nodes_array); i++)
-        ngl_node_unrefp(&nodes[i]);
+    /*
+     * The node references are linked serially and in order since they
+     * change the reference counters of the nodes.
+     */
+    for (int i = 0; i < nb_lines; i++) {
+        ret = set_node_params(nodes, i + 1, lines[i].params, lines[i].end, nodes[i], PARSE_REFS);
+        if (ret < 0)
+            goto end;
+    }
 
 end:
-    ngli_darray_reset(&nodes_array);
-    ngli_free(sstart);
-    return node;
+    ngli_darray_reset(&lines_array);
+    return deserializer_end(&s, ret);
 }
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DESERIALIZE_H
+#define DESERIALIZE_H
+
+#include <stdint.h>
+
+#include "params.h"
+
+/*
+ * Parse a serialized parameter value (which cannot be a node reference) into
+ * the parameter storage. The value is delimited by end, and must be followed
+ * by a space, a '\n' or a nul character. Return the number of characters
+ * consumed or a negative error.
+ */
+int ngli_deserialize_param(uint8_t *base_ptr, const struct node_param *par,
+                           const char *str, const char *end);
+
+#endif
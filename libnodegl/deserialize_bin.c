@@ -0,0 +1,371 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "darray.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "params.h"
+#include "serialize_bin.h"
+#include "utils.h"
+
+struct reader {
+    const uint8_t *ptr;
+    const uint8_t *end;
+};
+
+static int read_u32(struct reader *r, uint32_t *v)
+{
+    if ((size_t)(r->end - r->ptr) < sizeof(*v))
+        return NGL_ERROR_INVALID_DATA;
+    memcpy(v, r->ptr, sizeof(*v));
+    r->ptr += sizeof(*v);
+    return 0;
+}
+
+static int read_chunk(struct reader *r, size_t size, const uint8_t **chunkp)
+{
+    const size_t padded_size = NGLI_ALIGN(size, 4);
+    if (padded_size < size || (size_t)(r->end - r->ptr) < padded_size)
+        return NGL_ERROR_INVALID_DATA;
+    *chunkp = r->ptr;
+    r->ptr += padded_size;
+    return 0;
+}
+
+static int read_str(struct reader *r, const char **strp)
+{
+    const uint8_t *str = r->ptr;
+    const uint8_t *nul = memchr(str, 0, r->end - r->ptr);
+    if (!nul)
+        return NGL_ERROR_INVALID_DATA;
+    *strp = (const char *)str;
+    return read_chunk(r, nul - str + 1, &str);
+}
+
+/* Nodes can only reference the nodes preceding them */
+static struct ngl_node *get_node(struct darray *nodes_array, uint32_t id)
+{
+    if (id >= ngli_darray_count(nodes_array) - 1)
+        return NULL;
+    struct ngl_node **nodes = ngli_darray_data(nodes_array);
+    return nodes[id];
+}
+
+static int get_blob(const struct bin_header *header, const uint8_t *data,
+                    const uint8_t *payload, uint32_t payload_size,
+                    const uint8_t **blobp, size_t *sizep)
+{
+    uint64_t blob[2];
+    if (payload_size != sizeof(blob))
+        return NGL_ERROR_INVALID_DATA;
+    memcpy(blob, payload, sizeof(blob));
+    const uint64_t offset = blob[0];
+    const uint64_t size = blob[1];
+    if (offset > header->data_size || size > header->data_size - offset || size > INT32_MAX ||
+        offset % NGLI_BIN_DATA_ALIGN)
+        return NGL_ERROR_INVALID_DATA;
+    *blobp = data + header->data_offset + offset;
+    *sizep = size;
+    return 0;
+}
+
+static int set_param(struct darray *nodes_array, uint8_t *base_ptr,
+                     const struct node_param *par,
+                     const struct bin_header *header, const uint8_t *data,
+                     const uint8_t *payload, uint32_t payload_size)
+{
+    static const size_t scalar_sizes[NB_PARAMS] = {
+        [PARAM_TYPE_INT]      = sizeof(int),
+        [PARAM_TYPE_BOOL]     = sizeof(int),
+        [PARAM_TYPE_UINT]     = sizeof(unsigned),
+        [PARAM_TYPE_I64]      = sizeof(int64_t),
+        [PARAM_TYPE_DBL]      = sizeof(double),
+        [PARAM_TYPE_RATIONAL] = sizeof(int[2]),
+        [PARAM_TYPE_IVEC2]    = sizeof(int[2]),
+        [PARAM_TYPE_IVEC3]    = sizeof(int[3]),
+        [PARAM_TYPE_IVEC4]    = sizeof(int[4]),
+        [PARAM_TYPE_UIVEC2]   = sizeof(unsigned[2]),
+        [PARAM_TYPE_UIVEC3]   = sizeof(unsigned[3]),
+        [PARAM_TYPE_UIVEC4]   = sizeof(unsigned[4]),
+        [PARAM_TYPE_VEC2]     = sizeof(float[2]),
+        [PARAM_TYPE_VEC3]     = sizeof(float[3]),
+        [PARAM_TYPE_VEC4]     = sizeof(float[4]),
+        [PARAM_TYPE_MAT4]     = sizeof(float[4*4]),
+    };
+
+    /* Payloads are only 4-byte aligned so scalars are copied out first */
+    union {
+        int i[4];
+        unsigned u[4];
+        int64_t i64;
+        double dbl;
+        float f[4*4];
+    } v;
+    const size_t scalar_size = scalar_sizes[par->type];
+    if (scalar_size) {
+        if (payload_size != scalar_size)
+            return NGL_ERROR_INVALID_DATA;
+        memcpy(&v, payload, scalar_size);
+    }
+
+    switch (par->type) {
+        case PARAM_TYPE_INT:
+        case PARAM_TYPE_BOOL:       return ngli_params_vset(base_ptr, par, v.i[0]);
+        case PARAM_TYPE_UINT:       return ngli_params_vset(base_ptr, par, v.u[0]);
+        case PARAM_TYPE_I64:        return ngli_params_vset(base_ptr, par, v.i64);
+        case PARAM_TYPE_DBL:        return ngli_params_vset(base_ptr, par, v.dbl);
+        case PARAM_TYPE_RATIONAL:   return ngli_params_vset(base_ptr, par, v.i[0], v.i[1]);
+        case PARAM_TYPE_IVEC2:
+        case PARAM_TYPE_IVEC3:
+        case PARAM_TYPE_IVEC4:      return ngli_params_vset(base_ptr, par, v.i);
+        case PARAM_TYPE_UIVEC2:
+        case PARAM_TYPE_UIVEC3:
+        case PARAM_TYPE_UIVEC4:     return ngli_params_vset(base_ptr, par, v.u);
+        case PARAM_TYPE_VEC2:
+        case PARAM_TYPE_VEC3:
+        case PARAM_TYPE_VEC4:
+        case PARAM_TYPE_MAT4:       return ngli_params_vset(base_ptr, par, v.f);
+
+        case PARAM_TYPE_SELECT:
+        case PARAM_TYPE_FLAGS:
+        case PARAM_TYPE_STR: {
+            if (!payload_size || !memchr(payload, 0, payload_size))
+                return NGL_ERROR_INVALID_DATA;
+            return ngli_params_vset(base_ptr, par, (const char *)payload);
+        }
+
+        case PARAM_TYPE_DATA: {
+            const uint8_t *blob;
+            size_t size;
+            int ret = get_blob(header, data, payload, payload_size, &blob, &size);
+            if (ret < 0)
+                return ret;
+            return ngli_params_vset(base_ptr, par, (int)size, blob);
+        }
+
+        case PARAM_TYPE_DBLLIST: {
+            const uint8_t *blob;
+            size_t size;
+            int ret = get_blob(header, data, payload, payload_size, &blob, &size);
+            if (ret < 0)
+                return ret;
+            if (size % sizeof(double))
+                return NGL_ERROR_INVALID_DATA;
+            return ngli_params_add(base_ptr, par, size / sizeof(double), (double *)blob);
+        }
+
+        case PARAM_TYPE_NODE: {
+            uint32_t node_id;
+            if (payload_size != sizeof(node_id))
+                return NGL_ERROR_INVALID_DATA;
+            memcpy(&node_id, payload, sizeof(node_id));
+            struct ngl_node *node = get_node(nodes_array, node_id);
+            if (!node)
+                return NGL_ERROR_INVALID_DATA;
+            return ngli_params_vset(base_ptr, par, node);
+        }
+
+        case PARAM_TYPE_NODELIST: {
+            if (payload_size % sizeof(uint32_t))
+                return NGL_ERROR_INVALID_DATA;
+            const int nb_nodes = payload_size / sizeof(uint32_t);
+            if (!nb_nodes)
+                return 0;
+            struct ngl_node **nodes = ngli_calloc(nb_nodes, sizeof(*nodes));
+            if (!nodes)
+                return NGL_ERROR_MEMORY;
+            for (int i = 0; i < nb_nodes; i++) {
+                uint32_t node_id;
+                memcpy(&node_id, payload + i * sizeof(node_id), sizeof(node_id));
+                nodes[i] = get_node(nodes_array, node_id);
+                if (!nodes[i]) {
+                    ngli_free(nodes);
+                    return NGL_ERROR_INVALID_DATA;
+                }
+            }
+            int ret = ngli_params_add(base_ptr, par, nb_nodes, nodes);
+            ngli_free(nodes);
+            return ret;
+        }
+
+        case PARAM_TYPE_NODEDICT: {
+            struct reader r = {.ptr = payload, .end = payload + payload_size};
+            uint32_t nb_nodes;
+            int ret = read_u32(&r, &nb_nodes);
+            if (ret < 0)
+                return ret;
+            for (uint32_t i = 0; i < nb_nodes; i++) {
+                uint32_t node_id;
+                const char *key;
+                if ((ret = read_u32(&r, &node_id)) < 0 ||
+                    (ret = read_str(&r, &key)) < 0)
+                    return ret;
+                struct ngl_node *node = get_node(nodes_array, node_id);
+                if (!node)
+                    return NGL_ERROR_INVALID_DATA;
+                ret = ngli_params_vset(base_ptr, par, key, node);
+                if (ret < 0)
+                    return ret;
+            }
+            return 0;
+        }
+
+        default:
+            LOG(ERROR, "cannot deserialize %s: unsupported parameter type", par->key);
+            return NGL_ERROR_UNSUPPORTED;
+    }
+}
+
+static int set_node_params(struct darray *nodes_array, struct reader *r,
+                           const struct bin_header *header, const uint8_t *data,
+                           struct ngl_node *node, uint32_t nb_params)
+{
+    for (uint32_t i = 0; i < nb_params; i++) {
+        uint32_t type, key_size, payload_size;
+        const uint8_t *key, *payload;
+        int ret;
+        if ((ret = read_u32(r, &type)) < 0 ||
+            (ret = read_u32(r, &key_size)) < 0 ||
+            (ret = read_u32(r, &payload_size)) < 0 ||
+            (ret = read_chunk(r, key_size, &key)) < 0 ||
+            (ret = read_chunk(r, payload_size, &payload)) < 0)
+            return ret;
+        if (!key_size || key[key_size - 1])
+            return NGL_ERROR_INVALID_DATA;
+
+        uint8_t *base_ptr;
+        const struct node_param *par = ngli_node_param_find(node, (const char *)key, &base_ptr);
+        if (!par) {
+            LOG(ERROR, "unable to find parameter %s.%s", node->class->name, key);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        if (par->type != type) {
+            LOG(ERROR, "mismatching type for parameter %s.%s", node->class->name, key);
+            return NGL_ERROR_INVALID_DATA;
+        }
+
+        ret = set_param(nodes_array, base_ptr, par, header, data, payload, payload_size);
+        if (ret < 0) {
+            LOG(ERROR, "unable to set node param %s.%s: %s",
+                node->class->name, par->key, NGLI_RET_STR(ret));
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static int check_header(const struct bin_header *header, size_t size)
+{
+    if (memcmp(header->magic, NGLI_BIN_MAGIC, sizeof(header->magic))) {
+        LOG(ERROR, "invalid binary scene");
+        return NGL_ERROR_INVALID_DATA;
+    }
+    if (header->byte_order != NGLI_BIN_BYTE_ORDER) {
+        LOG(ERROR, "binary scene byte order is not supported");
+        return NGL_ERROR_UNSUPPORTED;
+    }
+    if (header->version != NGLI_BIN_VERSION) {
+        LOG(ERROR, "unsupported binary scene version %u", header->version);
+        return NGL_ERROR_UNSUPPORTED;
+    }
+    if (header->ngl_version != NODEGL_VERSION_INT) {
+        LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
+            header->ngl_version >> 16 & 0xff,
+            header->ngl_version >>  8 & 0xff,
+            header->ngl_version       & 0xff,
+            NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
+        return NGL_ERROR_INVALID_DATA;
+    }
+    if (header->nodes_offset > size || header->nodes_size > size - header->nodes_offset ||
+        header->data_offset  > size || header->data_size  > size - header->data_offset) {
+        LOG(ERROR, "truncated binary scene");
+        return NGL_ERROR_INVALID_DATA;
+    }
+    if (header->data_offset % NGLI_BIN_DATA_ALIGN) {
+        LOG(ERROR, "misaligned binary scene data section");
+        return NGL_ERROR_INVALID_DATA;
+    }
+    return 0;
+}
+
+struct ngl_node *ngl_node_deserialize_bin(const void *data, size_t size)
+{
+    struct ngl_node *node = NULL;
+    struct bin_header header;
+
+    if ((uintptr_t)data % sizeof(double)) {
+        LOG(ERROR, "binary scene data must be aligned on %d bytes", (int)sizeof(double));
+        return NULL;
+    }
+
+    if (size < sizeof(header)) {
+        LOG(ERROR, "invalid binary scene");
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (check_header(&header, size) < 0)
+        return NULL;
+
+    struct darray nodes_array;
+    ngli_darray_init(&nodes_array, sizeof(struct ngl_node *), 0);
+
+    struct reader r = {
+        .ptr = (const uint8_t *)data + header.nodes_offset,
+        .end = (const uint8_t *)data + header.nodes_offset + header.nodes_size,
+    };
+    for (uint32_t i = 0; i < header.nb_nodes; i++) {
+        uint32_t type, nb_params;
+        if (read_u32(&r, &type) < 0 || read_u32(&r, &nb_params) < 0) {
+            node = NULL;
+            break;
+        }
+
+        node = ngl_node_create(type);
+        if (!node)
+            break;
+
+        if (!ngli_darray_push(&nodes_array, &node)) {
+            ngl_node_unrefp(&node);
+            break;
+        }
+
+        int ret = set_node_params(&nodes_array, &r, &header, data, node, nb_params);
+        if (ret < 0) {
+            node = NULL;
+            break;
+        }
+    }
+
+    if (node)
+        ngl_node_ref(node);
+
+    struct ngl_node **nodes = ngli_darray_data(&nodes_array);
+    for (int i = 0; i < ngli_darray_count(&nodes_array); i++)
+        ngl_node_unrefp(&nodes[i]);
+
+    ngli_darray_reset(&nodes_array);
+    return node;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "easinglut.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "utils.h"
+
+#define MIN_SEGMENTS 8
+#define MAX_SEGMENTS (1 << 14)
+#define NB_CHECKS_PER_SEGMENT 16
+#define ERROR_MARGIN 0.5 // account for the error peaks between the check points
+
+/*
+ * Build the cubic Hermite segments. The tangents are estimated within each
+ * segment with one-sided finite differences so that derivative
+ * discontinuities falling on a segment boundary are preserved.
+ */
+#define TANGENT_STEP_DIV 16
+
+static void build_segments(double (*coeffs)[4], const double *y, int nb_segments,
+                           ngli_easinglut_func_type func, void *user_arg)
+{
+    const double step = 1. / (nb_segments * TANGENT_STEP_DIV);
+    const double scale = TANGENT_STEP_DIV / 2.;
+    for (int i = 0; i < nb_segments; i++) {
+        const double x0 = i / (double)nb_segments;
+        const double x1 = (i + 1) / (double)nb_segments;
+        const double y0 = y[i];
+        const double y1 = y[i + 1];
+        const double m0 = scale * (-3. * y0 + 4. * func(user_arg, x0 + step) - func(user_arg, x0 + 2. * step));
+        const double m1 = scale * ( 3. * y1 - 4. * func(user_arg, x1 - step) + func(user_arg, x1 - 2. * step));
+        coeffs[i][0] = y0;
+        coeffs[i][1] = m0;
+        coeffs[i][2] = 3. * (y1 - y0) - 2. * m0 - m1;
+        coeffs[i][3] = 2. * (y0 - y1) + m0 + m1;
+    }
+}
+
+static double get_max_error(const struct easinglut *s, ngli_easinglut_func_type func, void *user_arg)
+{
+    double max_error = 0.;
+    for (int i = 0; i < s->nb_segments; i++) {
+        for (int j = 1; j < NB_CHECKS_PER_SEGMENT; j++) {
+            const double x = (i + j / (double)NB_CHECKS_PER_SEGMENT) / s->nb_segments;
+            const double error = fabs(ngli_easinglut_evaluate(s, x) - func(user_arg, x));
+            if (!(error <= max_error)) // also catches NaN
+                max_error = error;
+        }
+    }
+    return max_error;
+}
+
+int ngli_easinglut_init(struct easinglut *s, ngli_easinglut_func_type func, void *user_arg, double tolerance)
+{
+    memset(s, 0, sizeof(*s));
+
+    if (tolerance <= 0.)
+        return NGL_ERROR_INVALID_ARG;
+
+    double *y = ngli_calloc(MAX_SEGMENTS + 1, sizeof(*y));
+    if (!y)
+        return NGL_ERROR_MEMORY;
+
+    int ret = NGL_ERROR_LIMIT_EXCEEDED;
+    double error = 0.;
+    for (int nb_segments = MIN_SEGMENTS; nb_segments <= MAX_SEGMENTS; nb_segments *= 2) {
+        for (int i = 0; i <= nb_segments; i++)
+            y[i] = func(user_arg, i / (double)nb_segments);
+
+        double (*coeffs)[4] = ngli_realloc(s->coeffs, nb_segments * sizeof(*s->coeffs));
+        if (!coeffs) {
+            ret = NGL_ERROR_MEMORY;
+            break;
+        }
+        s->coeffs = coeffs;
+        s->nb_segments = nb_segments;
+        build_segments(s->coeffs, y, nb_segments, func, user_arg);
+
+        error = get_max_error(s, func, user_arg);
+        if (error <= tolerance * ERROR_MARGIN) {
+            LOG(DEBUG, "approximated easing with %d segments (max error: %g)", nb_segments, error);
+            ret = 0;
+            break;
+        }
+    }
+
+    ngli_free(y);
+    if (ret < 0) {
+        if (ret == NGL_ERROR_LIMIT_EXCEEDED)
+            LOG(WARNING, "unable to approximate easing within %g (reached %g with %d segments)",
+                tolerance, error, s->nb_segments);
+        ngli_easinglut_reset(s);
+    }
+    return ret;
+}
+
+void ngli_easinglut_reset(struct easinglut *s)
+{
+    ngli_freep(&s->coeffs);
+    memset(s, 0, sizeof(*s));
+}
+
+struct cache_entry {
+    struct easinglut lut;
+    int refcount;
+};
+
+static void free_cache_entry(void *user_arg, void *data)
+{
+    struct cache_entry *entry = data;
+    ngli_easinglut_reset(&entry->lut);
+    ngli_free(entry);
+}
+
+struct hmap *ngli_easinglut_cache_create(void)
+{
+    struct hmap *cache = ngli_hmap_create();
+    if (!cache)
+        return NULL;
+    ngli_hmap_set_free(cache, free_cache_entry, NULL);
+    return cache;
+}
+
+int ngli_easinglut_cache_get(struct hmap *cache, const char *key, const struct easinglut **lutp,
+                             ngli_easinglut_func_type func, void *user_arg, double tolerance)
+{
+    struct cache_entry *entry = ngli_hmap_get(cache, key);
+    if (!entry) {
+        entry = ngli_calloc(1, sizeof(*entry));
+        if (!entry)
+            return NGL_ERROR_MEMORY;
+
+        /* Failing to honor the tolerance is cached as well */
+        int ret = ngli_easinglut_init(&entry->lut, func, user_arg, tolerance);
+        if (ret < 0 && ret != NGL_ERROR_LIMIT_EXCEEDED) {
+            ngli_free(entry);
+            return ret;
+        }
+
+        ret = ngli_hmap_set(cache, key, entry);
+        if (ret < 0) {
+            free_cache_entry(NULL, entry);
+            return ret;
+        }
+    }
+    entry->refcount++;
+    *lutp = entry->lut.nb_segments ? &entry->lut : NULL;
+    return 0;
+}
+
+void ngli_easinglut_cache_release(struct hmap *cache, const char *key)
+{
+    struct cache_entry *entry = ngli_hmap_get(cache, key);
+    if (!entry)
+        return;
+    ngli_assert(entry->refcount > 0);
+    if (--entry->refcount == 0)
+        ngli_hmap_set(cache, key, NULL);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef EASINGLUT_H
+#define EASINGLUT_H
+
+typedef double (*ngli_easinglut_func_type)(void *user_arg, double x);
+
+/*
+ * Piecewise cubic approximation of a function over [0,1], made of uniform
+ * segments interpolating the function at their boundaries. The number of
+ * segments is doubled until the error measured at a regular set of points
+ * within each segment is below the requested tolerance. The error is not
+ * measured between these points, so the tolerance is not a strict bound.
+ */
+struct easinglut {
+    int nb_segments;
+    double (*coeffs)[4];
+};
+
+int ngli_easinglut_init(struct easinglut *s, ngli_easinglut_func_type func, void *user_arg, double tolerance);
+
+static inline double ngli_easinglut_evaluate(const struct easinglut *s, double x)
+{
+    const double pos = x * s->nb_segments;
+    int i = (int)pos;
+    i = i < 0 ? 0 : i;
+    i = i > s->nb_segments - 1 ? s->nb_segments - 1 : i;
+    const double u = pos - i;
+    const double *c = s->coeffs[i];
+    return ((c[3] * u + c[2]) * u + c[1]) * u + c[0];
+}
+
+void ngli_easinglut_reset(struct easinglut *s);
+
+/*
+ * Cache of approximations shared between users of identical functions,
+ * identified by a caller defined key. A NULL approximation is returned if
+ * the tolerance could not be honored, in which case the exact function is
+ * expected to be used.
+ */
+struct hmap *ngli_easinglut_cache_create(void);
+int ngli_easinglut_cache_get(struct hmap *cache, const char *key, const struct easinglut **lutp,
+                             ngli_easinglut_func_type func, void *user_arg, double tolerance);
+void ngli_easinglut_cache_release(struct hmap *cache, const char *key);
+
+#endif
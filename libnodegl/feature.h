@@ -58,6 +58,7 @@
 #define NGLI_FEATURE_SHADER_IMAGE_SIZE            (1ULL << 33)
 #define NGLI_FEATURE_SHADING_LANGUAGE_420PACK     (1ULL << 34)
 #define NGLI_FEATURE_SHADER_TEXTURE_LOD           (1ULL << 35)
+#define NGLI_FEATURE_PIXEL_BUFFER_OBJECT          (1ULL << 36)
 
 #define NGLI_FEATURE_COMPUTE_SHADER_ALL (NGLI_FEATURE_COMPUTE_SHADER           | \
                                          NGLI_FEATURE_PROGRAM_INTERFACE_QUERY  | \
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+
+#include "hexfloat.h"
+#include "nodegl.h"
+
+static const char hex_digits[16] = "0123456789ABCDEF";
+
+/* Value of the hexadecimal digits plus one, 0 for any other character */
+static const uint8_t hex_values[256] = {
+    ['0'] = 0x1, ['1'] = 0x2, ['2'] = 0x3, ['3'] = 0x4,
+    ['4'] = 0x5, ['5'] = 0x6, ['6'] = 0x7, ['7'] = 0x8,
+    ['8'] = 0x9, ['9'] = 0xa, ['a'] = 0xb, ['b'] = 0xc,
+    ['c'] = 0xd, ['d'] = 0xe, ['e'] = 0xf, ['f'] = 0x10,
+    ['A'] = 0xb, ['B'] = 0xc, ['C'] = 0xd, ['D'] = 0xe,
+    ['E'] = 0xf, ['F'] = 0x10,
+};
+
+static int write_hex(char *dst, uint64_t v)
+{
+    int n = 1;
+    while (n < 16 && v >> (4 * n))
+        n++;
+    for (int i = n - 1; i >= 0; i--) {
+        dst[i] = hex_digits[v & 0xf];
+        v >>= 4;
+    }
+    return n;
+}
+
+/* Return the number of digits read, 0 if there is none or too many */
+static int read_hex(const char *s, int max_digits, uint64_t *vp)
+{
+    uint64_t v = 0;
+    int n = 0;
+    for (; n < max_digits; n++) {
+        const int d = hex_values[(uint8_t)s[n]];
+        if (!d)
+            break;
+        v = v << 4 | (d - 1);
+    }
+    if (hex_values[(uint8_t)s[n]])
+        return 0;
+    *vp = v;
+    return n;
+}
+
+#define DECLARE_HEXFLOAT_FUNCS(name, type, nbit, shift_exp, z)                  \
+int ngli_hexfloat_write_##name(char *dst, type v)                               \
+{                                                                               \
+    const union { uint##nbit##_t i; type f; } u = {.f = v};                     \
+    const uint##nbit##_t exp_mask = (1 << (nbit - shift_exp - 1)) - 1;          \
+    char *p = dst;                                                              \
+    if (u.i >> (nbit - 1))                                                      \
+        *p++ = '-';                                                             \
+    p += write_hex(p, u.i >> shift_exp & exp_mask);                             \
+    *p++ = z;                                                                   \
+    p += write_hex(p, u.i & ((1ULL << shift_exp) - 1));                         \
+    return (int)(p - dst);                                                      \
+}                                                                               \
+                                                                                \
+int ngli_hexfloat_write_##name##s(char *dst, const type *v, int n)              \
+{                                                                               \
+    char *p = dst;                                                              \
+    for (int i = 0; i < n; i++) {                                               \
+        if (i)                                                                  \
+            *p++ = ',';                                                         \
+        p += ngli_hexfloat_write_##name(p, v[i]);                               \
+    }                                                                           \
+    return (int)(p - dst);                                                      \
+}                                                                               \
+                                                                                \
+int ngli_hexfloat_read_##name(const char *s, type *vp)                          \
+{                                                                               \
+    union { uint##nbit##_t i; type f; } u = {.i = 0};                           \
+    const char *p = s;                                                          \
+    if (*p == '-') {                                                            \
+        u.i = 1ULL << (nbit - 1);                                               \
+        p++;                                                                    \
+    }                                                                           \
+                                                                                \
+    /* The fields must not overflow into each other nor into the sign */        \
+    uint64_t exp, mant;                                                         \
+    int n = read_hex(p, (nbit - shift_exp - 1 + 3) / 4, &exp);                  \
+    if (!n || p[n] != z || exp >= 1ULL << (nbit - shift_exp - 1))               \
+        return NGL_ERROR_INVALID_DATA;                                          \
+    p += n + 1;                                                                 \
+    n = read_hex(p, (shift_exp + 3) / 4, &mant);                                \
+    if (!n || mant >= 1ULL << shift_exp)                                        \
+        return NGL_ERROR_INVALID_DATA;                                          \
+    p += n;                                                                     \
+                                                                                \
+    u.i |= (uint##nbit##_t)(exp << shift_exp | mant);                           \
+    *vp = u.f;                                                                  \
+    return (int)(p - s);                                                        \
+}                                                                               \
+                                                                                \
+int ngli_hexfloat_read_##name##s(const char *s, type *vals, int max_vals,       \
+                                 int *nb_valsp)                                 \
+{                                                                               \
+    const char *p = s;                                                          \
+    int nb_vals = 0;                                                            \
+    for (;;) {                                                                  \
+        if (nb_vals == max_vals)                                                \
+            return NGL_ERROR_INVALID_DATA;                                      \
+        const int len = ngli_hexfloat_read_##name(p, &vals[nb_vals]);           \
+        if (len < 0)                                                            \
+            return len;                                                         \
+        p += len;                                                               \
+        nb_vals++;                                                              \
+        if (*p != ',')                                                          \
+            break;                                                              \
+        p++;                                                                    \
+    }                                                                           \
+    *nb_valsp = nb_vals;                                                        \
+    return (int)(p - s);                                                        \
+}
+
+DECLARE_HEXFLOAT_FUNCS(f32, float,  32, 23, 'z')
+DECLARE_HEXFLOAT_FUNCS(f64, double, 64, 52, 'Z')
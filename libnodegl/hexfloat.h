@@ -0,0 +1,56 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef HEXFLOAT_H
+#define HEXFLOAT_H
+
+/*
+ * Lossless text representation of the floating point numbers used by the
+ * serialized scenes: an optional '-' sign, followed by the biased exponent and
+ * the mantissa, both in uppercase hexadecimal without leading zeros, and
+ * separated by 'z' for floats and 'Z' for doubles (1.0f is "7Fz0").
+ */
+
+/* Maximum size of a single encoded number (sign included, nul excluded) */
+#define NGLI_HEXFLOAT_F32_MAX_LEN 10
+#define NGLI_HEXFLOAT_F64_MAX_LEN 18
+
+/*
+ * The write functions do not nul terminate the output and return the number
+ * of characters written. The list variants separate the numbers with ','
+ * and require dst to hold at least n * (MAX_LEN + 1) characters.
+ */
+int ngli_hexfloat_write_f32(char *dst, float v);
+int ngli_hexfloat_write_f64(char *dst, double v);
+int ngli_hexfloat_write_f32s(char *dst, const float *v, int n);
+int ngli_hexfloat_write_f64s(char *dst, const double *v, int n);
+
+/*
+ * The read functions return the number of characters consumed or
+ * NGL_ERROR_INVALID_DATA. The list variants parse up to max_vals numbers
+ * separated by ',' and fail if the list is longer.
+ */
+int ngli_hexfloat_read_f32(const char *s, float *vp);
+int ngli_hexfloat_read_f64(const char *s, double *vp);
+int ngli_hexfloat_read_f32s(const char *s, float *vals, int max_vals, int *nb_valsp);
+int ngli_hexfloat_read_f64s(const char *s, double *vals, int max_vals, int *nb_valsp);
+
+#endif
@@ -56,6 +56,7 @@ struct hud {
     struct canvas canvas;
     double refresh_rate_interval;
     double last_refresh_time;
+    uint64_t attach_generation;
 
     struct pgcraft *crafter;
     struct texture *texture;
@@ -1027,10 +1028,37 @@ static void widget_drawcall_reset_draws(struct widget *widget)
     }
 }
 
+/*
+ * The children lazily initialized by the TimeRangeFilter nodes are attached
+ * after the widgets are initialized: the sets of nodes tracked by the widgets
+ * are built again to include them.
+ */
+static int widgets_track_nodes(struct hud *s)
+{
+    struct darray *widgets_array = &s->widgets;
+    struct widget *widgets = ngli_darray_data(widgets_array);
+    for (int i = 0; i < ngli_darray_count(widgets_array); i++) {
+        struct widget *widget = &widgets[i];
+        if (widget->type == WIDGET_LATENCY)
+            continue;
+        widget_specs[widget->type].uninit(s, widget);
+        int ret = widget_specs[widget->type].init(s, widget);
+        if (ret < 0)
+            return ret;
+    }
+    s->attach_generation = s->ctx->attach_generation;
+    return 0;
+}
+
 static void widgets_make_stats(struct hud *s)
 {
     struct darray *widgets_array = &s->widgets;
     struct widget *widgets = ngli_darray_data(widgets_array);
+    if (s->attach_generation != s->ctx->attach_generation) {
+        int ret = widgets_track_nodes(s);
+        if (ret < 0)
+            LOG(ERROR, "unable to track the attached nodes: %s", NGLI_RET_STR(ret));
+    }
     for (int i = 0; i < ngli_darray_count(widgets_array); i++) {
         struct widget *widget = &widgets[i];
         widget_specs[widget->type].make_stats(s, widget);
@@ -1178,6 +1206,7 @@ int ngli_hud_init(struct hud *s)
     if (s->refresh_rate[1])
         s->refresh_rate_interval = s->refresh_rate[0] / (double)s->refresh_rate[1];
     s->last_refresh_time = -1;
+    s->attach_generation = ctx->attach_generation;
 
     int ret = widgets_init(s);
     if (ret < 0)
@@ -47,6 +47,17 @@ static const char *frag_base =
     "    ngl_out_color = ngli_texvideo(tex, var_tex_coord);"                    "\n"
     "}";
 
+/*
+ * The ngli_texvideo() fast path only knows about the default hardware layout
+ * of the target, so the planar YUV layout goes through the sampling mode
+ * selection of ngl_texvideo() instead.
+ */
+static const char *frag_base_yuv =
+    "void main()"                                                               "\n"
+    "{"                                                                         "\n"
+    "    ngl_out_color = ngl_texvideo(tex, var_tex_coord);"                     "\n"
+    "}";
+
 static const struct pgcraft_iovar vert_out_vars[] = {
     {.name = "var_tex_coord", .type = NGLI_TYPE_VEC2},
 };
@@ -91,7 +102,8 @@ int ngli_hwconv_init(struct hwconv *hwconv, struct ngl_ctx *ctx,
     enum image_layout src_layout = src_params->layout;
     if (src_layout != NGLI_IMAGE_LAYOUT_NV12 &&
         src_layout != NGLI_IMAGE_LAYOUT_NV12_RECTANGLE &&
-        src_layout != NGLI_IMAGE_LAYOUT_MEDIACODEC) {
+        src_layout != NGLI_IMAGE_LAYOUT_MEDIACODEC &&
+        src_layout != NGLI_IMAGE_LAYOUT_YUV) {
         LOG(ERROR, "unsupported texture layout: 0x%x", src_layout);
         return NGL_ERROR_UNSUPPORTED;
     }
@@ -139,7 +151,7 @@ int ngli_hwconv_init(struct hwconv *hwconv, struct ngl_ctx *ctx,
 
     const struct pgcraft_params crafter_params = {
         .vert_base        = vert_base,
-        .frag_base        = frag_base,
+        .frag_base        = src_layout == NGLI_IMAGE_LAYOUT_YUV ? frag_base_yuv : frag_base,
         .textures         = textures,
         .nb_textures      = NGLI_ARRAY_NB(textures),
         .attributes       = attributes,
@@ -210,6 +222,11 @@ int ngli_hwconv_convert_image(struct hwconv *hwconv, const struct image *image)
         ret = ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_Y_RECT_SAMPLER].index, image->planes[0]);
         ret &= ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_UV_RECT_SAMPLER].index, image->planes[1]);
         break;
+    case NGLI_IMAGE_LAYOUT_YUV:
+        ret = ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_Y_SAMPLER].index, image->planes[0]);
+        ret &= ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_U_SAMPLER].index, image->planes[1]);
+        ret &= ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_V_SAMPLER].index, image->planes[2]);
+        break;
     case NGLI_IMAGE_LAYOUT_MEDIACODEC:
         ret = ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_OES_SAMPLER].index, image->planes[0]);
         break;
@@ -219,6 +236,8 @@ int ngli_hwconv_convert_image(struct hwconv *hwconv, const struct image *image)
     ngli_assert(ret == 0);
     ngli_pipeline_update_uniform(pipeline, fields[NGLI_INFO_FIELD_COORDINATE_MATRIX].index, image->coordinates_matrix);
     ngli_pipeline_update_uniform(pipeline, fields[NGLI_INFO_FIELD_COLOR_MATRIX].index, image->color_matrix);
+    const int layout = image->params.layout;
+    ngli_pipeline_update_uniform(pipeline, fields[NGLI_INFO_FIELD_SAMPLING_MODE].index, &layout);
 
     ngli_pipeline_draw(hwconv->pipeline, 4, 1);
 
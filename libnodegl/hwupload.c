@@ -33,6 +33,8 @@
 #include "nodes.h"
 
 extern const struct hwmap_class ngli_hwmap_common_class;
+extern const struct hwmap_class ngli_hwmap_nv12_class;
+extern const struct hwmap_class ngli_hwmap_yuv420p_class;
 extern const struct hwmap_class ngli_hwmap_mc_gl_class;
 extern const struct hwmap_class ngli_hwmap_vt_darwin_gl_class;
 extern const struct hwmap_class ngli_hwmap_vt_ios_gl_class;
@@ -42,6 +44,10 @@ static const struct hwmap_class *hwupload_gl_class_map[] = {
     [SXPLAYER_PIXFMT_RGBA]        = &ngli_hwmap_common_class,
     [SXPLAYER_PIXFMT_BGRA]        = &ngli_hwmap_common_class,
     [SXPLAYER_SMPFMT_FLT]         = &ngli_hwmap_common_class,
+#if defined(TARGET_IPHONE) || defined(TARGET_LINUX)
+    [SXPLAYER_PIXFMT_NV12]        = &ngli_hwmap_nv12_class,
+    [SXPLAYER_PIXFMT_YUV420P]     = &ngli_hwmap_yuv420p_class,
+#endif
 #ifdef BACKEND_GL
 #if defined(TARGET_ANDROID)
     [SXPLAYER_PIXFMT_MEDIACODEC]  = &ngli_hwmap_mc_gl_class,
@@ -70,7 +76,6 @@ static const struct hwmap_class *get_hwmap_class(int backend, struct sxplayer_fr
 static int init_hwconv(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
-    struct gctx *gctx = ctx->gctx;
     struct texture_priv *s = node->priv_data;
     struct image *image = &s->image;
     struct hwupload *hwupload = &s->hwupload;
@@ -79,7 +84,7 @@ static int init_hwconv(struct ngl_node *node)
 
     ngli_hwconv_reset(hwconv);
     ngli_image_reset(image);
-    ngli_texture_freep(&s->texture);
+    ngli_texturepool_release_texture(&ctx->texturepool, &s->texture);
 
     LOG(DEBUG, "converting texture '%s' from %s to rgba", node->label, hwupload->hwmap_class->name);
 
@@ -89,10 +94,7 @@ static int init_hwconv(struct ngl_node *node)
     params.height = mapped_image->params.height;
     params.usage |= NGLI_TEXTURE_USAGE_COLOR_ATTACHMENT_BIT;
 
-    s->texture = ngli_texture_create(gctx);
-    if (!s->texture)
-        return NGL_ERROR_MEMORY;
-    int ret = ngli_texture_init(s->texture, &params);
+    int ret = ngli_texturepool_get_texture(&ctx->texturepool, &s->texture, &params);
     if (ret < 0)
         goto end;
 
@@ -113,7 +115,7 @@ static int init_hwconv(struct ngl_node *node)
 end:
     ngli_hwconv_reset(hwconv);
     ngli_image_reset(image);
-    ngli_texture_freep(&s->texture);
+    ngli_texturepool_release_texture(&ctx->texturepool, &s->texture);
     return ret;
 }
 
@@ -135,6 +137,13 @@ static int exec_hwconv(struct ngl_node *node)
     return 0;
 }
 
+static void release_frame(const struct media_priv *media, struct sxplayer_frame *frame)
+{
+    /* frames held by the media frame cache are released by the media node */
+    if (!media->frame_cached)
+        sxplayer_release_frame(frame);
+}
+
 int ngli_hwupload_upload_frame(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -149,7 +158,7 @@ int ngli_hwupload_upload_frame(struct ngl_node *node)
 
     const struct hwmap_class *hwmap_class = get_hwmap_class(config->backend, frame);
     if (!hwmap_class) {
-        sxplayer_release_frame(frame);
+        release_frame(media, frame);
         return NGL_ERROR_UNSUPPORTED;
     }
 
@@ -161,14 +170,14 @@ int ngli_hwupload_upload_frame(struct ngl_node *node)
         if (hwmap_class->priv_size) {
             hwupload->hwmap_priv_data = ngli_calloc(1, hwmap_class->priv_size);
             if (!hwupload->hwmap_priv_data) {
-                sxplayer_release_frame(frame);
+                release_frame(media, frame);
                 return NGL_ERROR_MEMORY;
             }
         }
 
         int ret = hwmap_class->init(node, frame);
         if (ret < 0) {
-            sxplayer_release_frame(frame);
+            release_frame(media, frame);
             return ret;
         }
         hwupload->hwmap_class = hwmap_class;
@@ -198,7 +207,7 @@ end:
     s->image.ts = frame->ts;
 
     if (!(hwmap_class->flags &  HWMAP_FLAG_FRAME_OWNER))
-        sxplayer_release_frame(frame);
+        release_frame(media, frame);
     return ret;
 }
 
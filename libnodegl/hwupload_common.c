@@ -48,7 +48,6 @@ static int common_get_data_format(int pix_fmt)
 static int common_init(struct ngl_node *node, struct sxplayer_frame *frame)
 {
     struct ngl_ctx *ctx = node->ctx;
-    struct gctx *gctx = ctx->gctx;
     struct texture_priv *s = node->priv_data;
     struct hwupload *hwupload = &s->hwupload;
 
@@ -59,12 +58,10 @@ static int common_init(struct ngl_node *node, struct sxplayer_frame *frame)
     params.format = common_get_data_format(frame->pix_fmt);
     if (params.format < 0)
         return -1;
+    params.usage |= NGLI_TEXTURE_USAGE_DYNAMIC_BIT;
 
-    s->texture = ngli_texture_create(gctx);
-    if (!s->texture)
-        return NGL_ERROR_MEMORY;
-
-    int ret = ngli_texture_init(s->texture, &params);
+    ngli_texturepool_release_texture(&ctx->texturepool, &s->texture);
+    int ret = ngli_texturepool_get_texture(&ctx->texturepool, &s->texture, &params);
     if (ret < 0)
         return ret;
 
@@ -86,8 +83,6 @@ static int common_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
     struct texture_priv *s = node->priv_data;
 
     if (!ngli_texture_match_dimensions(s->texture, frame->width, frame->height, 0)) {
-        ngli_texture_freep(&s->texture);
-
         int ret = common_init(node, frame);
         if (ret < 0)
             return ret;
@@ -102,3 +97,147 @@ const struct hwmap_class ngli_hwmap_common_class = {
     .init      = common_init,
     .map_frame = common_map_frame,
 };
+
+struct planar_desc {
+    enum image_layout layout;
+    int nb_planes;
+    int formats[3];
+    int log2_chroma_w;
+    int log2_chroma_h;
+};
+
+static const struct planar_desc *get_planar_desc(int pix_fmt)
+{
+    static const struct planar_desc nv12_desc = {
+        .layout        = NGLI_IMAGE_LAYOUT_NV12,
+        .nb_planes     = 2,
+        .formats       = {NGLI_FORMAT_R8_UNORM, NGLI_FORMAT_R8G8_UNORM},
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+    };
+    static const struct planar_desc yuv420p_desc = {
+        .layout        = NGLI_IMAGE_LAYOUT_YUV,
+        .nb_planes     = 3,
+        .formats       = {NGLI_FORMAT_R8_UNORM, NGLI_FORMAT_R8_UNORM, NGLI_FORMAT_R8_UNORM},
+        .log2_chroma_w = 1,
+        .log2_chroma_h = 1,
+    };
+
+    switch (pix_fmt) {
+    case SXPLAYER_PIXFMT_NV12:
+        return &nv12_desc;
+    case SXPLAYER_PIXFMT_YUV420P:
+        return &yuv420p_desc;
+    default:
+        return NULL;
+    }
+}
+
+struct hwupload_planar {
+    struct texture *planes[3];
+    int nb_planes;
+};
+
+static int support_direct_rendering(struct ngl_node *node, enum image_layout layout)
+{
+    const struct texture_priv *s = node->priv_data;
+    int direct_rendering = s->supported_image_layouts & (1 << layout);
+
+    if (direct_rendering && s->params.mipmap_filter) {
+        LOG(WARNING,
+            "planar direct rendering does not support mipmapping: "
+            "disabling direct rendering");
+        direct_rendering = 0;
+    }
+
+    return direct_rendering;
+}
+
+static void planar_uninit(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload *hwupload = &s->hwupload;
+    struct hwupload_planar *planar = hwupload->hwmap_priv_data;
+
+    for (int i = 0; i < planar->nb_planes; i++)
+        ngli_texturepool_release_texture(&ctx->texturepool, &planar->planes[i]);
+    planar->nb_planes = 0;
+}
+
+static int planar_init(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct texture_priv *s = node->priv_data;
+    struct hwupload *hwupload = &s->hwupload;
+    struct hwupload_planar *planar = hwupload->hwmap_priv_data;
+
+    const struct planar_desc *desc = get_planar_desc(frame->pix_fmt);
+    if (!desc)
+        return NGL_ERROR_UNSUPPORTED;
+
+    for (int i = 0; i < desc->nb_planes; i++) {
+        const int chroma = i > 0;
+
+        struct texture_params params = s->params;
+        params.format        = desc->formats[i];
+        params.width         = (frame->width  + (1 << (desc->log2_chroma_w * chroma)) - 1) >> (desc->log2_chroma_w * chroma);
+        params.height        = (frame->height + (1 << (desc->log2_chroma_h * chroma)) - 1) >> (desc->log2_chroma_h * chroma);
+        params.mipmap_filter = NGLI_MIPMAP_FILTER_NONE;
+        params.usage         = NGLI_TEXTURE_USAGE_TRANSFER_DST_BIT
+                             | NGLI_TEXTURE_USAGE_SAMPLED_BIT
+                             | NGLI_TEXTURE_USAGE_DYNAMIC_BIT;
+
+        int ret = ngli_texturepool_get_texture(&ctx->texturepool, &planar->planes[i], &params);
+        if (ret < 0) {
+            planar_uninit(node);
+            return ret;
+        }
+        planar->nb_planes++;
+    }
+
+    struct image_params image_params = {
+        .width = frame->width,
+        .height = frame->height,
+        .layout = desc->layout,
+        .color_info = ngli_color_info_from_sxplayer_frame(frame),
+    };
+    ngli_image_init(&hwupload->mapped_image, &image_params, planar->planes);
+
+    hwupload->require_hwconv = !support_direct_rendering(node, desc->layout);
+
+    return 0;
+}
+
+static int planar_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
+{
+    struct texture_priv *s = node->priv_data;
+    struct hwupload *hwupload = &s->hwupload;
+    struct hwupload_planar *planar = hwupload->hwmap_priv_data;
+
+    for (int i = 0; i < planar->nb_planes; i++) {
+        struct texture *plane = planar->planes[i];
+        const int linesize = frame->linesizep[i] / plane->bytes_per_pixel;
+        int ret = ngli_texture_upload(plane, frame->datap[i], linesize);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+const struct hwmap_class ngli_hwmap_nv12_class = {
+    .name      = "nv12",
+    .priv_size = sizeof(struct hwupload_planar),
+    .init      = planar_init,
+    .map_frame = planar_map_frame,
+    .uninit    = planar_uninit,
+};
+
+const struct hwmap_class ngli_hwmap_yuv420p_class = {
+    .name      = "yuv420p",
+    .priv_size = sizeof(struct hwupload_planar),
+    .init      = planar_init,
+    .map_frame = planar_map_frame,
+    .uninit    = planar_uninit,
+};
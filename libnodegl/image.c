@@ -43,6 +43,7 @@ static const int nb_planes_map[] = {
     [NGLI_IMAGE_LAYOUT_MEDIACODEC]     = 1,
     [NGLI_IMAGE_LAYOUT_NV12]           = 2,
     [NGLI_IMAGE_LAYOUT_NV12_RECTANGLE] = 2,
+    [NGLI_IMAGE_LAYOUT_YUV]            = 3,
 };
 
 NGLI_STATIC_ASSERT(nb_planes_map, NGLI_ARRAY_NB(nb_planes_map) == NGLI_NB_IMAGE_LAYOUTS);
@@ -56,7 +57,8 @@ void ngli_image_init(struct image *s, const struct image_params *params, struct
     for (int i = 0; i < s->nb_planes; i++)
         s->planes[i] = planes[i];
     if (params->layout == NGLI_IMAGE_LAYOUT_NV12 ||
-        params->layout == NGLI_IMAGE_LAYOUT_NV12_RECTANGLE) {
+        params->layout == NGLI_IMAGE_LAYOUT_NV12_RECTANGLE ||
+        params->layout == NGLI_IMAGE_LAYOUT_YUV) {
         ngli_colorconv_get_ycbcr_to_rgb_color_matrix(s->color_matrix, &params->color_info);
     }
 }
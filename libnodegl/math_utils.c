@@ -221,7 +221,7 @@ void ngli_mat3_adjugate(float *dst, const float* m)
     memcpy(dst, tmp, sizeof(tmp));
 }
 
-void ngli_mat3_inverse(float *dst, const float *m)
+void ngli_mat3_inverse_c(float *dst, const float *m)
 {
     float a[3*3];
     float det = ngli_mat3_determinant(m);
@@ -262,6 +262,12 @@ void ngli_mat4_mul_c(float *dst, const float *m1, const float *m2)
     memcpy(dst, m, sizeof(m));
 }
 
+void ngli_mat4_mul_array_c(float *dst, const float *m1, const float *m2, int count)
+{
+    for (int i = 0; i < count; i++)
+        ngli_mat4_mul_c(dst + i * 4 * 4, m1, m2 + i * 4 * 4);
+}
+
 void ngli_mat4_mul_vec4_c(float *dst, const float *m, const float *v)
 {
     float tmp[4];
@@ -475,7 +481,7 @@ void ngli_mat4_skew(float *dst, float x, float y, float z, const float *axis)
 
 #define COS_ALPHA_THRESHOLD 0.9995f
 
-void ngli_quat_slerp(float *dst, const float *q1, const float *q2, float t)
+void ngli_quat_slerp_c(float *dst, const float *q1, const float *q2, float t)
 {
     float tmp_q1[4];
     const float *tmp_q1p = q1;
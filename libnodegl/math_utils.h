@@ -54,7 +54,7 @@ void ngli_mat3_mul_scalar(float *dst, const float *m, float s);
 void ngli_mat3_transpose(float *dst, const float *m);
 float ngli_mat3_determinant(const float *m);
 void ngli_mat3_adjugate(float *dst, const float* m);
-void ngli_mat3_inverse(float *dst, const float *m);
+void ngli_mat3_inverse_c(float *dst, const float *m);
 
 #define NGLI_MAT4_IDENTITY {1.0f, 0.0f, 0.0f, 0.0f, \
                             0.0f, 1.0f, 0.0f, 0.0f, \
@@ -63,6 +63,7 @@ void ngli_mat3_inverse(float *dst, const float *m);
 
 void ngli_mat4_identity(float *dst);
 void ngli_mat4_mul_c(float *dst, const float *m1, const float *m2);
+void ngli_mat4_mul_array_c(float *dst, const float *m1, const float *m2, int count);
 void ngli_mat4_mul_vec4_c(float *dst, const float *m, const float *v);
 void ngli_mat4_look_at(float *dst, float *eye, float *center, float *up);
 void ngli_mat4_orthographic(float *dst, float left, float right, float bottom, float top, float near, float far);
@@ -73,21 +74,39 @@ void ngli_mat4_translate(float *dst, float x, float y, float z);
 void ngli_mat4_scale(float *dst, float x, float y, float z);
 void ngli_mat4_skew(float *dst, float x, float y, float z, const float *axis);
 
+#define NGLI_QUAT_IDENTITY {0.0f, 0.0f, 0.0f, 1.0f}
+
+void ngli_quat_slerp_c(float *dst, const float *q1, const float *q2, float t);
+
 /* Arch specific versions */
 
-#ifdef ARCH_AARCH64
+#if defined(ARCH_AARCH64)
+# define ngli_mat3_inverse      ngli_mat3_inverse_c
 # define ngli_mat4_mul          ngli_mat4_mul_aarch64
+# define ngli_mat4_mul_array    ngli_mat4_mul_array_c
 # define ngli_mat4_mul_vec4     ngli_mat4_mul_vec4_aarch64
+# define ngli_quat_slerp        ngli_quat_slerp_c
+#elif defined(ARCH_X86_64)
+# define ngli_mat3_inverse      ngli_mat3_inverse_sse
+# define ngli_mat4_mul          ngli_mat4_mul_sse
+# define ngli_mat4_mul_array    ngli_mat4_mul_array_x86
+# define ngli_mat4_mul_vec4     ngli_mat4_mul_vec4_sse
+# define ngli_quat_slerp        ngli_quat_slerp_sse
 #else
+# define ngli_mat3_inverse      ngli_mat3_inverse_c
 # define ngli_mat4_mul          ngli_mat4_mul_c
+# define ngli_mat4_mul_array    ngli_mat4_mul_array_c
 # define ngli_mat4_mul_vec4     ngli_mat4_mul_vec4_c
+# define ngli_quat_slerp        ngli_quat_slerp_c
 #endif
 
 void ngli_mat4_mul_aarch64(float *dst, const float *m1, const float *m2);
 void ngli_mat4_mul_vec4_aarch64(float *dst, const float *m, const float *v);
 
-#define NGLI_QUAT_IDENTITY {0.0f, 0.0f, 0.0f, 1.0f}
-
-void ngli_quat_slerp(float *dst, const float *q1, const float *q2, float t);
+void ngli_mat3_inverse_sse(float *dst, const float *m);
+void ngli_mat4_mul_sse(float *dst, const float *m1, const float *m2);
+void ngli_mat4_mul_array_x86(float *dst, const float *m1, const float *m2, int count);
+void ngli_mat4_mul_vec4_sse(float *dst, const float *m, const float *v);
+void ngli_quat_slerp_sse(float *dst, const float *q1, const float *q2, float t);
 
 #endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <emmintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+# include <immintrin.h>
+# define HAVE_AVX_DISPATCH 1
+#else
+# define HAVE_AVX_DISPATCH 0
+#endif
+
+#include "math_utils.h"
+
+/*
+ * SSE2 is part of the x86-64 baseline so these versions are selected at
+ * build time. Only the batched matrix multiplication has an AVX version,
+ * selected at runtime, since a single 4x4 matrix already fits in SSE
+ * registers.
+ */
+
+#define SPLAT(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+
+static inline __m128 mat4_mul_vec4(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 v)
+{
+    const __m128 r0 = _mm_add_ps(_mm_mul_ps(c0, SPLAT(v, 0)), _mm_mul_ps(c1, SPLAT(v, 1)));
+    const __m128 r1 = _mm_add_ps(_mm_mul_ps(c2, SPLAT(v, 2)), _mm_mul_ps(c3, SPLAT(v, 3)));
+    return _mm_add_ps(r0, r1);
+}
+
+void ngli_mat4_mul_sse(float *dst, const float *m1, const float *m2)
+{
+    const __m128 c0 = _mm_loadu_ps(m1);
+    const __m128 c1 = _mm_loadu_ps(m1 + 4);
+    const __m128 c2 = _mm_loadu_ps(m1 + 8);
+    const __m128 c3 = _mm_loadu_ps(m1 + 12);
+
+    const __m128 r0 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2));
+    const __m128 r1 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2 + 4));
+    const __m128 r2 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2 + 8));
+    const __m128 r3 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2 + 12));
+
+    _mm_storeu_ps(dst,      r0);
+    _mm_storeu_ps(dst + 4,  r1);
+    _mm_storeu_ps(dst + 8,  r2);
+    _mm_storeu_ps(dst + 12, r3);
+}
+
+void ngli_mat4_mul_vec4_sse(float *dst, const float *m, const float *v)
+{
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+    _mm_storeu_ps(dst, mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(v)));
+}
+
+static void mat4_mul_array_sse(float *dst, const float *m1, const float *m2, int count)
+{
+    const __m128 c0 = _mm_loadu_ps(m1);
+    const __m128 c1 = _mm_loadu_ps(m1 + 4);
+    const __m128 c2 = _mm_loadu_ps(m1 + 8);
+    const __m128 c3 = _mm_loadu_ps(m1 + 12);
+
+    for (int i = 0; i < count; i++) {
+        const __m128 r0 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2));
+        const __m128 r1 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2 + 4));
+        const __m128 r2 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2 + 8));
+        const __m128 r3 = mat4_mul_vec4(c0, c1, c2, c3, _mm_loadu_ps(m2 + 12));
+        _mm_storeu_ps(dst,      r0);
+        _mm_storeu_ps(dst + 4,  r1);
+        _mm_storeu_ps(dst + 8,  r2);
+        _mm_storeu_ps(dst + 12, r3);
+        dst += 4 * 4;
+        m2 += 4 * 4;
+    }
+}
+
+#if HAVE_AVX_DISPATCH
+/*
+ * Two columns of m2 are transformed at once: the columns of m1 are
+ * duplicated in both 128-bit lanes and each lane broadcasts the components
+ * of its own column.
+ */
+#define SPLAT_AVX(v, i) _mm256_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+
+__attribute__((target("avx")))
+static inline __m256 mat4_mul_vec4x2_avx(__m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 v)
+{
+    const __m256 r0 = _mm256_add_ps(_mm256_mul_ps(c0, SPLAT_AVX(v, 0)), _mm256_mul_ps(c1, SPLAT_AVX(v, 1)));
+    const __m256 r1 = _mm256_add_ps(_mm256_mul_ps(c2, SPLAT_AVX(v, 2)), _mm256_mul_ps(c3, SPLAT_AVX(v, 3)));
+    return _mm256_add_ps(r0, r1);
+}
+
+__attribute__((target("avx")))
+static void mat4_mul_array_avx(float *dst, const float *m1, const float *m2, int count)
+{
+    const __m256 c0 = _mm256_broadcast_ps((const __m128 *)m1);
+    const __m256 c1 = _mm256_broadcast_ps((const __m128 *)(m1 + 4));
+    const __m256 c2 = _mm256_broadcast_ps((const __m128 *)(m1 + 8));
+    const __m256 c3 = _mm256_broadcast_ps((const __m128 *)(m1 + 12));
+
+    for (int i = 0; i < count; i++) {
+        const __m256 r01 = mat4_mul_vec4x2_avx(c0, c1, c2, c3, _mm256_loadu_ps(m2));
+        const __m256 r23 = mat4_mul_vec4x2_avx(c0, c1, c2, c3, _mm256_loadu_ps(m2 + 8));
+        _mm256_storeu_ps(dst,     r01);
+        _mm256_storeu_ps(dst + 8, r23);
+        dst += 4 * 4;
+        m2 += 4 * 4;
+    }
+}
+#endif
+
+void ngli_mat4_mul_array_x86(float *dst, const float *m1, const float *m2, int count)
+{
+#if HAVE_AVX_DISPATCH
+    if (__builtin_cpu_supports("avx")) {
+        mat4_mul_array_avx(dst, m1, m2, count);
+        return;
+    }
+#endif
+    mat4_mul_array_sse(dst, m1, m2, count);
+}
+
+static inline __m128 cross3(__m128 a, __m128 b)
+{
+    const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+static inline float hsum(__m128 v)
+{
+    const __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+void ngli_mat3_inverse_sse(float *dst, const float *m)
+{
+    const __m128 r0 = _mm_setr_ps(m[0], m[1], m[2], 0.f);
+    const __m128 r1 = _mm_setr_ps(m[3], m[4], m[5], 0.f);
+    const __m128 r2 = _mm_setr_ps(m[6], m[7], m[8], 0.f);
+
+    /* The adjugate rows are the cross products of the input rows, stored
+     * transposed */
+    __m128 a0 = cross3(r1, r2);
+    __m128 a1 = cross3(r2, r0);
+    __m128 a2 = cross3(r0, r1);
+    const float det = hsum(_mm_mul_ps(r0, a0));
+
+    if (det == 0.0) {
+        memmove(dst, m, 3 * 3 * sizeof(*m));
+        return;
+    }
+
+    __m128 a3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+
+    const __m128 inv_det = _mm_set1_ps(1.0 / det);
+    float tmp[3 * 4];
+    _mm_storeu_ps(tmp,     _mm_mul_ps(a0, inv_det));
+    _mm_storeu_ps(tmp + 4, _mm_mul_ps(a1, inv_det));
+    _mm_storeu_ps(tmp + 8, _mm_mul_ps(a2, inv_det));
+    memcpy(dst,     tmp,     3 * sizeof(*dst));
+    memcpy(dst + 3, tmp + 4, 3 * sizeof(*dst));
+    memcpy(dst + 6, tmp + 8, 3 * sizeof(*dst));
+}
+
+static inline __m128 vec4_norm(__m128 v)
+{
+    const float len2 = hsum(_mm_mul_ps(v, v));
+    if (len2 == 0.f)
+        return _mm_setzero_ps();
+    return _mm_mul_ps(v, _mm_set1_ps(1.0f / sqrtf(len2)));
+}
+
+#define COS_ALPHA_THRESHOLD 0.9995f
+
+void ngli_quat_slerp_sse(float *dst, const float *q1, const float *q2, float t)
+{
+    __m128 v1 = _mm_loadu_ps(q1);
+    const __m128 v2 = _mm_loadu_ps(q2);
+
+    float cos_alpha = hsum(_mm_mul_ps(v1, v2));
+
+    if (cos_alpha < 0.0f) {
+        cos_alpha = -cos_alpha;
+        v1 = _mm_sub_ps(_mm_setzero_ps(), v1);
+    }
+
+    if (cos_alpha > COS_ALPHA_THRESHOLD) {
+        const __m128 lerp = _mm_add_ps(v1, _mm_mul_ps(_mm_set1_ps(t), _mm_sub_ps(v2, v1)));
+        _mm_storeu_ps(dst, vec4_norm(lerp));
+        return;
+    }
+
+    if (cos_alpha > 1.0f)
+        cos_alpha = 1.0f;
+
+    const float alpha = acosf(cos_alpha);
+    const float theta = alpha * t;
+
+    const __m128 v = vec4_norm(_mm_sub_ps(v2, _mm_mul_ps(v1, _mm_set1_ps(cos_alpha))));
+    const __m128 r = _mm_add_ps(_mm_mul_ps(v1, _mm_set1_ps(cos(theta))),
+                                _mm_mul_ps(v,  _mm_set1_ps(sin(theta))));
+    _mm_storeu_ps(dst, r);
+}
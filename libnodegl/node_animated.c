@@ -23,6 +23,7 @@
 #include <stddef.h>
 #include <string.h>
 #include "animation.h"
+#include "animengine.h"
 #include "log.h"
 #include "math_utils.h"
 #include "nodegl.h"
@@ -223,7 +224,10 @@ static int animated##suffix##_init(struct ngl_node *node)
     s->data = class_data;                                                       \
     s->data_size = class_data_size;                                             \
     s->data_type = class_data_type;                                             \
-    return animation_init(node);                                                \
+    int ret = animation_init(node);                                             \
+    if (ret < 0)                                                                \
+        return ret;                                                             \
+    return ngli_animengine_register(&node->ctx->animengine, node);              \
 }
 
 DECLARE_INIT_FUNC(float, &s->scalar, sizeof(s->scalar),      NGLI_TYPE_FLOAT)
@@ -254,7 +258,10 @@ static int animatedtime_init(struct ngl_node *node)
         prev_time = kf->scalar;
     }
 
-    return animation_init(node);
+    int ret = animation_init(node);
+    if (ret < 0)
+        return ret;
+    return ngli_animengine_register(&node->ctx->animengine, node);
 }
 
 static int animatedquat_init(struct ngl_node *node)
@@ -268,7 +275,10 @@ static int animatedquat_init(struct ngl_node *node)
         s->data_size = sizeof(s->matrix);
         s->data_type = NGLI_TYPE_MAT4;
     }
-    return animation_init(node);
+    int ret = animation_init(node);
+    if (ret < 0)
+        return ret;
+    return ngli_animengine_register(&node->ctx->animengine, node);
 }
 
 static int animation_update(struct ngl_node *node, double t)
@@ -294,6 +304,24 @@ static int animatedquat_update(struct ngl_node *node, double t)
     return 0;
 }
 
+static void animation_uninit(struct ngl_node *node)
+{
+    ngli_animengine_unregister(&node->ctx->animengine, node);
+}
+
+#define animatedtime_uninit  animation_uninit
+#define animatedfloat_uninit animation_uninit
+#define animatedvec2_uninit  animation_uninit
+#define animatedvec3_uninit  animation_uninit
+#define animatedvec4_uninit  animation_uninit
+#define animatedquat_uninit  animation_uninit
+
+static void animation_invariance(const struct ngl_node *node, double t, double *range)
+{
+    const struct variable_priv *s = node->priv_data;
+    ngli_animation_get_invariance(&s->anim, t, range);
+}
+
 #define DEFINE_ANIMATED_CLASS(class_id, class_name, type)       \
 const struct node_class ngli_animated##type##_class = {         \
     .id        = class_id,                                      \
@@ -301,6 +329,8 @@ const struct node_class ngli_animated##type##_class = {         \
     .name      = class_name,                                    \
     .init      = animated##type##_init,                         \
     .update    = animated##type##_update,                       \
+    .invariant = animation_invariance,                          \
+    .uninit    = animated##type##_uninit,                       \
     .priv_size = sizeof(struct variable_priv),                  \
     .params    = animated##type##_params,                       \
     .file      = __FILE__,                                      \
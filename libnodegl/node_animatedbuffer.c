@@ -66,6 +66,12 @@ static int animatedbuffer_update(struct ngl_node *node, double t)
     return ngli_animation_evaluate(&s->anim, s->data, t);
 }
 
+static void animatedbuffer_invariance(const struct ngl_node *node, double t, double *range)
+{
+    const struct buffer_priv *s = node->priv_data;
+    ngli_animation_get_invariance(&s->anim, t, range);
+}
+
 static int animatedbuffer_init(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
@@ -108,13 +114,14 @@ static int animatedbuffer_init(struct ngl_node *node)
         return NGL_ERROR_MEMORY;
     s->data_size = s->count * s->data_stride;
 
-    return 0;
+    return ngli_animengine_register(&node->ctx->animengine, node);
 }
 
 static void animatedbuffer_uninit(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
 
+    ngli_animengine_unregister(&node->ctx->animengine, node);
     ngli_freep(&s->data);
 }
 
@@ -133,6 +140,7 @@ const struct node_class ngli_animatedbuffer##type##_class = {
     .name      = class_name,                                                       \
     .init      = animatedbuffer##type##_init,                                      \
     .update    = animatedbuffer_update,                                            \
+    .invariant = animatedbuffer_invariance,                                        \
     .uninit    = animatedbuffer_uninit,                                            \
     .priv_size = sizeof(struct buffer_priv),                                       \
     .params    = animatedbuffer_params,                                            \
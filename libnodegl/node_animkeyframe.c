@@ -20,16 +20,20 @@
  */
 
 #include <math.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "bstr.h"
+#include "easinglut.h"
+#include "hmap.h"
 #include "log.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "math_utils.h"
+#include "memory.h"
 #include "params.h"
 #include "utils.h"
 
@@ -84,6 +88,11 @@ static const struct node_param animkeyframe##id##_params[] = {
                              .desc=NGLI_DOCSTRING("starting offset of the truncation of the easing")},  \
     {"easing_end_offset",    PARAM_TYPE_DBL, OFFSET(offsets[1]), {.dbl=1},                              \
                              .desc=NGLI_DOCSTRING("ending offset of the truncation of the easing")},    \
+    {"easing_tolerance",     PARAM_TYPE_DBL, OFFSET(tolerance), {.dbl=0},                               \
+                             .desc=NGLI_DOCSTRING("if not 0, evaluate the easing through a "            \
+                                                  "precomputed approximation, refined until its "       \
+                                                  "error measured at sample points stays within "       \
+                                                  "this tolerance (not a strict bound between them)")}, \
     {NULL}                                                                                              \
 }
 
@@ -333,6 +342,75 @@ static const struct {
     [EASING_BACK_OUT_IN]      = {back_out_in,            NULL},
 };
 
+struct easing {
+    easing_function function;
+    int nb_args;
+    const double *args;
+    int scale_boundaries;
+    double offsets[2];
+    double boundaries[2];
+};
+
+/* Same evaluation as the one done between two key frames by the animations */
+static double evaluate_easing(void *user_arg, double x)
+{
+    const struct easing *easing = user_arg;
+    if (easing->scale_boundaries)
+        x = (easing->offsets[1] - easing->offsets[0]) * x + easing->offsets[0];
+    double v = easing->function(x, easing->nb_args, easing->args);
+    if (easing->scale_boundaries)
+        v = NGLI_LINEAR_INTERP(easing->boundaries[0], easing->boundaries[1], v);
+    return v;
+}
+
+static char *get_easinglut_key(const struct animkeyframe_priv *s)
+{
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+    ngli_bstr_printf(b, "%d:%a:%a:%a", s->easing, s->offsets[0], s->offsets[1], s->tolerance);
+    for (int i = 0; i < s->nb_args; i++)
+        ngli_bstr_printf(b, ":%a", s->args[i]);
+    char *key = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return key;
+}
+
+static int init_easinglut(struct ngl_node *node)
+{
+    struct animkeyframe_priv *s = node->priv_data;
+
+    /*
+     * Detached key frames (evaluated through ngl_anim_evaluate()) have no
+     * context to share the approximation with, and are never uninitialized:
+     * they use the exact easing.
+     */
+    if (!node->ctx)
+        return 0;
+
+    s->lut_key = get_easinglut_key(s);
+    if (!s->lut_key)
+        return NGL_ERROR_MEMORY;
+
+    struct easing easing = {
+        .function         = s->function,
+        .nb_args          = s->nb_args,
+        .args             = s->args,
+        .scale_boundaries = s->scale_boundaries,
+        .offsets          = {s->offsets[0], s->offsets[1]},
+        .boundaries       = {s->boundaries[0], s->boundaries[1]},
+    };
+    int ret = ngli_easinglut_cache_get(node->ctx->easingluts, s->lut_key, &s->lut,
+                                       evaluate_easing, &easing, s->tolerance);
+    if (ret < 0) {
+        ngli_freep(&s->lut_key);
+        return ret;
+    }
+    if (!s->lut)
+        LOG(WARNING, "%s: falling back on the exact easing", node->label);
+    return 0;
+}
+
 static int animkeyframe_init(struct ngl_node *node)
 {
     struct animkeyframe_priv *s = node->priv_data;
@@ -376,9 +454,25 @@ static int animkeyframe_init(struct ngl_node *node)
         s->boundaries[1] = s->function(s->offsets[1], s->nb_args, s->args);
     }
 
+    if (s->tolerance < 0.) {
+        LOG(ERROR, "the easing tolerance can not be negative");
+        return NGL_ERROR_INVALID_ARG;
+    }
+    if (s->tolerance > 0.)
+        return init_easinglut(node);
+
     return 0;
 }
 
+static void animkeyframe_uninit(struct ngl_node *node)
+{
+    struct animkeyframe_priv *s = node->priv_data;
+    if (!s->lut_key)
+        return;
+    ngli_easinglut_cache_release(node->ctx->easingluts, s->lut_key);
+    ngli_freep(&s->lut_key);
+}
+
 static char *animkeyframe_info_str(const struct ngl_node *node)
 {
     const struct animkeyframe_priv *s = node->priv_data;
@@ -438,6 +532,86 @@ int ngl_easing_evaluate(const char *name, double *args, int nb_args,
     return 0;
 }
 
+/*
+ * Approximations built for ngl_easing_evaluate_approx(), which has no context
+ * to hold them. They are kept until the process exits; once the cache is
+ * full, the easings without an approximation are evaluated exactly instead of
+ * building and dropping approximations over and over.
+ */
+#define MAX_APPROX_CACHE_ENTRIES 64
+
+static pthread_mutex_t approx_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct hmap *approx_cache;
+
+static void free_approx_cache(void)
+{
+    pthread_mutex_lock(&approx_cache_lock);
+    ngli_hmap_freep(&approx_cache);
+    pthread_mutex_unlock(&approx_cache_lock);
+}
+
+int ngl_easing_evaluate_approx(const char *name, double *args, int nb_args,
+                               double *offsets, double tolerance, double t, double *v)
+{
+    int easing_id;
+    int ret = ngli_params_get_select_val(easing_choices.consts, name, &easing_id);
+    if (ret < 0)
+        return ret;
+    if (tolerance <= 0. || nb_args < 0 || nb_args > 2)
+        return NGL_ERROR_INVALID_ARG;
+
+    struct animkeyframe_priv kf = {
+        .easing    = easing_id,
+        .args      = args,
+        .nb_args   = nb_args,
+        .offsets   = {offsets ? offsets[0] : 0., offsets ? offsets[1] : 1.},
+        .tolerance = tolerance,
+    };
+    char *key = get_easinglut_key(&kf);
+    if (!key)
+        return NGL_ERROR_MEMORY;
+
+    struct easing easing = {
+        .function = easings[easing_id].function,
+        .nb_args  = nb_args,
+        .args     = args,
+    };
+    if (offsets) {
+        easing.scale_boundaries = 1;
+        easing.offsets[0] = offsets[0];
+        easing.offsets[1] = offsets[1];
+        easing.boundaries[0] = easing.function(offsets[0], nb_args, args);
+        easing.boundaries[1] = easing.function(offsets[1], nb_args, args);
+    }
+
+    pthread_mutex_lock(&approx_cache_lock);
+    if (!approx_cache) {
+        approx_cache = ngli_easinglut_cache_create();
+        if (approx_cache && atexit(free_approx_cache))
+            ngli_hmap_freep(&approx_cache);
+    }
+    if (!approx_cache) {
+        ret = NGL_ERROR_MEMORY;
+    } else if (!ngli_hmap_get(approx_cache, key) &&
+               ngli_hmap_count(approx_cache) >= MAX_APPROX_CACHE_ENTRIES) {
+        *v = evaluate_easing(&easing, t);
+    } else {
+        /* The entries stay referenced until the cache is freed */
+        const struct easinglut *lut = NULL;
+        ret = ngli_easinglut_cache_get(approx_cache, key, &lut, evaluate_easing, &easing, tolerance);
+        if (ret >= 0) {
+            if (lut)
+                *v = ngli_easinglut_evaluate(lut, t);
+            else
+                ret = NGL_ERROR_LIMIT_EXCEEDED;
+        }
+    }
+    pthread_mutex_unlock(&approx_cache_lock);
+
+    ngli_free(key);
+    return ret;
+}
+
 int ngl_easing_solve(const char *name, double *args, int nb_args,
                      double *offsets, double v, double *t)
 {
@@ -467,6 +641,7 @@ const struct node_class ngli_animkeyframe##type##_class = { \
     .id        = class_id,                                  \
     .name      = class_name,                                \
     .init      = animkeyframe_init,                         \
+    .uninit    = animkeyframe_uninit,                       \
     .info_str  = animkeyframe_info_str,                     \
     .priv_size = sizeof(struct animkeyframe_priv),          \
     .params    = animkeyframe##type##_params,               \
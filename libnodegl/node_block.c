@@ -377,6 +377,7 @@ const struct node_class ngli_block_class = {
     .name      = "Block",
     .init      = block_init,
     .update    = block_update,
+    .invariant = ngli_node_invariance_from_children,
     .uninit    = block_uninit,
     .priv_size = sizeof(struct block_priv),
     .params    = block_params,
@@ -113,11 +113,11 @@ int ngli_node_buffer_upload(struct ngl_node *node)
     if (s->block)
         return ngli_node_block_upload(s->block);
 
-    if (s->dynamic && s->buffer_last_upload_time != node->last_update_time) {
+    if (s->dynamic && s->buffer_last_upload_time != node->last_eval_time) {
         int ret = ngli_buffer_upload(s->buffer, s->data, s->data_size);
         if (ret < 0)
             return ret;
-        s->buffer_last_upload_time = node->last_update_time;
+        s->buffer_last_upload_time = node->last_eval_time;
     }
 
     return 0;
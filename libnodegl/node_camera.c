@@ -222,6 +222,7 @@ const struct node_class ngli_camera_class = {
     .name      = "Camera",
     .init      = camera_init,
     .update    = camera_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = camera_draw,
     .priv_size = sizeof(struct camera_priv),
     .params    = camera_params,
@@ -157,6 +157,7 @@ const struct node_class ngli_compute_class = {
     .prepare   = compute_prepare,
     .uninit    = compute_uninit,
     .update    = compute_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = compute_draw,
     .priv_size = sizeof(struct compute_priv),
     .params    = compute_params,
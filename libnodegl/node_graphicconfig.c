@@ -316,6 +316,7 @@ const struct node_class ngli_graphicconfig_class = {
     .init      = graphicconfig_init,
     .prepare   = graphicconfig_prepare,
     .update    = graphicconfig_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = graphicconfig_draw,
     .priv_size = sizeof(struct graphicconfig_priv),
     .params    = graphicconfig_params,
@@ -95,6 +95,7 @@ const struct node_class ngli_group_class = {
     .name      = "Group",
     .prepare   = group_prepare,
     .update    = group_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = group_draw,
     .priv_size = sizeof(struct group_priv),
     .params    = group_params,
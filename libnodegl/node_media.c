@@ -32,6 +32,7 @@
 #endif
 
 #include "log.h"
+#include "math_utils.h"
 #include "nodegl.h"
 #include "nodes.h"
 
@@ -52,6 +53,16 @@ static const struct param_choices sxplayer_log_level_choices = {
     }
 };
 
+static const struct param_choices sw_pix_fmt_choices = {
+    .name = "sw_pix_fmt",
+    .consts = {
+        {"rgba",    SXPLAYER_PIXFMT_RGBA,    .desc=NGLI_DOCSTRING("packed RGBA, converted on the CPU")},
+        {"nv12",    SXPLAYER_PIXFMT_NV12,    .desc=NGLI_DOCSTRING("semi-planar YUV 4:2:0, converted on the GPU")},
+        {"yuv420p", SXPLAYER_PIXFMT_YUV420P, .desc=NGLI_DOCSTRING("planar YUV 4:2:0, converted on the GPU")},
+        {NULL}
+    }
+};
+
 #define OFFSET(x) offsetof(struct media_priv, x)
 static const struct node_param media_params[] = {
     {"filename", PARAM_TYPE_STR, OFFSET(filename), {.str=NULL}, PARAM_FLAG_NON_NULL,
@@ -74,9 +85,29 @@ static const struct node_param media_params[] = {
                        .desc=NGLI_DOCSTRING("maximum number of pixels per frame")},
     {"stream_idx",     PARAM_TYPE_INT, OFFSET(stream_idx),     {.i64=-1},
                        .desc=NGLI_DOCSTRING("force a stream number instead of picking the \"best\" one")},
+    {"sw_pix_fmt",     PARAM_TYPE_SELECT, OFFSET(sw_pix_fmt), {.i64=SXPLAYER_PIXFMT_RGBA},
+                       .choices=&sw_pix_fmt_choices,
+                       .desc=NGLI_DOCSTRING("pixel format of the software decoded frames")},
+    {"frame_cache_size", PARAM_TYPE_INT, OFFSET(frame_cache_size), {.i64=0},
+                         .desc=NGLI_DOCSTRING("maximum size in bytes of the decoded frames kept in memory to speed up "
+                                              "backward seeks and scrubbing (0 to disable)")},
     {NULL}
 };
 
+/*
+ * The frame cache keeps software decoded frames along with the range of media
+ * times for which they are known to be the displayed frame: [ts, end_time].
+ * This range is extended every time the player confirms the frame is still
+ * the current one, so a lookup never returns a frame the player would not
+ * have returned itself.
+ */
+struct media_frame_cache_entry {
+    struct sxplayer_frame *frame;
+    double end_time;
+    int64_t size;
+    int64_t last_use;
+};
+
 static const int log_levels[] = {
     [SXPLAYER_LOG_VERBOSE] = NGL_LOG_VERBOSE,
     [SXPLAYER_LOG_DEBUG]   = NGL_LOG_DEBUG,
@@ -102,6 +133,21 @@ static void callback_sxplayer_log(void *arg, int level, const char *filename, in
                        "[SXPLAYER %s:%d %s] %s", filename, ln, fn, buf);
 }
 
+static void mix_time(void *user_arg, void *dst,
+                     const struct animkeyframe_priv *kf0,
+                     const struct animkeyframe_priv *kf1,
+                     double ratio)
+{
+    double *dstd = dst;
+    dstd[0] = NGLI_MIX(kf0->scalar, kf1->scalar, ratio);
+}
+
+static void cpy_time(void *user_arg, void *dst,
+                     const struct animkeyframe_priv *kf)
+{
+    memcpy(dst, &kf->scalar, sizeof(kf->scalar));
+}
+
 static int media_init(struct ngl_node *node)
 {
     struct media_priv *s = node->priv_data;
@@ -112,6 +158,14 @@ static int media_init(struct ngl_node *node)
 
     sxplayer_set_log_callback(s->player, s, callback_sxplayer_log);
 
+    if (s->frame_cache_size < 0) {
+        LOG(ERROR, "frame cache size must be positive");
+        return NGL_ERROR_INVALID_ARG;
+    }
+    ngli_darray_init(&s->frame_cache, sizeof(struct media_frame_cache_entry), 0);
+    s->player_frame_ts = -1;
+    s->current_frame_ts = -1;
+
     struct ngl_node *anim_node = s->anim;
     if (anim_node) {
         struct variable_priv *anim = anim_node->priv_data;
@@ -127,6 +181,12 @@ static int media_init(struct ngl_node *node)
                 const struct animkeyframe_priv *kfn = anim->animkf[anim->nb_animkf - 1]->priv_data;
                 const double last_time = kfn->scalar;
                 sxplayer_set_option(s->player, "trim_duration", last_time - initial_seek);
+
+                int ret = ngli_animation_init(&s->time_eval, NULL,
+                                              anim->animkf, anim->nb_animkf,
+                                              mix_time, cpy_time);
+                if (ret < 0)
+                    return ret;
             }
         }
     }
@@ -138,7 +198,15 @@ static int media_init(struct ngl_node *node)
 
     sxplayer_set_option(s->player, "stream_idx", s->stream_idx);
 
-    sxplayer_set_option(s->player, "sw_pix_fmt", SXPLAYER_PIXFMT_RGBA);
+    int sw_pix_fmt = s->sw_pix_fmt;
+#if !defined(TARGET_IPHONE) && !defined(TARGET_LINUX)
+    if (sw_pix_fmt != SXPLAYER_PIXFMT_RGBA) {
+        LOG(WARNING, "planar software frames are not supported on this platform, "
+            "falling back on rgba");
+        sw_pix_fmt = SXPLAYER_PIXFMT_RGBA;
+    }
+#endif
+    sxplayer_set_option(s->player, "sw_pix_fmt", sw_pix_fmt);
 #if defined(TARGET_IPHONE) || defined(TARGET_DARWIN)
     sxplayer_set_option(s->player, "vt_pix_fmt", "nv12");
 #endif
@@ -217,7 +285,15 @@ static int media_init(struct ngl_node *node)
 
 static int media_prepare(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct media_priv *s = node->priv_data;
+
+    /* The node is kept from a previous scene, only count its new parents */
+    if (s->prepare_generation != ctx->prepare_generation) {
+        s->nb_parents = 0;
+        s->prepare_generation = ctx->prepare_generation;
+    }
+
     if (s->nb_parents++) {
         /*
          * On Android, the frame can only be uploaded once and each subsequent
@@ -230,10 +306,70 @@ static int media_prepare(struct ngl_node *node)
     return 0;
 }
 
+/*
+ * Remap the scene time t into the media time using the time remapping
+ * animation. The keyframes are evaluated by the media without updating the
+ * animation node, so the same remapping can be used ahead of time.
+ */
+static int get_media_time(struct media_priv *s, double t, double *media_time)
+{
+    struct ngl_node *anim_node = s->anim;
+    *media_time = t;
+    if (!anim_node)
+        return 0;
+
+    const struct variable_priv *anim = anim_node->priv_data;
+    if (!anim->nb_animkf)
+        return 0;
+
+    const struct animkeyframe_priv *kf0 = anim->animkf[0]->priv_data;
+    const double initial_seek = kf0->scalar;
+    if (anim->nb_animkf == 1) {
+        *media_time = NGLI_MAX(0, t - kf0->time);
+        return 0;
+    }
+
+    double v;
+    int ret = ngli_animation_evaluate(&s->time_eval, &v, t);
+    if (ret < 0)
+        return ret;
+    *media_time = NGLI_MAX(0, v - initial_seek);
+    return 0;
+}
+
+static int media_visit(struct ngl_node *node, int is_active, double t)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct media_priv *s = node->priv_data;
+
+    /*
+     * If the media is needed ahead of time, record the media time at which it
+     * is expected to be first used so the decoding started by the prefetch
+     * begins there instead of at the beginning of the stream.
+     */
+    if (is_active) {
+        s->warmup_time = 0;
+        if (ctx->activation_time > t) {
+            int ret = get_media_time(s, ctx->activation_time, &s->warmup_time);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
+    if (s->anim)
+        return ngli_node_visit(s->anim, is_active, t);
+    return 0;
+}
+
 static int media_prefetch(struct ngl_node *node)
 {
     struct media_priv *s = node->priv_data;
     sxplayer_start(s->player);
+    if (s->warmup_time > 0) {
+        TRACE("warm up %s at media time %g", node->label, s->warmup_time);
+        sxplayer_seek(s->player, s->warmup_time);
+    }
+    s->warmup_time = 0;
     return 0;
 }
 
@@ -243,38 +379,166 @@ static const char * const pix_fmt_names[] = {
     [SXPLAYER_PIXFMT_VT]         = "vt",
     [SXPLAYER_PIXFMT_MEDIACODEC] = "mediacodec",
     [SXPLAYER_PIXFMT_VAAPI]      = "vaapi",
+    [SXPLAYER_PIXFMT_NV12]       = "nv12",
+    [SXPLAYER_PIXFMT_YUV420P]    = "yuv420p",
 };
 
-static int media_update(struct ngl_node *node, double t)
+static int64_t get_frame_size(const struct sxplayer_frame *frame)
 {
-    struct media_priv *s = node->priv_data;
-    struct ngl_node *anim_node = s->anim;
-    double media_time = t;
-
-    if (anim_node) {
-        struct variable_priv *anim = anim_node->priv_data;
+    const int64_t chroma_height = (frame->height + 1) >> 1;
+    switch (frame->pix_fmt) {
+    case SXPLAYER_PIXFMT_RGBA:
+    case SXPLAYER_PIXFMT_BGRA:
+        return (int64_t)frame->linesize * frame->height;
+    case SXPLAYER_PIXFMT_NV12:
+        return (int64_t)frame->linesizep[0] * frame->height
+             + (int64_t)frame->linesizep[1] * chroma_height;
+    case SXPLAYER_PIXFMT_YUV420P:
+        return (int64_t)frame->linesizep[0] * frame->height
+             + (int64_t)frame->linesizep[1] * chroma_height
+             + (int64_t)frame->linesizep[2] * chroma_height;
+    default:
+        /* hardware and audio frames are not cached */
+        return -1;
+    }
+}
 
-        if (anim->nb_animkf >= 1) {
-            const struct animkeyframe_priv *kf0 = anim->animkf[0]->priv_data;
-            const double initial_seek = kf0->scalar;
+static struct media_frame_cache_entry *frame_cache_find_ts(struct media_priv *s, double ts)
+{
+    struct media_frame_cache_entry *entries = ngli_darray_data(&s->frame_cache);
+    for (int i = 0; i < ngli_darray_count(&s->frame_cache); i++)
+        if (entries[i].frame->ts == ts)
+            return &entries[i];
+    return NULL;
+}
 
-            if (anim->nb_animkf == 1) {
-                media_time = NGLI_MAX(0, t - kf0->time);
-            } else {
-                int ret = ngli_node_update(anim_node, t);
-                if (ret < 0)
-                    return ret;
-                media_time = NGLI_MAX(0, anim->dval - initial_seek);
-            }
+static struct media_frame_cache_entry *frame_cache_lookup(struct media_priv *s, double media_time)
+{
+    struct media_frame_cache_entry *entries = ngli_darray_data(&s->frame_cache);
+    for (int i = 0; i < ngli_darray_count(&s->frame_cache); i++) {
+        struct media_frame_cache_entry *entry = &entries[i];
+        if (entry->frame->ts <= media_time && media_time <= entry->end_time)
+            return entry;
+    }
+    return NULL;
+}
 
-            TRACE("remapped time f(%g)=%g", t, media_time);
+static void frame_cache_evict(struct media_priv *s)
+{
+    while (s->frame_cache_used > s->frame_cache_size) {
+        struct media_frame_cache_entry *entries = ngli_darray_data(&s->frame_cache);
+        int lru = -1;
+        for (int i = 0; i < ngli_darray_count(&s->frame_cache); i++) {
+            /* the frame last returned by the player must stay available as
+             * the player will not return it again */
+            if (entries[i].frame->ts == s->player_frame_ts)
+                continue;
+            if (lru < 0 || entries[i].last_use < entries[lru].last_use)
+                lru = i;
         }
+        if (lru < 0)
+            break;
+        s->frame_cache_used -= entries[lru].size;
+        sxplayer_release_frame(entries[lru].frame);
+        ngli_darray_remove(&s->frame_cache, lru);
     }
+}
+
+static int frame_cache_add(struct media_priv *s, struct sxplayer_frame *frame, double media_time)
+{
+    const int64_t size = get_frame_size(frame);
+    if (size < 0 || size > s->frame_cache_size)
+        return 0;
+
+    struct media_frame_cache_entry *entry = frame_cache_find_ts(s, frame->ts);
+    if (entry) {
+        /* the player returned a frame we already hold (typically after a
+         * seek), keep the previous copy */
+        sxplayer_release_frame(frame);
+        entry->end_time = NGLI_MAX(entry->end_time, media_time);
+        entry->last_use = s->frame_cache_clock++;
+        s->frame = entry->frame;
+        s->frame_cached = 1;
+        return 0;
+    }
+
+    const struct media_frame_cache_entry new_entry = {
+        .frame    = frame,
+        .end_time = media_time,
+        .size     = size,
+        .last_use = s->frame_cache_clock++,
+    };
+    if (!ngli_darray_push(&s->frame_cache, &new_entry))
+        return NGL_ERROR_MEMORY;
+    s->frame_cache_used += size;
+    s->frame_cached = 1;
+
+    frame_cache_evict(s);
+    return 0;
+}
+
+static void frame_cache_reset(struct media_priv *s)
+{
+    struct media_frame_cache_entry *entries = ngli_darray_data(&s->frame_cache);
+    for (int i = 0; i < ngli_darray_count(&s->frame_cache); i++)
+        sxplayer_release_frame(entries[i].frame);
+    ngli_darray_clear(&s->frame_cache);
+    s->frame_cache_used = 0;
+}
+
+static void set_cached_frame(struct media_priv *s, struct media_frame_cache_entry *entry, double media_time)
+{
+    entry->end_time = NGLI_MAX(entry->end_time, media_time);
+    entry->last_use = s->frame_cache_clock++;
+    if (entry->frame->ts == s->current_frame_ts)
+        return;
+    s->frame = entry->frame;
+    s->frame_cached = 1;
+    s->current_frame_ts = entry->frame->ts;
+}
 
-    sxplayer_release_frame(s->frame);
+static void release_frame(struct media_priv *s)
+{
+    if (!s->frame_cached)
+        sxplayer_release_frame(s->frame);
+    s->frame = NULL;
+    s->frame_cached = 0;
+}
+
+static int media_update(struct ngl_node *node, double t)
+{
+    struct media_priv *s = node->priv_data;
+
+    double media_time;
+    int ret = get_media_time(s, t, &media_time);
+    if (ret < 0)
+        return ret;
+    if (s->anim)
+        TRACE("remapped time f(%g)=%g", t, media_time);
+
+    release_frame(s);
+
+    if (s->frame_cache_size) {
+        struct media_frame_cache_entry *entry = frame_cache_lookup(s, media_time);
+        if (entry) {
+            TRACE("frame cache hit for %s at t=%g: ts=%f", node->label, media_time, entry->frame->ts);
+            set_cached_frame(s, entry, media_time);
+            return 0;
+        }
+    }
 
     TRACE("get frame from %s at t=%g", node->label, media_time);
     struct sxplayer_frame *frame = sxplayer_get_frame(s->player, media_time);
+    if (!frame && s->frame_cache_size) {
+        /*
+         * The player still considers its last returned frame as the current
+         * one, which may differ from the frame exposed from the cache.
+         */
+        struct media_frame_cache_entry *entry = frame_cache_find_ts(s, s->player_frame_ts);
+        if (entry)
+            set_cached_frame(s, entry, media_time);
+        return 0;
+    }
     if (frame) {
         const char *pix_fmt_str = frame->pix_fmt >= 0 &&
                                   frame->pix_fmt < NGLI_ARRAY_NB(pix_fmt_names) ? pix_fmt_names[frame->pix_fmt]
@@ -292,22 +556,32 @@ static int media_update(struct ngl_node *node, double t)
         }
         TRACE("got frame %dx%d %s with ts=%f", frame->width, frame->height,
               pix_fmt_str, frame->ts);
+
+        s->player_frame_ts = frame->ts;
+        s->current_frame_ts = frame->ts;
     }
     s->frame = frame;
+
+    if (frame && s->frame_cache_size && !s->audio_tex)
+        return frame_cache_add(s, frame, media_time);
+
     return 0;
 }
 
 static void media_release(struct ngl_node *node)
 {
     struct media_priv *s = node->priv_data;
-    sxplayer_release_frame(s->frame);
-    s->frame = NULL;
+    release_frame(s);
+    frame_cache_reset(s);
+    s->player_frame_ts = -1;
+    s->current_frame_ts = -1;
     sxplayer_stop(s->player);
 }
 
 static void media_uninit(struct ngl_node *node)
 {
     struct media_priv *s = node->priv_data;
+    ngli_darray_reset(&s->frame_cache);
     sxplayer_free(&s->player);
 
 #if defined(TARGET_ANDROID)
@@ -328,6 +602,7 @@ const struct node_class ngli_media_class = {
     .name      = "Media",
     .init      = media_init,
     .prepare   = media_prepare,
+    .visit     = media_visit,
     .prefetch  = media_prefetch,
     .update    = media_update,
     .release   = media_release,
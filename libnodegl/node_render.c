@@ -205,6 +205,7 @@ const struct node_class ngli_render_class = {
     .prepare   = render_prepare,
     .uninit    = render_uninit,
     .update    = render_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = render_draw,
     .priv_size = sizeof(struct render_priv),
     .params    = render_params,
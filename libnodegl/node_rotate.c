@@ -68,6 +68,7 @@ static int rotate_init(struct ngl_node *node)
     }
     s->use_anchor = memcmp(s->anchor, zvec, sizeof(zvec));
     ngli_vec3_norm(s->normed_axis, s->axis);
+    s->trf.animated = !!s->anim;
     if (!s->anim)
         update_trf_matrix(node, s->angle);
     return 0;
@@ -126,6 +127,7 @@ const struct node_class ngli_rotate_class = {
     .name      = "Rotate",
     .init      = rotate_init,
     .update    = rotate_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct rotate_priv),
     .params    = rotate_params,
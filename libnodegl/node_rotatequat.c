@@ -60,6 +60,7 @@ static int rotatequat_init(struct ngl_node *node)
     struct rotatequat_priv *s = node->priv_data;
     static const float zvec[3];
     s->use_anchor = memcmp(s->anchor, zvec, sizeof(zvec));
+    s->trf.animated = !!s->anim;
     if (!s->anim)
         update_trf_matrix(node, s->quat);
     return 0;
@@ -116,6 +117,7 @@ const struct node_class ngli_rotatequat_class = {
     .name      = "RotateQuat",
     .init      = rotatequat_init,
     .update    = rotatequat_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct rotatequat_priv),
     .params    = rotatequat_params,
@@ -40,6 +40,7 @@ struct rtt_priv {
     int samples;
     float clear_color[4];
     int features;
+    int cache;
 
     int use_rt_resume;
     int width;
@@ -53,6 +54,9 @@ struct rtt_priv {
     struct texture *ms_colors[NGLI_MAX_COLOR_ATTACHMENTS];
     int nb_ms_colors;
     struct texture *ms_depth;
+
+    int cached;
+    uint64_t cached_generation;
 };
 
 #define FEATURE_DEPTH       (1 << 0)
@@ -86,6 +90,9 @@ static const struct node_param rtt_params[] = {
     {"features",      PARAM_TYPE_FLAGS, OFFSET(features),
                       .choices=&feature_choices,
                       .desc=NGLI_DOCSTRING("framebuffer feature mask")},
+    {"cache",         PARAM_TYPE_BOOL, OFFSET(cache),
+                      .desc=NGLI_DOCSTRING("skip the rendering (and mipmap generation) while `child` is not re-evaluated; "
+                                           "`child` must not rely on resources modified by compute nodes")},
     {NULL}
 };
 
@@ -115,6 +122,7 @@ static int rtt_init(struct ngl_node *node)
 struct renderpass_children_info {
     int has_rtt_or_compute;
     int render_counts[2]; // number of render nodes before and after the first rtt or compute node (renderpass interruption)
+    int has_lazy_children; // some children are not initialized yet (lazy init) so their content is unknown
 };
 
 static void get_renderpass_children_info(const struct ngl_node *node, struct renderpass_children_info *info)
@@ -127,6 +135,8 @@ static void get_renderpass_children_info(const struct ngl_node *node, struct ren
             info->has_rtt_or_compute = 1;
         } else if (child->class->id == NGL_NODE_RENDER) {
             info->render_counts[info->has_rtt_or_compute ? 1 : 0] += 1;
+        } else if (!child->ctx) {
+            info->has_lazy_children = 1;
         } else {
             get_renderpass_children_info(child, info);
         }
@@ -142,7 +152,7 @@ static int rtt_prepare(struct ngl_node *node)
 
     struct renderpass_children_info info = {0};
     get_renderpass_children_info(s->child, &info);
-    if (info.render_counts[0] && info.render_counts[1]) {
+    if ((info.render_counts[0] && info.render_counts[1]) || info.has_lazy_children) {
 #if DEBUG_SCENE
         LOG(WARNING, "the underlying render pass might not be optimal as it contains a rtt or compute node in the middle of it");
 #endif
@@ -156,6 +166,8 @@ static int rtt_prepare(struct ngl_node *node)
         struct texture_priv *texture_priv = s->color_textures[i]->priv_data;
         struct texture_params *params = &texture_priv->params;
         params->usage |= NGLI_TEXTURE_USAGE_COLOR_ATTACHMENT_BIT;
+        texture_priv->rtt_child = s->child;
+        texture_priv->rtt_prepare_generation = ctx->prepare_generation;
         const int faces = params->type == NGLI_TEXTURE_TYPE_CUBE ? 6 : 1;
         for (int j = 0; j < faces; j++) {
             desc.colors[desc.nb_colors].format = params->format;
@@ -167,6 +179,8 @@ static int rtt_prepare(struct ngl_node *node)
         struct texture_priv *depth_texture_priv = s->depth_texture->priv_data;
         struct texture_params *depth_texture_params = &depth_texture_priv->params;
         depth_texture_params->usage |= NGLI_TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        depth_texture_priv->rtt_child = s->child;
+        depth_texture_priv->rtt_prepare_generation = ctx->prepare_generation;
         desc.depth_stencil.format = depth_texture_params->format;
         desc.depth_stencil.resolve = s->samples > 1;
     } else {
@@ -242,10 +256,6 @@ static int rtt_prefetch(struct ngl_node *node)
         const int n = params->type == NGLI_TEXTURE_TYPE_CUBE ? 6 : 1;
         for (int j = 0; j < n; j++) {
             if (s->samples) {
-                struct texture *ms_texture = ngli_texture_create(gctx);
-                if (!ms_texture)
-                    return NGL_ERROR_MEMORY;
-                s->ms_colors[s->nb_ms_colors++] = ms_texture;
                 struct texture_params attachment_params = {
                     .type    = NGLI_TEXTURE_TYPE_2D,
                     .format  = params->format,
@@ -254,9 +264,11 @@ static int rtt_prefetch(struct ngl_node *node)
                     .samples = s->samples,
                     .usage   = NGLI_TEXTURE_USAGE_COLOR_ATTACHMENT_BIT,
                 };
-                ret = ngli_texture_init(ms_texture, &attachment_params);
+                struct texture *ms_texture = NULL;
+                ret = ngli_texturepool_get_texture(&ctx->texturepool, &ms_texture, &attachment_params);
                 if (ret < 0)
                     return ret;
+                s->ms_colors[s->nb_ms_colors++] = ms_texture;
                 rt_params.colors[rt_params.nb_colors].attachment = ms_texture;
                 rt_params.colors[rt_params.nb_colors].attachment_layer = 0;
                 rt_params.colors[rt_params.nb_colors].resolve_target = texture;
@@ -284,10 +296,6 @@ static int rtt_prefetch(struct ngl_node *node)
         struct texture_params *params = &texture->params;
 
         if (s->samples) {
-            struct texture *ms_texture = ngli_texture_create(gctx);
-            if (!ms_texture)
-                return NGL_ERROR_MEMORY;
-            s->ms_depth = ms_texture;
             struct texture_params attachment_params = {
                 .type    = NGLI_TEXTURE_TYPE_2D,
                 .format  = params->format,
@@ -296,10 +304,10 @@ static int rtt_prefetch(struct ngl_node *node)
                 .samples = s->samples,
                 .usage   = NGLI_TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
             };
-            ret = ngli_texture_init(ms_texture, &attachment_params);
+            ret = ngli_texturepool_get_texture(&ctx->texturepool, &s->ms_depth, &attachment_params);
             if (ret < 0)
                 return ret;
-            rt_params.depth_stencil.attachment = ms_texture;
+            rt_params.depth_stencil.attachment = s->ms_depth;
             rt_params.depth_stencil.resolve_target = texture;
             rt_params.depth_stencil.load_op = NGLI_LOAD_OP_CLEAR;
             rt_params.depth_stencil.store_op = NGLI_STORE_OP_DONT_CARE;
@@ -315,10 +323,6 @@ static int rtt_prefetch(struct ngl_node *node)
             depth_format = ngli_gctx_get_preferred_depth_format(gctx);
 
         if (depth_format != NGLI_FORMAT_UNDEFINED) {
-            struct texture *depth = ngli_texture_create(gctx);
-            if (!depth)
-                return NGL_ERROR_MEMORY;
-            s->depth = depth;
             struct texture_params attachment_params = {
                 .type    = NGLI_TEXTURE_TYPE_2D,
                 .format  = depth_format,
@@ -327,10 +331,10 @@ static int rtt_prefetch(struct ngl_node *node)
                 .samples = s->samples,
                 .usage   = NGLI_TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
             };
-            ret = ngli_texture_init(depth, &attachment_params);
+            ret = ngli_texturepool_get_texture(&ctx->texturepool, &s->depth, &attachment_params);
             if (ret < 0)
                 return ret;
-            rt_params.depth_stencil.attachment = depth;
+            rt_params.depth_stencil.attachment = s->depth;
             rt_params.depth_stencil.load_op = NGLI_LOAD_OP_CLEAR;
             rt_params.depth_stencil.store_op = s->use_rt_resume ? NGLI_STORE_OP_STORE : NGLI_LOAD_OP_DONT_CARE;
         }
@@ -387,6 +391,15 @@ static int rtt_update(struct ngl_node *node, double t)
     if (ret < 0)
         return ret;
 
+    /*
+     * The output of a child skipped for being invariant has not changed. A
+     * child without update callback is never evaluated and can only be
+     * changed by a live change, which bumps the update generation.
+     */
+    if (s->child->class->update ? s->child->last_eval_time == t
+                                : s->cached_generation != node->ctx->update_generation)
+        s->cached = 0;
+
     for (int i = 0; i < s->nb_color_textures; i++) {
         ret = ngli_node_update(s->color_textures[i], t);
         if (ret < 0)
@@ -408,6 +421,9 @@ static void rtt_draw(struct ngl_node *node)
     struct gctx *gctx = ctx->gctx;
     struct rtt_priv *s = node->priv_data;
 
+    if (s->cache && s->cached)
+        return;
+
     int prev_vp[4] = {0};
     ngli_gctx_get_viewport(gctx, prev_vp);
 
@@ -451,20 +467,25 @@ static void rtt_draw(struct ngl_node *node)
         if (ngli_texture_has_mipmap(texture))
             ngli_texture_generate_mipmap(texture);
     }
+
+    s->cached = 1;
+    s->cached_generation = ctx->update_generation;
 }
 
 static void rtt_release(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct rtt_priv *s = node->priv_data;
 
     ngli_rendertarget_freep(&s->rt);
     ngli_rendertarget_freep(&s->rt_resume);
-    ngli_texture_freep(&s->depth);
+    ngli_texturepool_release_texture(&ctx->texturepool, &s->depth);
 
     for (int i = 0; i < s->nb_ms_colors; i++)
-        ngli_texture_freep(&s->ms_colors[i]);
+        ngli_texturepool_release_texture(&ctx->texturepool, &s->ms_colors[i]);
     s->nb_ms_colors = 0;
-    ngli_texture_freep(&s->ms_depth);
+    ngli_texturepool_release_texture(&ctx->texturepool, &s->ms_depth);
+    s->cached = 0;
 }
 
 const struct node_class ngli_rtt_class = {
@@ -474,6 +495,7 @@ const struct node_class ngli_rtt_class = {
     .prepare   = rtt_prepare,
     .prefetch  = rtt_prefetch,
     .update    = rtt_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = rtt_draw,
     .release   = rtt_release,
     .priv_size = sizeof(struct rtt_priv),
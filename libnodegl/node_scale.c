@@ -59,6 +59,7 @@ static int scale_init(struct ngl_node *node)
     struct scale_priv *s = node->priv_data;
     static const float zero_anchor[3];
     s->use_anchor = memcmp(s->anchor, zero_anchor, sizeof(s->anchor));
+    s->trf.animated = !!s->anim;
     if (!s->anim)
         update_trf_matrix(node, s->factors);
     return 0;
@@ -116,6 +117,7 @@ const struct node_class ngli_scale_class = {
     .name      = "Scale",
     .init      = scale_init,
     .update    = scale_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct scale_priv),
     .params    = scale_params,
@@ -71,6 +71,7 @@ static int skew_init(struct ngl_node *node)
     }
     s->use_anchor = memcmp(s->anchor, zvec, sizeof(zvec));
     ngli_vec3_norm(s->normed_axis, s->axis);
+    s->trf.animated = !!s->anim;
     if (!s->anim)
         update_trf_matrix(node, s->angles);
     return 0;
@@ -129,6 +130,7 @@ const struct node_class ngli_skew_class = {
     .name      = "Skew",
     .init      = skew_init,
     .update    = skew_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct skew_priv),
     .params    = skew_params,
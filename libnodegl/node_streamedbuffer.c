@@ -28,6 +28,7 @@
 #include "nodegl.h"
 #include "nodes.h"
 #include "type.h"
+#include "utils.h"
 
 #define OFFSET(x) offsetof(struct buffer_priv, x)
 
@@ -63,21 +64,20 @@ DECLARE_STREAMED_PARAMS(vec3,   NGL_NODE_BUFFERVEC3)
 DECLARE_STREAMED_PARAMS(vec4,   NGL_NODE_BUFFERVEC4)
 DECLARE_STREAMED_PARAMS(mat4,   NGL_NODE_BUFFERMAT4)
 
+static inline int64_t get_timestamp(const int64_t *timestamps, int i)
+{
+    return timestamps[i];
+}
+
+NGLI_DEFINE_MONOTONIC_SEARCH_FUNC(search_timestamp, const int64_t *, int64_t, get_timestamp)
+
 static int get_data_index(const struct ngl_node *node, int start, int64_t t64)
 {
     const struct buffer_priv *s = node->priv_data;
     const struct buffer_priv *timestamps_priv = s->timestamps->priv_data;
     const int64_t *timestamps = (int64_t *)timestamps_priv->data;
     const int nb_timestamps = timestamps_priv->count;
-
-    int ret = -1;
-    for (int i = start; i < nb_timestamps; i++) {
-        const int64_t ts = timestamps[i];
-        if (ts > t64)
-            break;
-        ret = i;
-    }
-    return ret;
+    return search_timestamp(timestamps, nb_timestamps, start, t64);
 }
 
 static int streamedbuffer_update(struct ngl_node *node, double t)
@@ -110,11 +110,8 @@ static int streamedbuffer_update(struct ngl_node *node, double t)
 
     const int64_t t64 = llrint(rt * s->timebase[1] / (double)s->timebase[0]);
     int index = get_data_index(node, s->last_index, t64);
-    if (index < 0) {
-        index = get_data_index(node, 0, t64);
-        if (index < 0) // the requested time `t` is before the first user timestamp
-            index = 0;
-    }
+    if (index < 0) // the requested time `t` is before the first user timestamp
+        index = 0;
     s->last_index = index;
 
     const struct buffer_priv *buffer_priv = s->buffer_node->priv_data;
@@ -123,6 +120,31 @@ static int streamedbuffer_update(struct ngl_node *node, double t)
     return 0;
 }
 
+/*
+ * Without time remapping, the streamed data only changes when the time enters
+ * another timestamp interval. The interval bounds are shrunk by one unit of
+ * the timebase to stay clear of the rounding done in the update.
+ */
+static void streamedbuffer_invariance(const struct ngl_node *node, double t, double *range)
+{
+    const struct buffer_priv *s = node->priv_data;
+    if (s->time_anim) {
+        range[0] = range[1] = t;
+        return;
+    }
+
+    const struct buffer_priv *timestamps_priv = s->timestamps->priv_data;
+    const int64_t *timestamps = (int64_t *)timestamps_priv->data;
+    const int nb_timestamps = timestamps_priv->count;
+    const int64_t t64 = llrint(t * s->timebase[1] / (double)s->timebase[0]);
+    const int index = get_data_index(node, s->last_index, t64);
+    const double tb = s->timebase[0] / (double)s->timebase[1];
+    if (index >= 0)
+        range[0] = NGLI_MAX(range[0], (timestamps[index] + 1) * tb);
+    if (index < nb_timestamps - 1)
+        range[1] = NGLI_MIN(range[1], (timestamps[index + 1] - 1) * tb);
+}
+
 static int check_timestamps_buffer(const struct ngl_node *node)
 {
     const struct buffer_priv *s = node->priv_data;
@@ -189,7 +211,16 @@ static int streamedbuffer_init(struct ngl_node *node)
         return NGL_ERROR_INVALID_ARG;
     }
 
-    return check_timestamps_buffer(node);
+    int ret = check_timestamps_buffer(node);
+    if (ret < 0)
+        return ret;
+
+    return ngli_animengine_register(&node->ctx->animengine, node);
+}
+
+static void streamedbuffer_uninit(struct ngl_node *node)
+{
+    ngli_animengine_unregister(&node->ctx->animengine, node);
 }
 
 
@@ -200,6 +231,8 @@ const struct node_class ngli_streamedbuffer##class_suffix##_class = {       \
     .name      = class_name,                                                \
     .init      = streamedbuffer_init,                                       \
     .update    = streamedbuffer_update,                                     \
+    .invariant = streamedbuffer_invariance,                                 \
+    .uninit    = streamedbuffer_uninit,                                     \
     .priv_size = sizeof(struct variable_priv),                              \
     .params    = streamedbuffer##class_suffix##_params,                     \
     .file      = __FILE__,                                                  \
@@ -80,6 +80,7 @@ struct text_priv {
     int nb_bg_indices;
 
     struct darray pipeline_descs;
+    uint64_t prepare_generation;
     int live_changed;
 };
 
@@ -637,11 +638,31 @@ static int fg_prepare(struct ngl_node *node, struct pipeline_subdesc *desc)
     return 0;
 }
 
+static void free_pipeline_descs(struct darray *descs_array)
+{
+    struct pipeline_desc *descs = ngli_darray_data(descs_array);
+    const int nb_descs = ngli_darray_count(descs_array);
+    for (int i = 0; i < nb_descs; i++) {
+        struct pipeline_desc *desc = &descs[i];
+        ngli_pipeline_freep(&desc->bg.pipeline);
+        ngli_pipeline_freep(&desc->fg.pipeline);
+        ngli_pgcraft_freep(&desc->bg.crafter);
+        ngli_pgcraft_freep(&desc->fg.crafter);
+    }
+    ngli_darray_clear(descs_array);
+}
+
 static int text_prepare(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct text_priv *s = node->priv_data;
 
+    /* The node is kept from a previous scene, its positions are all new */
+    if (s->prepare_generation != ctx->prepare_generation) {
+        free_pipeline_descs(&s->pipeline_descs);
+        s->prepare_generation = ctx->prepare_generation;
+    }
+
     struct pipeline_desc *desc = ngli_darray_push(&s->pipeline_descs, NULL);
     if (!desc)
         return NGL_ERROR_MEMORY;
@@ -708,15 +729,7 @@ static void text_draw(struct ngl_node *node)
 static void text_uninit(struct ngl_node *node)
 {
     struct text_priv *s = node->priv_data;
-    struct pipeline_desc *descs = ngli_darray_data(&s->pipeline_descs);
-    const int nb_descs = ngli_darray_count(&s->pipeline_descs);
-    for (int i = 0; i < nb_descs; i++) {
-        struct pipeline_desc *desc = &descs[i];
-        ngli_pipeline_freep(&desc->bg.pipeline);
-        ngli_pipeline_freep(&desc->fg.pipeline);
-        ngli_pgcraft_freep(&desc->bg.crafter);
-        ngli_pgcraft_freep(&desc->fg.crafter);
-    }
+    free_pipeline_descs(&s->pipeline_descs);
     ngli_darray_reset(&s->pipeline_descs);
     ngli_buffer_freep(&s->bg_vertices);
     ngli_buffer_freep(&s->bg_indices);
@@ -731,6 +744,7 @@ const struct node_class ngli_text_class = {
     .init      = text_init,
     .prepare   = text_prepare,
     .update    = text_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = text_draw,
     .uninit    = text_uninit,
     .priv_size = sizeof(struct text_priv),
@@ -240,6 +240,18 @@ static const struct node_param texturecube_params[] = {
     {NULL}
 };
 
+/*
+ * The RenderToTexture rendering into the texture sets its child and the
+ * attachment usage again every time the scene is prepared: if they were set
+ * in a previous generation, the RenderToTexture is not part of the scene
+ * anymore and its child might have been released.
+ */
+static int is_rendered_by_rtt(const struct ngl_node *node)
+{
+    const struct texture_priv *s = node->priv_data;
+    return s->rtt_child && s->rtt_prepare_generation == node->ctx->prepare_generation;
+}
+
 static int texture_prefetch(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -247,6 +259,11 @@ static int texture_prefetch(struct ngl_node *node)
     struct texture_priv *s = node->priv_data;
     struct texture_params *params = &s->params;
 
+    if (!is_rendered_by_rtt(node)) {
+        s->rtt_child = NULL;
+        params->usage &= ~(NGLI_TEXTURE_USAGE_COLOR_ATTACHMENT_BIT | NGLI_TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    }
+
     if (params->type == NGLI_TEXTURE_TYPE_CUBE)
         params->height = params->width;
 
@@ -320,11 +337,7 @@ static int texture_prefetch(struct ngl_node *node)
         }
     }
 
-    s->texture = ngli_texture_create(gctx);
-    if (!s->texture)
-        return NGL_ERROR_MEMORY;
-
-    int ret = ngli_texture_init(s->texture, params);
+    int ret = ngli_texturepool_get_texture(&ctx->texturepool, &s->texture, params);
     if (ret < 0)
         return ret;
 
@@ -389,10 +402,11 @@ static int texture_update(struct ngl_node *node, double t)
 
 static void texture_release(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct texture_priv *s = node->priv_data;
 
     ngli_hwupload_uninit(node);
-    ngli_texture_freep(&s->texture);
+    ngli_texturepool_release_texture(&ctx->texturepool, &s->texture);
     ngli_image_reset(&s->image);
 }
 
@@ -408,6 +422,30 @@ static int get_preferred_format(struct gctx *gctx, int format)
     }
 }
 
+/*
+ * The content of a texture rendered by an active RenderToTexture remains the
+ * same as long as its rendered scene does, which can only be assessed once
+ * that scene has been updated.
+ */
+static void texture_invariant(const struct ngl_node *node, double t, double *range)
+{
+    if (!is_rendered_by_rtt(node))
+        return;
+
+    const struct texture_priv *s = node->priv_data;
+    const struct ngl_node *rtt_child = s->rtt_child;
+
+    if (!rtt_child->is_active)
+        return;
+
+    if (rtt_child->class->update && rtt_child->last_update_time != t) {
+        range[0] = range[1] = t;
+        return;
+    }
+
+    ngli_node_restrict_invariance(rtt_child, t, range);
+}
+
 static int texture2d_init(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -460,6 +498,7 @@ const struct node_class ngli_texture2d_class = {
     .init      = texture2d_init,
     .prefetch  = texture_prefetch,
     .update    = texture_update,
+    .invariant = texture_invariant,
     .release   = texture_release,
     .priv_size = sizeof(struct texture_priv),
     .params    = texture2d_params,
@@ -473,6 +512,7 @@ const struct node_class ngli_texture3d_class = {
     .init      = texture3d_init,
     .prefetch  = texture_prefetch,
     .update    = texture_update,
+    .invariant = texture_invariant,
     .release   = texture_release,
     .priv_size = sizeof(struct texture_priv),
     .params    = texture3d_params,
@@ -486,6 +526,7 @@ const struct node_class ngli_texturecube_class = {
     .init      = texturecube_init,
     .prefetch  = texture_prefetch,
     .update    = texture_update,
+    .invariant = texture_invariant,
     .release   = texture_release,
     .priv_size = sizeof(struct texture_priv),
     .params    = texturecube_params,
@@ -23,10 +23,13 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "darray.h"
 #include "log.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "params.h"
+#include "rnode.h"
+#include "utils.h"
 
 struct timerangefilter_priv {
     struct ngl_node *child;
@@ -37,6 +40,11 @@ struct timerangefilter_priv {
     double max_idle_time;
 
     int drawme;
+
+    int lazy;
+    int child_attached;
+    struct darray rnode_paths; // int: depth followed by the rnode indexes, for every prepare
+    uint64_t prepare_generation;
 };
 
 #define RANGES_TYPES_LIST (const int[]){NGL_NODE_TIMERANGEMODEONCE,     \
@@ -46,14 +54,14 @@ struct timerangefilter_priv {
 
 #define OFFSET(x) offsetof(struct timerangefilter_priv, x)
 static const struct node_param timerangefilter_params[] = {
-    {"child", PARAM_TYPE_NODE, OFFSET(child), .flags=PARAM_FLAG_NON_NULL,
+    {"child", PARAM_TYPE_NODE, OFFSET(child), .flags=PARAM_FLAG_NON_NULL|PARAM_FLAG_LAZY_INIT,
               .desc=NGLI_DOCSTRING("time filtered scene")},
     {"ranges", PARAM_TYPE_NODELIST, OFFSET(ranges),
                .node_types=RANGES_TYPES_LIST,
                .flags=PARAM_FLAG_DOT_DISPLAY_PACKED,
                .desc=NGLI_DOCSTRING("key frame time filtering events")},
     {"prefetch_time", PARAM_TYPE_DBL, OFFSET(prefetch_time), {.dbl=1.0},
-                      .desc=NGLI_DOCSTRING("`child` is prefetched `prefetch_time` seconds in advance")},
+                      .desc=NGLI_DOCSTRING("`child` is prefetched `prefetch_time` seconds in advance (media are seeked and start decoding at their expected start time)")},
     {"max_idle_time", PARAM_TYPE_DBL, OFFSET(max_idle_time), {.dbl=4.0},
                       .desc=NGLI_DOCSTRING("`child` will not be released if it is required in the next incoming `max_idle_time` seconds")},
     {NULL}
@@ -85,34 +93,98 @@ static int timerangefilter_init(struct ngl_node *node)
         return NGL_ERROR_INVALID_ARG;
     }
 
+    s->lazy = node->ctx->config.lazy_init;
+    ngli_darray_init(&s->rnode_paths, sizeof(int), 0);
+
     return 0;
 }
 
-static int get_rr_id(const struct timerangefilter_priv *s, int start, double t)
+/*
+ * With lazy initialization, the child is not attached to the context yet
+ * and the render node positions are recorded so the child can be prepared
+ * once it is needed.
+ */
+static int timerangefilter_prepare(struct ngl_node *node)
 {
-    int ret = -1;
+    struct ngl_ctx *ctx = node->ctx;
+    struct timerangefilter_priv *s = node->priv_data;
+
+    if (!s->lazy)
+        return ngli_node_prepare(s->child);
+
+    /* The node is kept from a previous scene, its positions are all new */
+    if (s->prepare_generation != ctx->prepare_generation) {
+        ngli_darray_clear(&s->rnode_paths);
+        s->prepare_generation = ctx->prepare_generation;
+    }
+
+    const int depth_pos = ngli_darray_count(&s->rnode_paths);
+    int *depth = ngli_darray_push(&s->rnode_paths, NULL);
+    if (!depth)
+        return NGL_ERROR_MEMORY;
+
+    int ret = ngli_rnode_get_path(&ctx->rnode, ctx->rnode_pos, &s->rnode_paths);
+    if (ret < 0)
+        return ret;
+
+    depth = ngli_darray_get(&s->rnode_paths, depth_pos);
+    *depth = ngli_darray_count(&s->rnode_paths) - depth_pos - 1;
+
+    /* The child is already attached and must be prepared at this position */
+    if (s->child_attached)
+        return ngli_node_prepare(s->child);
+    return 0;
+}
 
-    for (int i = start; i < s->nb_ranges; i++) {
-        const struct timerangemode_priv *rr = s->ranges[i]->priv_data;
-        if (rr->start_time > t)
+static int attach_child(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct timerangefilter_priv *s = node->priv_data;
+    struct ngl_node *child = s->child;
+
+    LOG(DEBUG, "initializing %s child %s", node->label, child->label);
+
+    struct rnode *rnode_pos = ctx->rnode_pos;
+    const int *paths = ngli_darray_data(&s->rnode_paths);
+    const int nb_paths = ngli_darray_count(&s->rnode_paths);
+    int ret = 0;
+    for (int i = 0; i < nb_paths; i += paths[i] + 1) {
+        struct rnode *rnode = ngli_rnode_get_from_path(&ctx->rnode, &paths[i + 1], paths[i]);
+        ngli_assert(rnode);
+        ctx->rnode_pos = rnode;
+        ret = s->child_attached ? ngli_node_prepare(child)
+                                : ngli_node_attach_ctx(child, ctx);
+        s->child_attached = 1;
+        if (ret < 0)
             break;
-        ret = i;
     }
-    return ret;
+    ctx->rnode_pos = rnode_pos;
+
+    if (ret < 0) {
+        ngli_node_detach_ctx(child, ctx);
+        s->child_attached = 0;
+        return ret;
+    }
+
+    /* Let the HUD track the nodes of the attached child */
+    ctx->attach_generation++;
+    return 0;
+}
+
+static inline double get_rr_start_time(struct ngl_node * const *ranges, int i)
+{
+    const struct timerangemode_priv *rr = ranges[i]->priv_data;
+    return rr->start_time;
 }
 
+NGLI_DEFINE_MONOTONIC_SEARCH_FUNC(get_rr_id, struct ngl_node * const *, double, get_rr_start_time)
+
 static int update_rr_state(struct timerangefilter_priv *s, double t)
 {
     if (!s->nb_ranges)
         return NGL_ERROR_INVALID_ARG;
 
-    int rr_id = get_rr_id(s, s->current_range, t);
-    if (rr_id < 0) {
-        // range not found, probably backward in time so look from the
-        // start
-        // TODO: look for rr using bsearch?
-        rr_id = get_rr_id(s, 0, t);
-    }
+    const int rr_id = get_rr_id(s->ranges, s->nb_ranges, s->current_range, t);
 
     if (rr_id >= 0) {
         if (s->current_range != rr_id) {
@@ -133,8 +205,10 @@ static int update_rr_state(struct timerangefilter_priv *s, double t)
 
 static int timerangefilter_visit(struct ngl_node *node, int is_active, double t)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct timerangefilter_priv *s = node->priv_data;
     struct ngl_node *child = s->child;
+    double activation_time = ctx->activation_time;
 
     /*
      * The life of the parent takes over the life of its children: if the
@@ -165,6 +239,12 @@ static int timerangefilter_visit(struct ngl_node *node, int is_active, double t)
                         // The node will actually be needed soon, so we need to
                         // start it if necessary.
                         is_active = 1;
+
+                        // Let the children (typically Media nodes) warm up
+                        // for the time at which they will be first updated.
+                        const struct ngl_node *next_rr = s->ranges[rr_id + 1];
+                        activation_time = next_rr->class->id == NGL_NODE_TIMERANGEMODEONCE ? next->render_time
+                                                                                           : next->start_time;
                     } else if (next_use_in <= s->max_idle_time && child->is_active) {
                         TRACE("%s not currently needed but will be soon %g (< %g), keep as active",
                               child->label, next_use_in, s->max_idle_time);
@@ -189,7 +269,17 @@ static int timerangefilter_visit(struct ngl_node *node, int is_active, double t)
         }
     }
 
-    return ngli_node_visit(child, is_active, t);
+    if (is_active && s->lazy && !s->child_attached) {
+        int ret = attach_child(node);
+        if (ret < 0)
+            return ret;
+    }
+
+    const double prev_activation_time = ctx->activation_time;
+    ctx->activation_time = activation_time;
+    int ret = ngli_node_visit(child, is_active, t);
+    ctx->activation_time = prev_activation_time;
+    return ret;
 }
 
 static int timerangefilter_update(struct ngl_node *node, double t)
@@ -220,6 +310,34 @@ static int timerangefilter_update(struct ngl_node *node, double t)
     return ngli_node_update(child, t);
 }
 
+/*
+ * The filtering only changes when entering another range, except for the
+ * first update in a once range which is followed by updates disabling the
+ * draw.
+ */
+static void timerangefilter_invariance(const struct ngl_node *node, double t, double *range)
+{
+    const struct timerangefilter_priv *s = node->priv_data;
+    if (!s->nb_ranges)
+        return;
+
+    const int rr_id = get_rr_id(s->ranges, s->nb_ranges, s->current_range, t);
+    if (rr_id < 0) {
+        range[1] = NGLI_MIN(range[1], get_rr_start_time(s->ranges, 0));
+        return;
+    }
+
+    const struct ngl_node *rr = s->ranges[rr_id];
+    if (rr->class->id == NGL_NODE_TIMERANGEMODEONCE && s->drawme) {
+        range[0] = range[1] = t;
+        return;
+    }
+
+    range[0] = NGLI_MAX(range[0], get_rr_start_time(s->ranges, rr_id));
+    if (rr_id < s->nb_ranges - 1)
+        range[1] = NGLI_MIN(range[1], get_rr_start_time(s->ranges, rr_id + 1));
+}
+
 static void timerangefilter_draw(struct ngl_node *node)
 {
     struct timerangefilter_priv *s = node->priv_data;
@@ -233,13 +351,27 @@ static void timerangefilter_draw(struct ngl_node *node)
     ngli_node_draw(child);
 }
 
+static void timerangefilter_uninit(struct ngl_node *node)
+{
+    struct timerangefilter_priv *s = node->priv_data;
+
+    if (s->child_attached) {
+        ngli_node_detach_ctx(s->child, node->ctx);
+        s->child_attached = 0;
+    }
+    ngli_darray_reset(&s->rnode_paths);
+}
+
 const struct node_class ngli_timerangefilter_class = {
     .id        = NGL_NODE_TIMERANGEFILTER,
     .name      = "TimeRangeFilter",
     .init      = timerangefilter_init,
+    .prepare   = timerangefilter_prepare,
     .visit     = timerangefilter_visit,
     .update    = timerangefilter_update,
+    .invariant = timerangefilter_invariance,
     .draw      = timerangefilter_draw,
+    .uninit    = timerangefilter_uninit,
     .priv_size = sizeof(struct timerangefilter_priv),
     .params    = timerangefilter_params,
     .file      = __FILE__,
@@ -48,6 +48,7 @@ const struct node_class ngli_transform_class = {
     .id        = NGL_NODE_TRANSFORM,
     .name      = "Transform",
     .update    = transform_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct transform_priv),
     .params    = transform_params,
@@ -54,6 +54,7 @@ static int update_vector(struct ngl_node *node)
 static int translate_init(struct ngl_node *node)
 {
     struct translate_priv *s = node->priv_data;
+    s->trf.animated = !!s->anim;
     if (!s->anim)
         update_trf_matrix(node, s->vector);
     return 0;
@@ -97,6 +98,7 @@ const struct node_class ngli_translate_class = {
     .name      = "Translate",
     .init      = translate_init,
     .update    = translate_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = ngli_transform_draw,
     .priv_size = sizeof(struct translate_priv),
     .params    = translate_params,
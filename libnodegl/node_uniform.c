@@ -251,6 +251,7 @@ const struct node_class ngli_uniform##type##_class = {          \
     .name      = class_name,                                    \
     .init      = uniform##type##_init,                          \
     .update    = uniform##type##_update,                        \
+    .invariant = ngli_node_invariance_from_children,            \
     .priv_size = sizeof(struct variable_priv),                  \
     .params    = uniform##type##_params,                        \
     .file      = __FILE__,                                      \
@@ -64,6 +64,7 @@ const struct node_class ngli_userswitch_class = {
     .name      = "UserSwitch",
     .visit     = userswitch_visit,
     .update    = userswitch_update,
+    .invariant = ngli_node_invariance_from_children,
     .draw      = userswitch_draw,
     .priv_size = sizeof(struct userswitch),
     .params    = userswitch_params,
@@ -19,6 +19,7 @@
  * under the License.
  */
 
+#include <float.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -80,6 +81,7 @@ static struct ngl_node *node_create(const struct node_class *class)
 
     node->class = class;
     node->last_update_time = -1.;
+    node->last_eval_time = -1.;
     node->visit_time = -1.;
 
     node->refcount = 1;
@@ -119,7 +121,7 @@ int ngli_is_default_label(const char *class_name, const char *str)
         return &class;                          \
     }                                           \
 
-static const struct node_class *get_node_class(int type)
+const struct node_class *ngli_node_get_class(int type)
 {
     switch (type) {
         NODE_MAP_TYPE2CLASS(REGISTER_NODE)
@@ -129,7 +131,7 @@ static const struct node_class *get_node_class(int type)
 
 struct ngl_node *ngl_node_create(int type)
 {
-    const struct node_class *class = get_node_class(type);
+    const struct node_class *class = ngli_node_get_class(type);
     if (!class) {
         LOG(ERROR, "unknown node type 0x%x", type);
         return NULL;
@@ -168,6 +170,8 @@ static void node_release(struct ngl_node *node)
     }
     node->state = STATE_INITIALIZED;
     node->last_update_time = -1.;
+    node->last_eval_time = -1.;
+    node->ctx->update_generation++;
 }
 
 /*
@@ -206,6 +210,7 @@ static void node_uninit(struct ngl_node *node)
     reset_non_params(node);
     node->state = STATE_UNINITIALIZED;
     node->visit_time = -1.;
+    node->invariance_generation = 0;
 }
 
 static int track_children(struct ngl_node *node)
@@ -320,6 +325,9 @@ static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *par
     for (int i = 0; params[i].key; i++) {
         const struct node_param *par = &params[i];
 
+        if ((par->flags & PARAM_FLAG_LAZY_INIT) && pctx->config.lazy_init)
+            continue;
+
         if (par->type == PARAM_TYPE_NODE) {
             uint8_t *node_p = base_ptr + par->offset;
             struct ngl_node *node = *(struct ngl_node **)node_p;
@@ -370,6 +378,11 @@ static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx, struct ngl_c
             LOG(ERROR, "\"%s\" is associated with another rendering context", node->label);
             return NGL_ERROR_INVALID_USAGE;
         }
+        /*
+         * The node may be kept from a previously set scene: it must be
+         * visited again to honor its activity within the new graph.
+         */
+        node->visit_time = -1.;
     } else {
         if (node->state > STATE_UNINITIALIZED) {
             if (node->ctx != pctx)
@@ -514,6 +527,7 @@ static int node_prefetch(struct ngl_node *node)
         }
     }
     node->state = STATE_READY;
+    node->ctx->update_generation++;
 
     return 0;
 }
@@ -535,11 +549,71 @@ int ngli_node_honor_release_prefetch(struct darray *nodes_array)
     return 0;
 }
 
+int ngli_node_is_invariant(const struct ngl_node *node, double t)
+{
+    return node->invariance_generation == node->ctx->update_generation &&
+           t >= node->invariance[0] && t < node->invariance[1];
+}
+
+/*
+ * Restrict the range to the invariance of the children updated for the
+ * time t. Children not updated at t are either inactive or updated at another
+ * time, in which case the parent invariance is expected to account for it.
+ */
+static void restrict_invariance_from_children(const struct ngl_node *node, double t, double *range)
+{
+    const struct darray *children_array = &node->children;
+    struct ngl_node **children = ngli_darray_data(children_array);
+    for (int i = 0; i < ngli_darray_count(children_array) && range[0] < range[1]; i++)
+        ngli_node_restrict_invariance(children[i], t, range);
+}
+
+/*
+ * Nodes without update callback only change through live changes (tracked by
+ * the update generation) but may carry updated nodes below them, so they are
+ * looked through.
+ */
+void ngli_node_restrict_invariance(const struct ngl_node *node, double t, double *range)
+{
+    if (!node->class->update) {
+        restrict_invariance_from_children(node, t, range);
+    } else if (node->last_update_time == t) {
+        if (node->invariance_generation != node->ctx->update_generation) {
+            range[0] = range[1] = t;
+            return;
+        }
+        range[0] = NGLI_MAX(range[0], node->invariance[0]);
+        range[1] = NGLI_MIN(range[1], node->invariance[1]);
+    }
+}
+
+void ngli_node_update_invariance(struct ngl_node *node, double t)
+{
+    double range[2] = {t, t}; // empty
+    if (node->class->invariant) {
+        range[0] = -DBL_MAX;
+        range[1] =  DBL_MAX;
+        node->class->invariant(node, t, range);
+        restrict_invariance_from_children(node, t, range);
+    }
+    node->invariance[0] = range[0];
+    node->invariance[1] = range[1];
+    node->invariance_generation = node->ctx->update_generation;
+}
+
+void ngli_node_invariance_from_children(const struct ngl_node *node, double t, double *range)
+{
+}
+
 int ngli_node_update(struct ngl_node *node, double t)
 {
     ngli_assert(node->state == STATE_READY);
     if (node->class->update) {
-        if (node->last_update_time != t) {
+        if (node->last_update_time != t && ngli_node_is_invariant(node, t)) {
+            TRACE("%s is invariant for t=%g, skip it", node->label, t);
+            node->last_update_time = t;
+            node->draw_count = 0;
+        } else if (node->last_update_time != t) {
             TRACE("UPDATE %s @ %p with t=%g", node->label, node, t);
             int ret = node->class->update(node, t);
             if (ret < 0) {
@@ -547,7 +621,9 @@ int ngli_node_update(struct ngl_node *node, double t)
                 return ret;
             }
             node->last_update_time = t;
+            node->last_eval_time = t;
             node->draw_count = 0;
+            ngli_node_update_invariance(node, t);
         } else {
             TRACE("%s already updated for t=%g, skip it", node->label, t);
         }
@@ -601,8 +677,11 @@ int ngl_node_param_add(struct ngl_node *node, const char *key,
         return ret;
     }
 
-    if (node->ctx && par->update_func)
-        ret = par->update_func(node);
+    if (node->ctx) {
+        node->ctx->update_generation++;
+        if (par->update_func)
+            ret = par->update_func(node);
+    }
 
     return ret;
 }
@@ -630,8 +709,11 @@ int ngl_node_param_set(struct ngl_node *node, const char *key, ...)
         return ret;
     }
 
-    if (node->ctx && par->update_func)
-        ret = par->update_func(node);
+    if (node->ctx) {
+        node->ctx->update_generation++;
+        if (par->update_func)
+            ret = par->update_func(node);
+    }
 
     return ret;
 }
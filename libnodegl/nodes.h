@@ -22,6 +22,7 @@
 #ifndef NODES_H
 #define NODES_H
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <sxplayer.h>
 #include <pthread.h>
@@ -52,6 +53,8 @@
 #endif
 
 #include "animation.h"
+#include "animengine.h"
+#include "easinglut.h"
 #include "block.h"
 #include "drawutils.h"
 #include "graphicstate.h"
@@ -70,6 +73,7 @@
 #include "rendertarget.h"
 #include "rnode.h"
 #include "texture.h"
+#include "texturepool.h"
 
 struct node_class;
 
@@ -92,8 +96,17 @@ struct ngl_ctx {
     struct darray modelview_matrix_stack;
     struct darray projection_matrix_stack;
     struct darray activitycheck_nodes;
+    double activation_time; /* expected time of first use of the branch being visited */
     struct texture *font_atlas;
     struct pgcache pgcache;
+    struct texturepool texturepool;
+    struct animengine animengine;
+    struct workpool *workpool;  /* runs the animation engine updates, NULL if single threaded */
+    struct hmap *easingluts;
+    uint64_t update_generation; /* bumped on every change not driven by the time (live changes, activity) */
+    uint64_t prepare_generation; /* bumped every time the render node tree is rebuilt and the scene prepared again */
+    uint64_t attach_generation; /* bumped every time a lazily initialized child is attached */
+    int has_drawn_frame;        /* the last frame has been drawn with the current scene and configuration */
 #if defined(HAVE_VAAPI_X11)
     Display *x11_display;
 #endif
@@ -130,6 +143,9 @@ struct ngl_node {
 
     double visit_time;
     double last_update_time;
+    double last_eval_time;          /* last update not skipped for being invariant */
+    double invariance[2];           /* [start,end) time range where the last update output remains valid */
+    uint64_t invariance_generation; /* ctx update generation at which invariance was computed */
 
     int draw_count;
 
@@ -299,6 +315,8 @@ struct texture_priv {
     struct texture_params params;
     struct ngl_node *data_src;
     int direct_rendering;
+    const struct ngl_node *rtt_child; /* scene rendered into the texture by a RenderToTexture */
+    uint64_t rtt_prepare_generation;  /* prepare generation in which rtt_child and the attachment usage were set */
 
     uint32_t supported_image_layouts;
     struct texture *texture;
@@ -316,10 +334,22 @@ struct media_priv {
     int max_nb_sink;
     int max_pixels;
     int stream_idx;
+    int sw_pix_fmt;
+    int frame_cache_size;
 
     struct sxplayer_ctx *player;
     struct sxplayer_frame *frame;
+    int frame_cached; /* frame is owned by the frame cache and must not be released */
     int nb_parents;
+    uint64_t prepare_generation;
+    double warmup_time;
+    struct animation time_eval; /* evaluation of the time remapping animation, independent from its update */
+
+    struct darray frame_cache; /* media_frame_cache_entry */
+    int64_t frame_cache_used;
+    int64_t frame_cache_clock;
+    double player_frame_ts;  /* timestamp of the last frame returned by the player */
+    double current_frame_ts; /* timestamp of the last frame exposed to the consumer */
 
 #if defined(TARGET_ANDROID)
     struct texture *android_texture;
@@ -338,6 +368,19 @@ struct timerangemode_priv {
 struct transform_priv {
     struct ngl_node *child;
     NGLI_ALIGNED_MAT(matrix);
+    int animated;
+
+    /* Non-animated transforms directly below are folded into this node */
+    struct ngl_node *folded_child;
+    uint64_t folded_generation;
+    double folded_eval_time;
+    NGLI_ALIGNED_MAT(folded_matrix);
+
+    /* World matrix cache, valid as long as the parent and folded matrices
+     * do not change */
+    int world_valid;
+    NGLI_ALIGNED_MAT(parent_matrix);
+    NGLI_ALIGNED_MAT(world_matrix);
 };
 
 struct identity_priv {
@@ -416,8 +459,11 @@ struct animkeyframe_priv {
     double *args;
     int nb_args;
     double offsets[2];
+    double tolerance;
     int scale_boundaries;
     double boundaries[2];
+    const struct easinglut *lut;
+    char *lut_key;
 };
 
 enum {
@@ -474,6 +520,7 @@ struct node_class {
     int (*visit)(struct ngl_node *node, int is_active, double t);
     int (*prefetch)(struct ngl_node *node);
     int (*update)(struct ngl_node *node, double t);
+    void (*invariant)(const struct ngl_node *node, double t, double *range);
     void (*draw)(struct ngl_node *node);
     void (*release)(struct ngl_node *node);
     void (*uninit)(struct ngl_node *node);
@@ -486,10 +533,16 @@ struct node_class {
 
 void ngli_node_print_specs(void);
 
+const struct node_class *ngli_node_get_class(int type);
+
 int ngli_node_prepare(struct ngl_node *node);
 int ngli_node_visit(struct ngl_node *node, int is_active, double t);
 int ngli_node_honor_release_prefetch(struct darray *nodes_array);
 int ngli_node_update(struct ngl_node *node, double t);
+int ngli_node_is_invariant(const struct ngl_node *node, double t);
+void ngli_node_update_invariance(struct ngl_node *node, double t);
+void ngli_node_restrict_invariance(const struct ngl_node *node, double t, double *range);
+void ngli_node_invariance_from_children(const struct ngl_node *node, double t, double *range);
 int ngli_prepare_draw(struct ngl_ctx *s, double t);
 void ngli_node_draw(struct ngl_node *node);
 
@@ -549,6 +549,68 @@ int ngli_params_vset(uint8_t *base_ptr, const struct node_param *par, ...)
     return ret;
 }
 
+int ngli_params_set_default(uint8_t *base_ptr, const struct node_param *par)
+{
+    int ret = 0;
+
+    switch (par->type) {
+        case PARAM_TYPE_SELECT: {
+            const int v = (int)par->def_value.i64;
+            const char *s = ngli_params_get_select_str(par->choices->consts, v);
+            ngli_assert(s);
+            ret = ngli_params_vset(base_ptr, par, s);
+            break;
+        }
+        case PARAM_TYPE_FLAGS: {
+            const int v = (int)par->def_value.i64;
+            char *s = ngli_params_get_flags_str(par->choices->consts, v);
+            if (!s)
+                return NGL_ERROR_INVALID_ARG;
+            ngli_assert(*s);
+            ret = ngli_params_vset(base_ptr, par, s);
+            ngli_free(s);
+            break;
+        }
+        case PARAM_TYPE_BOOL:
+        case PARAM_TYPE_INT:
+        case PARAM_TYPE_UINT:
+        case PARAM_TYPE_I64:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.i64);
+            break;
+        case PARAM_TYPE_DBL:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.dbl);
+            break;
+        case PARAM_TYPE_STR:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.str);
+            break;
+        case PARAM_TYPE_IVEC2:
+        case PARAM_TYPE_IVEC3:
+        case PARAM_TYPE_IVEC4:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.ivec);
+            break;
+        case PARAM_TYPE_UIVEC2:
+        case PARAM_TYPE_UIVEC3:
+        case PARAM_TYPE_UIVEC4:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.uvec);
+            break;
+        case PARAM_TYPE_VEC2:
+        case PARAM_TYPE_VEC3:
+        case PARAM_TYPE_VEC4:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.vec);
+            break;
+        case PARAM_TYPE_MAT4:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.mat);
+            break;
+        case PARAM_TYPE_DATA:
+            ret = ngli_params_vset(base_ptr, par, 0, par->def_value.p);
+            break;
+        case PARAM_TYPE_RATIONAL:
+            ret = ngli_params_vset(base_ptr, par, par->def_value.r[0], par->def_value.r[1]);
+            break;
+    }
+    return ret;
+}
+
 int ngli_params_set_defaults(uint8_t *base_ptr, const struct node_param *params)
 {
     int last_offset = 0;
@@ -567,63 +629,7 @@ int ngli_params_set_defaults(uint8_t *base_ptr, const struct node_param *params)
         }
         last_offset = par->offset;
 
-        int ret = 0;
-        // TODO: reindent
-            switch (par->type) {
-                case PARAM_TYPE_SELECT: {
-                    const int v = (int)par->def_value.i64;
-                    const char *s = ngli_params_get_select_str(par->choices->consts, v);
-                    ngli_assert(s);
-                    ret = ngli_params_vset(base_ptr, par, s);
-                    break;
-                }
-                case PARAM_TYPE_FLAGS: {
-                    const int v = (int)par->def_value.i64;
-                    char *s = ngli_params_get_flags_str(par->choices->consts, v);
-                    if (!s)
-                        return NGL_ERROR_INVALID_ARG;
-                    ngli_assert(*s);
-                    ret = ngli_params_vset(base_ptr, par, s);
-                    ngli_free(s);
-                    break;
-                }
-                case PARAM_TYPE_BOOL:
-                case PARAM_TYPE_INT:
-                case PARAM_TYPE_UINT:
-                case PARAM_TYPE_I64:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.i64);
-                    break;
-                case PARAM_TYPE_DBL:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.dbl);
-                    break;
-                case PARAM_TYPE_STR:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.str);
-                    break;
-                case PARAM_TYPE_IVEC2:
-                case PARAM_TYPE_IVEC3:
-                case PARAM_TYPE_IVEC4:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.ivec);
-                    break;
-                case PARAM_TYPE_UIVEC2:
-                case PARAM_TYPE_UIVEC3:
-                case PARAM_TYPE_UIVEC4:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.uvec);
-                    break;
-                case PARAM_TYPE_VEC2:
-                case PARAM_TYPE_VEC3:
-                case PARAM_TYPE_VEC4:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.vec);
-                    break;
-                case PARAM_TYPE_MAT4:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.mat);
-                    break;
-                case PARAM_TYPE_DATA:
-                    ret = ngli_params_vset(base_ptr, par, 0, par->def_value.p);
-                    break;
-                case PARAM_TYPE_RATIONAL:
-                    ret = ngli_params_vset(base_ptr, par, par->def_value.r[0], par->def_value.r[1]);
-                    break;
-            }
+        int ret = ngli_params_set_default(base_ptr, par);
         if (ret < 0)
             return ret;
     }
@@ -689,6 +695,67 @@ int ngli_params_add(uint8_t *base_ptr, const struct node_param *par,
     return 0;
 }
 
+int ngli_params_take(uint8_t *base_ptr, const struct node_param *par,
+                     int nb_elems, void *elems)
+{
+    LOG(VERBOSE, "take %d elems for %s", nb_elems, par->key);
+    uint8_t *dstp = base_ptr + par->offset;
+    switch (par->type) {
+        case PARAM_TYPE_DATA: {
+            uint8_t **datap = (uint8_t **)dstp;
+            ngli_free(*datap);
+            *datap = nb_elems ? elems : NULL;
+            if (!nb_elems)
+                ngli_free(elems);
+            memcpy(dstp + sizeof(uint8_t *), &nb_elems, sizeof(nb_elems));
+            break;
+        }
+        case PARAM_TYPE_DBLLIST: {
+            double **cur_elemsp = (double **)dstp;
+            int *nb_cur_elemsp = (int *)(dstp + sizeof(double *));
+            if (*nb_cur_elemsp) {
+                int ret = ngli_params_add(base_ptr, par, nb_elems, elems);
+                ngli_free(elems);
+                return ret;
+            }
+            ngli_free(*cur_elemsp);
+            *cur_elemsp = elems;
+            *nb_cur_elemsp = nb_elems;
+            break;
+        }
+        case PARAM_TYPE_NODELIST: {
+            struct ngl_node ***cur_elemsp = (struct ngl_node ***)dstp;
+            int *nb_cur_elemsp = (int *)(dstp + sizeof(struct ngl_node **));
+            struct ngl_node **new_elems = elems;
+            if (*nb_cur_elemsp) {
+                int ret = ngli_params_add(base_ptr, par, nb_elems, elems);
+                ngli_free(elems);
+                return ret;
+            }
+            for (int i = 0; i < nb_elems; i++) {
+                const struct ngl_node *e = new_elems[i];
+                if (!allowed_node(e, par->node_types)) {
+                    LOG(ERROR, "%s (%s) is not an allowed type for %s list",
+                        e->label, e->class->name, par->key);
+                    ngli_free(elems);
+                    return NGL_ERROR_INVALID_ARG;
+                }
+            }
+            for (int i = 0; i < nb_elems; i++)
+                ngl_node_ref(new_elems[i]);
+            ngli_free(*cur_elemsp);
+            *cur_elemsp = new_elems;
+            *nb_cur_elemsp = nb_elems;
+            break;
+        }
+        default:
+            LOG(ERROR, "parameter %s can not take ownership of a buffer", par->key);
+            ngli_free(elems);
+            return NGL_ERROR_INVALID_USAGE;
+    }
+    return 0;
+}
+
 void ngli_params_free(uint8_t *base_ptr, const struct node_param *params)
 {
     if (!params)
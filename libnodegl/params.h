@@ -77,6 +77,7 @@ struct ngl_node;
 #define PARAM_FLAG_DOT_DISPLAY_PACKED (1<<1)
 #define PARAM_FLAG_DOT_DISPLAY_FIELDNAME (1<<2)
 #define PARAM_FLAG_ALLOW_LIVE_CHANGE (1<<3)
+#define PARAM_FLAG_LAZY_INIT (1<<4) // attached by the owner node itself when ngl_config.lazy_init is set
 struct node_param {
     const char *key;
     int type;
@@ -107,8 +108,17 @@ const struct node_param *ngli_params_find(const struct node_param *params, const
 void ngli_params_bstr_print_val(struct bstr *b, uint8_t *base_ptr, const struct node_param *par);
 int ngli_params_set(uint8_t *base_ptr, const struct node_param *par, va_list *ap);
 int ngli_params_vset(uint8_t *base_ptr, const struct node_param *par, ...);
+int ngli_params_set_default(uint8_t *base_ptr, const struct node_param *par);
 int ngli_params_set_defaults(uint8_t *base_ptr, const struct node_param *params);
 int ngli_params_add(uint8_t *base_ptr, const struct node_param *par, int nb_elems, void *elems);
+
+/*
+ * Set a PARAM_TYPE_DATA (nb_elems being its size in bytes) or append to a
+ * PARAM_TYPE_DBLLIST or PARAM_TYPE_NODELIST without copy: the elements must
+ * have been allocated with ngli_malloc() and are owned by the parameter, even
+ * on error. The nodes of a list are referenced by the parameter.
+ */
+int ngli_params_take(uint8_t *base_ptr, const struct node_param *par, int nb_elems, void *elems);
 void ngli_params_free(uint8_t *base_ptr, const struct node_param *params);
 
 #endif
@@ -45,11 +45,17 @@
 #include "utils.h"
 
 struct pipeline_desc {
+    struct pipeline_graphics graphics;
     struct pgcraft *crafter;
     struct pipeline *pipeline;
     int modelview_matrix_index;
     int projection_matrix_index;
     int normal_matrix_index;
+
+    /* Normal matrix cache, valid as long as the modelview matrix does not change */
+    int normal_matrix_valid;
+    float normal_modelview_matrix[4*4];
+    float normal_matrix[3*3];
 };
 
 static int register_uniform(struct pass *s, const char *name, struct ngl_node *uniform, int stage)
@@ -441,6 +447,96 @@ static int pass_compute_init(struct pass *s)
     return 0;
 }
 
+static void free_pipeline_descs(struct darray *descs_array)
+{
+    struct pipeline_desc *descs = ngli_darray_data(descs_array);
+    const int nb_descs = ngli_darray_count(descs_array);
+    for (int i = 0; i < nb_descs; i++) {
+        struct pipeline_desc *desc = &descs[i];
+        ngli_pipeline_freep(&desc->pipeline);
+        ngli_pgcraft_freep(&desc->crafter);
+    }
+    ngli_darray_clear(descs_array);
+}
+
+static int is_same_graphicstate(const struct graphicstate *a, const struct graphicstate *b)
+{
+    return a->blend              == b->blend              &&
+           a->blend_dst_factor   == b->blend_dst_factor   &&
+           a->blend_src_factor   == b->blend_src_factor   &&
+           a->blend_dst_factor_a == b->blend_dst_factor_a &&
+           a->blend_src_factor_a == b->blend_src_factor_a &&
+           a->blend_op           == b->blend_op           &&
+           a->blend_op_a         == b->blend_op_a         &&
+           a->color_write_mask   == b->color_write_mask   &&
+           a->depth_test         == b->depth_test         &&
+           a->depth_write_mask   == b->depth_write_mask   &&
+           a->depth_func         == b->depth_func         &&
+           a->stencil_test       == b->stencil_test       &&
+           a->stencil_write_mask == b->stencil_write_mask &&
+           a->stencil_func       == b->stencil_func       &&
+           a->stencil_ref        == b->stencil_ref        &&
+           a->stencil_read_mask  == b->stencil_read_mask  &&
+           a->stencil_fail       == b->stencil_fail       &&
+           a->stencil_depth_fail == b->stencil_depth_fail &&
+           a->stencil_depth_pass == b->stencil_depth_pass &&
+           a->cull_mode          == b->cull_mode          &&
+           a->scissor_test       == b->scissor_test;
+}
+
+static int is_same_attachment_desc(const struct attachment_desc *a, const struct attachment_desc *b)
+{
+    return a->format == b->format && a->resolve == b->resolve;
+}
+
+/* Only the used color attachments are compared */
+static int is_same_rendertarget_desc(const struct rendertarget_desc *a, const struct rendertarget_desc *b)
+{
+    if (a->samples != b->samples || a->nb_colors != b->nb_colors ||
+        !is_same_attachment_desc(&a->depth_stencil, &b->depth_stencil))
+        return 0;
+    for (int i = 0; i < a->nb_colors; i++)
+        if (!is_same_attachment_desc(&a->colors[i], &b->colors[i]))
+            return 0;
+    return 1;
+}
+
+static int is_same_pipeline_graphics(const struct pipeline_graphics *a, const struct pipeline_graphics *b)
+{
+    return a->topology == b->topology &&
+           is_same_graphicstate(&a->state, &b->state) &&
+           is_same_rendertarget_desc(&a->rt_desc, &b->rt_desc);
+}
+
+/*
+ * When the scene is prepared again (typically because a new scene sharing
+ * this node has been set), the pipelines crafted for the previous scene are
+ * reused for the positions where the graphics state did not change.
+ */
+static int reuse_pipeline_desc(struct pass *s, const struct pipeline_graphics *graphics)
+{
+    struct ngl_ctx *ctx = s->ctx;
+
+    if (s->prepare_generation != ctx->prepare_generation) {
+        free_pipeline_descs(&s->prev_pipeline_descs);
+        NGLI_SWAP(struct darray, s->pipeline_descs, s->prev_pipeline_descs);
+        s->prepare_generation = ctx->prepare_generation;
+    }
+
+    const struct pipeline_desc *prev_descs = ngli_darray_data(&s->prev_pipeline_descs);
+    for (int i = 0; i < ngli_darray_count(&s->prev_pipeline_descs); i++) {
+        if (!is_same_pipeline_graphics(&prev_descs[i].graphics, graphics))
+            continue;
+        if (!ngli_darray_push(&s->pipeline_descs, &prev_descs[i]))
+            return NGL_ERROR_MEMORY;
+        ngli_darray_remove(&s->prev_pipeline_descs, i);
+        ctx->rnode_pos->id = ngli_darray_count(&s->pipeline_descs) - 1;
+        return 1;
+    }
+
+    return 0;
+}
+
 int ngli_pass_prepare(struct pass *s)
 {
     struct ngl_ctx *ctx = s->ctx;
@@ -505,19 +601,26 @@ int ngli_pass_prepare(struct pass *s)
         .workgroup_size    = {NGLI_ARG_VEC3(s->params.workgroup_size)},
     };
 
+    int ret = reuse_pipeline_desc(s, &pipeline_graphics);
+    if (ret < 0)
+        return ret;
+    if (ret)
+        return 0;
+
     struct pipeline_desc *desc = ngli_darray_push(&s->pipeline_descs, NULL);
     if (!desc)
         return NGL_ERROR_MEMORY;
     ctx->rnode_pos->id = ngli_darray_count(&s->pipeline_descs) - 1;
 
     memset(desc, 0, sizeof(*desc));
+    desc->graphics = pipeline_graphics;
 
     desc->crafter = ngli_pgcraft_create(ctx);
     if (!desc->crafter)
         return NGL_ERROR_MEMORY;
 
     struct pipeline_resource_params pipeline_resource_params = {0};
-    int ret = ngli_pgcraft_craft(desc->crafter, &pipeline_params, &pipeline_resource_params, &crafter_params);
+    ret = ngli_pgcraft_craft(desc->crafter, &pipeline_params, &pipeline_resource_params, &crafter_params);
     if (ret < 0)
         return ret;
 
@@ -555,6 +658,7 @@ int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params
     ngli_darray_init(&s->crafter_blocks, sizeof(struct pgcraft_block), 0);
 
     ngli_darray_init(&s->pipeline_descs, sizeof(struct pipeline_desc), 0);
+    ngli_darray_init(&s->prev_pipeline_descs, sizeof(struct pipeline_desc), 0);
 
     int ret = register_builtin_uniforms(s);
     if (ret < 0)
@@ -598,14 +702,10 @@ void ngli_pass_uninit(struct pass *s)
     if (!s->ctx)
         return;
 
-    struct pipeline_desc *descs = ngli_darray_data(&s->pipeline_descs);
-    const int nb_descs = ngli_darray_count(&s->pipeline_descs);
-    for (int i = 0; i < nb_descs; i++) {
-        struct pipeline_desc *desc = &descs[i];
-        ngli_pipeline_freep(&desc->pipeline);
-        ngli_pgcraft_freep(&desc->crafter);
-    }
+    free_pipeline_descs(&s->pipeline_descs);
+    free_pipeline_descs(&s->prev_pipeline_descs);
     ngli_darray_reset(&s->pipeline_descs);
+    ngli_darray_reset(&s->prev_pipeline_descs);
 
     if (s->indices)
         ngli_node_buffer_unref(s->indices);
@@ -656,6 +756,10 @@ DECLARE_UPDATE_NODES_FUNC(buffer, NODE_TYPE_BUFFER)
 
 int ngli_pass_update(struct pass *s, double t)
 {
+    /* The pipelines of the previous scene which have not been reused */
+    if (ngli_darray_count(&s->prev_pipeline_descs))
+        free_pipeline_descs(&s->prev_pipeline_descs);
+
     int ret;
     if ((ret = update_common_nodes(&s->uniform_nodes, t)) < 0 ||
         (ret = update_common_nodes(&s->texture_nodes, t)) < 0 ||
@@ -681,11 +785,16 @@ int ngli_pass_exec(struct pass *s)
     ngli_pipeline_update_uniform(pipeline, desc->projection_matrix_index, projection_matrix);
 
     if (desc->normal_matrix_index >= 0) {
-        float normal_matrix[3*3];
-        ngli_mat3_from_mat4(normal_matrix, modelview_matrix);
-        ngli_mat3_inverse(normal_matrix, normal_matrix);
-        ngli_mat3_transpose(normal_matrix, normal_matrix);
-        ngli_pipeline_update_uniform(pipeline, desc->normal_matrix_index, normal_matrix);
+        if (!desc->normal_matrix_valid ||
+            memcmp(desc->normal_modelview_matrix, modelview_matrix, sizeof(desc->normal_modelview_matrix))) {
+            float *normal_matrix = desc->normal_matrix;
+            ngli_mat3_from_mat4(normal_matrix, modelview_matrix);
+            ngli_mat3_inverse(normal_matrix, normal_matrix);
+            ngli_mat3_transpose(normal_matrix, normal_matrix);
+            memcpy(desc->normal_modelview_matrix, modelview_matrix, sizeof(desc->normal_modelview_matrix));
+            desc->normal_matrix_valid = 1;
+        }
+        ngli_pipeline_update_uniform(pipeline, desc->normal_matrix_index, desc->normal_matrix);
     }
 
     struct darray *texture_infos_array = &desc->crafter->texture_infos;
@@ -718,6 +827,11 @@ int ngli_pass_exec(struct pass *s)
             ret = ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_Y_RECT_SAMPLER].index, image->planes[0]);
             ret &= ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_UV_RECT_SAMPLER].index, image->planes[1]);
             break;
+        case NGLI_IMAGE_LAYOUT_YUV:
+            ret = ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_Y_SAMPLER].index, image->planes[0]);
+            ret &= ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_U_SAMPLER].index, image->planes[1]);
+            ret &= ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_V_SAMPLER].index, image->planes[2]);
+            break;
         case NGLI_IMAGE_LAYOUT_MEDIACODEC:
             ret = ngli_pipeline_update_texture(pipeline, fields[NGLI_INFO_FIELD_OES_SAMPLER].index, image->planes[0]);
             break;
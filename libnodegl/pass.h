@@ -81,6 +81,8 @@ struct pass {
     struct darray crafter_textures;
     struct darray crafter_blocks;
     struct darray pipeline_descs;
+    struct darray prev_pipeline_descs; /* pipelines from the previous prepare generation, reusable */
+    uint64_t prepare_generation;
 };
 
 int ngli_pass_init(struct pass *s, struct ngl_ctx *ctx, const struct pass_params *params);
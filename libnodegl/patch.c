@@ -0,0 +1,487 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "darray.h"
+#include "deserialize.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "params.h"
+#include "utils.h"
+
+/*
+ * A scene patch describes the parameter changes between two serialized
+ * versions of a scene sharing the same node graph structure:
+ *
+ *   # Node.GL vX.Y.Z patch
+ *   <node index> <key>:<value> !<key> ...
+ *
+ * The node index (hexadecimal) is the absolute position of the node in the
+ * serialized scene, which is a stable identifier as long as the structure of
+ * the graph does not change. Values use the serialized scene syntax, and
+ * "!key" resets a parameter to its default value. Node references are not
+ * allowed since they would change the structure.
+ */
+
+#define PATCH_HEADER_FMT "# Node.GL v%d.%d.%d patch\n"
+
+extern const struct node_param ngli_base_node_params[];
+
+static int is_node_ref(int type)
+{
+    return type == PARAM_TYPE_NODE ||
+           type == PARAM_TYPE_NODELIST ||
+           type == PARAM_TYPE_NODEDICT;
+}
+
+static const char *get_eol(const char *s)
+{
+    const char *eol = strchr(s, '\n');
+    return eol ? eol : s + strlen(s);
+}
+
+static const char *next_line(const char *eol)
+{
+    return *eol ? eol + 1 : eol;
+}
+
+struct token {
+    const char *key;
+    int key_len;
+    const char *val;
+    int val_len;
+};
+
+/* Split the "key:value" parameters of a serialized node line */
+static int get_tokens(struct darray *tokens, const char *s, const char *end)
+{
+    ngli_darray_clear(tokens);
+    while (s < end) {
+        const char *eot = memchr(s, ' ', end - s);
+        if (!eot)
+            eot = end;
+        const char *sep = memchr(s, ':', eot - s);
+        if (!sep)
+            return NGL_ERROR_INVALID_DATA;
+        const struct token token = {
+            .key     = s,
+            .key_len = (int)(sep - s),
+            .val     = sep + 1,
+            .val_len = (int)(eot - sep - 1),
+        };
+        if (!ngli_darray_push(tokens, &token))
+            return NGL_ERROR_MEMORY;
+        s = eot + (eot < end);
+    }
+    return 0;
+}
+
+static const struct token *find_token(const struct darray *tokens, const struct token *ref)
+{
+    const struct token *t = ngli_darray_data(tokens);
+    for (int i = 0; i < ngli_darray_count(tokens); i++)
+        if (t[i].key_len == ref->key_len && !memcmp(t[i].key, ref->key, ref->key_len))
+            return &t[i];
+    return NULL;
+}
+
+static const struct node_param *find_class_param(const struct node_class *class,
+                                                 const char *key, int key_len)
+{
+    char name[63 + 1];
+    if (key_len >= sizeof(name))
+        return NULL;
+    memcpy(name, key, key_len);
+    name[key_len] = 0;
+    const struct node_param *par = ngli_params_find(ngli_base_node_params, name);
+    return par ? par : ngli_params_find(class->params, name);
+}
+
+static int diff_line(struct bstr *b, int index,
+                     struct darray *old_tokens, const char *old_line, const char *old_end,
+                     struct darray *new_tokens, const char *new_line, const char *new_end)
+{
+    if (old_end - old_line < 4 || new_end - new_line < 4 || memcmp(old_line, new_line, 4)) {
+        LOG(DEBUG, "node %x changed type", index);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
+    const int type = NGLI_FOURCC(new_line[0], new_line[1], new_line[2], new_line[3]);
+    const struct node_class *class = ngli_node_get_class(type);
+    if (!class)
+        return NGL_ERROR_INVALID_DATA;
+
+    old_line += 4 + (old_line + 4 < old_end);
+    new_line += 4 + (new_line + 4 < new_end);
+    int ret;
+    if ((ret = get_tokens(old_tokens, old_line, old_end)) < 0 ||
+        (ret = get_tokens(new_tokens, new_line, new_end)) < 0)
+        return ret;
+
+    ngli_bstr_printf(b, "%x", index);
+
+    const struct token *new_t = ngli_darray_data(new_tokens);
+    for (int i = 0; i < ngli_darray_count(new_tokens); i++) {
+        const struct token *t = &new_t[i];
+        const struct token *old_t = find_token(old_tokens, t);
+        if (old_t && old_t->val_len == t->val_len && !memcmp(old_t->val, t->val, t->val_len))
+            continue;
+        const struct node_param *par = find_class_param(class, t->key, t->key_len);
+        if (!par || is_node_ref(par->type)) {
+            LOG(DEBUG, "node %x changed structure", index);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        ngli_bstr_printf(b, " %.*s:%.*s", t->key_len, t->key, t->val_len, t->val);
+    }
+
+    const struct token *old_t = ngli_darray_data(old_tokens);
+    for (int i = 0; i < ngli_darray_count(old_tokens); i++) {
+        const struct token *t = &old_t[i];
+        if (find_token(new_tokens, t))
+            continue;
+        const struct node_param *par = find_class_param(class, t->key, t->key_len);
+        if (!par || is_node_ref(par->type)) {
+            LOG(DEBUG, "node %x changed structure", index);
+            return NGL_ERROR_INVALID_DATA;
+        }
+        ngli_bstr_printf(b, " !%.*s", t->key_len, t->key);
+    }
+
+    ngli_bstr_print(b, "\n");
+    return 0;
+}
+
+char *ngl_node_diff(const char *old_scene, const char *new_scene)
+{
+    char *patch = NULL;
+    struct darray old_tokens, new_tokens;
+    ngli_darray_init(&old_tokens, sizeof(struct token), 0);
+    ngli_darray_init(&new_tokens, sizeof(struct token), 0);
+
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        goto end;
+
+    /* The scenes must share the same version header */
+    const char *old_eol = get_eol(old_scene);
+    const char *new_eol = get_eol(new_scene);
+    if (old_eol - old_scene != new_eol - new_scene ||
+        memcmp(old_scene, new_scene, old_eol - old_scene) ||
+        strncmp(old_scene, "# Node.GL v", strlen("# Node.GL v")))
+        goto end;
+    old_scene = next_line(old_eol);
+    new_scene = next_line(new_eol);
+
+    ngli_bstr_printf(b, PATCH_HEADER_FMT,
+                     NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
+
+    int index = 0;
+    while (*old_scene && *new_scene) {
+        old_eol = get_eol(old_scene);
+        new_eol = get_eol(new_scene);
+        if (old_eol - old_scene != new_eol - new_scene ||
+            memcmp(old_scene, new_scene, new_eol - new_scene)) {
+            int ret = diff_line(b, index,
+                                &old_tokens, old_scene, old_eol,
+                                &new_tokens, new_scene, new_eol);
+            if (ret < 0)
+                goto end;
+        }
+        old_scene = next_line(old_eol);
+        new_scene = next_line(new_eol);
+        index++;
+    }
+
+    /* Nodes were added or removed */
+    if (*old_scene || *new_scene)
+        goto end;
+
+    if (ngli_bstr_check(b) < 0)
+        goto end;
+
+    patch = ngli_bstr_strdup(b);
+
+end:
+    ngli_darray_reset(&new_tokens);
+    ngli_darray_reset(&old_tokens);
+    ngli_bstr_freep(&b);
+    return patch;
+}
+
+static int collect_nodes(struct hmap *seen, struct darray *nodes, struct ngl_node *node);
+
+/* Must follow the same order as the serializer */
+static int collect_children(struct hmap *seen, struct darray *nodes,
+                            uint8_t *priv, const struct node_param *p)
+{
+    while (p && p->key) {
+        int ret = 0;
+        switch (p->type) {
+            case PARAM_TYPE_NODE: {
+                struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
+                if (child)
+                    ret = collect_nodes(seen, nodes, child);
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **children = *(struct ngl_node ***)(priv + p->offset);
+                const int nb_children = *(int *)(priv + p->offset + sizeof(struct ngl_node **));
+                for (int i = 0; i < nb_children && ret >= 0; i++)
+                    ret = collect_nodes(seen, nodes, children[i]);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(priv + p->offset);
+                if (!hmap)
+                    break;
+                /* The serializer walks the dictionaries in key order */
+                const int nb_entries = ngli_hmap_count(hmap);
+                const struct hmap_entry **entries = ngli_calloc(nb_entries, sizeof(*entries));
+                if (!entries)
+                    return NGL_ERROR_MEMORY;
+                const struct hmap_entry *entry = NULL;
+                for (int i = 0; (entry = ngli_hmap_next(hmap, entry)); i++)
+                    entries[i] = entry;
+                for (int i = 0; i < nb_entries && ret >= 0; i++) {
+                    int min = i;
+                    for (int j = i + 1; j < nb_entries; j++)
+                        if (strcmp(entries[j]->key, entries[min]->key) < 0)
+                            min = j;
+                    NGLI_SWAP(const struct hmap_entry *, entries[i], entries[min]);
+                    ret = collect_nodes(seen, nodes, entries[i]->data);
+                }
+                ngli_free(entries);
+                break;
+            }
+        }
+        if (ret < 0)
+            return ret;
+        p++;
+    }
+    return 0;
+}
+
+static int collect_nodes(struct hmap *seen, struct darray *nodes, struct ngl_node *node)
+{
+    char key[32];
+    (void)snprintf(key, sizeof(key), "%p", node);
+    if (ngli_hmap_get(seen, key))
+        return 0;
+
+    int ret;
+    if ((ret = collect_children(seen, nodes, (uint8_t *)node, ngli_base_node_params)) < 0 ||
+        (ret = collect_children(seen, nodes, node->priv_data, node->class->params)) < 0)
+        return ret;
+
+    ret = ngli_hmap_set(seen, key, node);
+    if (ret < 0)
+        return ret;
+    if (!ngli_darray_push(nodes, &node))
+        return NGL_ERROR_MEMORY;
+    return 0;
+}
+
+static void reset_list(uint8_t *base_ptr, const struct node_param *par)
+{
+    double **elemsp = (double **)(base_ptr + par->offset);
+    int *nb_elemsp = (int *)(base_ptr + par->offset + sizeof(double *));
+    ngli_freep(elemsp);
+    *nb_elemsp = 0;
+}
+
+/*
+ * Parse a value into a scratch storage (large enough for any parameter which
+ * is not a node reference) without altering the node.
+ */
+static int check_value(const struct node_param *par, const char *val, const char *end)
+{
+    uint64_t storage[8] = {0};
+    struct node_param params[] = {*par, {NULL}};
+    params[0].offset = 0;
+
+    int ret = ngli_deserialize_param((uint8_t *)storage, &params[0], val, end);
+    if (ret >= 0 && val + ret != end)
+        ret = NGL_ERROR_INVALID_DATA;
+    ngli_params_free((uint8_t *)storage, params);
+    return ret;
+}
+
+/*
+ * Run over every parameter of the patch; with apply unset, only check that
+ * the patch is applicable (every value being parsed) and whether it only
+ * contains live changes.
+ */
+static int run_patch(struct ngl_node **nodes, int nb_nodes, const char *patch,
+                     int apply, int *live_changes)
+{
+    while (*patch) {
+        const char *eol = get_eol(patch);
+        if (eol == patch) {
+            patch = next_line(eol);
+            continue;
+        }
+
+        char *endptr = NULL;
+        const long index = strtol(patch, &endptr, 16);
+        if (endptr == patch || index < 0 || index >= nb_nodes) {
+            LOG(ERROR, "invalid node index in patch");
+            return NGL_ERROR_INVALID_DATA;
+        }
+        struct ngl_node *node = nodes[index];
+
+        const char *s = endptr;
+        while (s < eol) {
+            if (*s++ != ' ')
+                return NGL_ERROR_INVALID_DATA;
+            const int reset = *s == '!';
+            s += reset;
+            const char *eot = memchr(s, ' ', eol - s);
+            if (!eot)
+                eot = eol;
+            const char *eok = reset ? eot : memchr(s, ':', eot - s);
+            if (!eok)
+                return NGL_ERROR_INVALID_DATA;
+
+            char key[63 + 1];
+            const size_t key_len = eok - s;
+            if (key_len >= sizeof(key))
+                return NGL_ERROR_INVALID_DATA;
+            memcpy(key, s, key_len);
+            key[key_len] = 0;
+
+            uint8_t *base_ptr;
+            const struct node_param *par = ngli_node_param_find(node, key, &base_ptr);
+            if (!par)
+                return NGL_ERROR_INVALID_DATA;
+            if (is_node_ref(par->type)) {
+                LOG(ERROR, "node references can not be patched (%s.%s)", node->label, key);
+                return NGL_ERROR_INVALID_DATA;
+            }
+
+            if (!apply) {
+                if (node->ctx && !(par->flags & PARAM_FLAG_ALLOW_LIVE_CHANGE))
+                    *live_changes = 0;
+                if (!reset) {
+                    int ret = check_value(par, eok + 1, eot);
+                    if (ret < 0) {
+                        LOG(ERROR, "invalid value for %s.%s: %s", node->label, key, NGLI_RET_STR(ret));
+                        return ret;
+                    }
+                }
+                s = eot;
+                continue;
+            }
+
+            if (par->type == PARAM_TYPE_DBLLIST)
+                reset_list(base_ptr, par);
+
+            int ret;
+            if (reset && base_ptr == (uint8_t *)node && !strcmp(par->key, "label")) {
+                /* The serializer omits the labels named after the class */
+                char *label = ngli_node_default_label(node->class->name);
+                if (!label)
+                    return NGL_ERROR_MEMORY;
+                ngli_free(node->label);
+                node->label = label;
+                ret = 0;
+            } else if (reset) {
+                ret = ngli_params_set_default(base_ptr, par);
+            } else {
+                const char *val = eok + 1;
+                ret = ngli_deserialize_param(base_ptr, par, val, eot);
+                if (ret >= 0 && val + ret != eot)
+                    ret = NGL_ERROR_INVALID_DATA;
+            }
+            if (ret < 0) {
+                LOG(ERROR, "unable to patch %s.%s: %s", node->label, key, NGLI_RET_STR(ret));
+                return ret;
+            }
+
+            if (node->ctx) {
+                node->ctx->update_generation++;
+                if (par->update_func) {
+                    ret = par->update_func(node);
+                    if (ret < 0)
+                        return ret;
+                }
+            }
+            s = eot;
+        }
+
+        patch = next_line(eol);
+    }
+    return 0;
+}
+
+int ngl_node_patch(struct ngl_node *scene, const char *patch)
+{
+    int major, minor, micro;
+    int n = sscanf(patch, "# Node.GL v%d.%d.%d patch", &major, &minor, &micro);
+    if (n != 3 || strncmp(get_eol(patch) - 6, " patch", 6)) {
+        LOG(ERROR, "invalid scene patch");
+        return NGL_ERROR_INVALID_DATA;
+    }
+    if (NODEGL_VERSION_INT != NODEGL_GET_VERSION(major, minor, micro)) {
+        LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
+            major, minor, micro,
+            NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
+        return NGL_ERROR_INVALID_DATA;
+    }
+    patch = next_line(get_eol(patch));
+
+    struct darray nodes_array;
+    ngli_darray_init(&nodes_array, sizeof(struct ngl_node *), 0);
+    struct hmap *seen = ngli_hmap_create();
+    if (!seen)
+        return NGL_ERROR_MEMORY;
+
+    int ret = collect_nodes(seen, &nodes_array, scene);
+    if (ret < 0)
+        goto end;
+
+    struct ngl_node **nodes = ngli_darray_data(&nodes_array);
+    const int nb_nodes = ngli_darray_count(&nodes_array);
+
+    /* Nothing is changed unless the whole patch can be applied */
+    int live_changes = 1;
+    ret = run_patch(nodes, nb_nodes, patch, 0, &live_changes);
+    if (ret < 0)
+        goto end;
+    if (!live_changes) {
+        LOG(DEBUG, "patch contains parameters which can not be live changed");
+        ret = NGL_ERROR_INVALID_USAGE;
+        goto end;
+    }
+
+    ret = run_patch(nodes, nb_nodes, patch, 1, &live_changes);
+
+end:
+    ngli_hmap_freep(&seen);
+    ngli_darray_reset(&nodes_array);
+    return ret;
+}
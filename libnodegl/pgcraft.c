@@ -210,6 +210,8 @@ static const char * const texture_info_suffixes[NGLI_INFO_FIELD_NB] = {
     [NGLI_INFO_FIELD_UV_SAMPLER]        = "_uv_sampler",
     [NGLI_INFO_FIELD_Y_RECT_SAMPLER]    = "_y_rect_sampler",
     [NGLI_INFO_FIELD_UV_RECT_SAMPLER]   = "_uv_rect_sampler",
+    [NGLI_INFO_FIELD_U_SAMPLER]         = "_u_sampler",
+    [NGLI_INFO_FIELD_V_SAMPLER]         = "_v_sampler",
 };
 
 static const int texture_types_map[NGLI_PGCRAFT_SHADER_TEX_TYPE_NB][NGLI_INFO_FIELD_NB] = {
@@ -225,6 +227,8 @@ static const int texture_types_map[NGLI_PGCRAFT_SHADER_TEX_TYPE_NB][NGLI_INFO_FI
         [NGLI_INFO_FIELD_SAMPLING_MODE]     = NGLI_TYPE_INT,
         [NGLI_INFO_FIELD_Y_SAMPLER]         = NGLI_TYPE_SAMPLER_2D,
         [NGLI_INFO_FIELD_UV_SAMPLER]        = NGLI_TYPE_SAMPLER_2D,
+        [NGLI_INFO_FIELD_U_SAMPLER]         = NGLI_TYPE_SAMPLER_2D,
+        [NGLI_INFO_FIELD_V_SAMPLER]         = NGLI_TYPE_SAMPLER_2D,
         [NGLI_INFO_FIELD_COLOR_MATRIX]      = NGLI_TYPE_MAT4,
 #elif defined(TARGET_DARWIN)
         [NGLI_INFO_FIELD_SAMPLING_MODE]     = NGLI_TYPE_INT,
@@ -698,8 +702,17 @@ static int handle_token(struct pgcraft *s, const struct token *token, const char
                          ARG_FMT(arg0),
                          ARG_FMT(arg0), ARG_FMT(coords),
                          ARG_FMT(arg0), ARG_FMT(coords), s->rg);
-        if (!fast_picking)
+        if (!fast_picking) {
+            ngli_bstr_printf(dst, " : %.*s_sampling_mode == 5 ? ", ARG_FMT(arg0));
+            ngli_bstr_printf(dst, "%.*s_color_matrix * vec4(ngl_tex2d(%.*s_y_sampler, %.*s).r, "
+                                                           "ngl_tex2d(%.*s_u_sampler, %.*s).r, "
+                                                           "ngl_tex2d(%.*s_v_sampler, %.*s).r, 1.0)",
+                             ARG_FMT(arg0),
+                             ARG_FMT(arg0), ARG_FMT(coords),
+                             ARG_FMT(arg0), ARG_FMT(coords),
+                             ARG_FMT(arg0), ARG_FMT(coords));
             ngli_bstr_printf(dst, " : ngl_tex2d(%.*s, %.*s)", ARG_FMT(arg0), ARG_FMT(coords));
+        }
 #elif defined(TARGET_DARWIN)
         if (!fast_picking)
             ngli_bstr_printf(dst, "%.*s_sampling_mode == 4 ? ", ARG_FMT(arg0));
@@ -101,6 +101,8 @@ enum {
     NGLI_INFO_FIELD_UV_SAMPLER,
     NGLI_INFO_FIELD_Y_RECT_SAMPLER,
     NGLI_INFO_FIELD_UV_RECT_SAMPLER,
+    NGLI_INFO_FIELD_U_SAMPLER,
+    NGLI_INFO_FIELD_V_SAMPLER,
     NGLI_INFO_FIELD_NB
 };
 
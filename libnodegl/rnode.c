@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "nodegl.h"
 #include "rnode.h"
 
 void ngli_rnode_init(struct rnode *s)
@@ -53,3 +54,40 @@ struct rnode *ngli_rnode_add_child(struct rnode *s)
     child->rendertarget_desc = s->rendertarget_desc;
     return child;
 }
+
+static int find_path(const struct rnode *cur, const struct rnode *s, struct darray *path)
+{
+    if (cur == s)
+        return 1;
+
+    const struct rnode *children = ngli_darray_data(&cur->children);
+    for (int i = 0; i < ngli_darray_count(&cur->children); i++) {
+        if (!ngli_darray_push(path, &i))
+            return NGL_ERROR_MEMORY;
+        int ret = find_path(&children[i], s, path);
+        if (ret)
+            return ret;
+        ngli_darray_pop(path);
+    }
+    return 0;
+}
+
+int ngli_rnode_get_path(const struct rnode *root, const struct rnode *s, struct darray *path)
+{
+    int ret = find_path(root, s, path);
+    if (ret < 0)
+        return ret;
+    return ret ? 0 : NGL_ERROR_NOT_FOUND;
+}
+
+struct rnode *ngli_rnode_get_from_path(struct rnode *root, const int *path, int depth)
+{
+    struct rnode *s = root;
+    for (int i = 0; i < depth; i++) {
+        if (path[i] >= ngli_darray_count(&s->children))
+            return NULL;
+        struct rnode *children = ngli_darray_data(&s->children);
+        s = &children[path[i]];
+    }
+    return s;
+}
@@ -38,4 +38,12 @@ void ngli_rnode_clear(struct rnode *s);
 void ngli_rnode_reset(struct rnode *s);
 struct rnode *ngli_rnode_add_child(struct rnode *s);
 
+/*
+ * Render nodes are stored by value and move when their parent grows, so a
+ * position in the tree can only be kept as the list of child indexes leading
+ * to it from the root.
+ */
+int ngli_rnode_get_path(const struct rnode *root, const struct rnode *s, struct darray *path);
+struct rnode *ngli_rnode_get_from_path(struct rnode *root, const int *path, int depth);
+
 #endif
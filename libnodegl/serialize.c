@@ -24,6 +24,7 @@
 
 #include "bstr.h"
 #include "darray.h"
+#include "hexfloat.h"
 #include "hmap.h"
 #include "log.h"
 #include "memory.h"
@@ -67,21 +68,38 @@ static int get_rel_node_id(const struct hmap *nlist, const struct ngl_node *node
     return ngli_hmap_count(nlist) - get_node_id(nlist, node);
 }
 
-#define DECLARE_FLT_PRINT_FUNC(type, nbit, shift_exp, z)                \
-static void print_##type(struct bstr *b, type f)                        \
+static void print_double(struct bstr *b, double v)
+{
+    char buf[NGLI_HEXFLOAT_F64_MAX_LEN + 1];
+    const int len = ngli_hexfloat_write_f64(buf, v);
+    buf[len] = 0;
+    ngli_bstr_print(b, buf);
+}
+
+#define PRINT_CHUNK_SIZE 256
+
+/*
+ * Lists of floating point numbers are encoded by chunks into a local buffer,
+ * which is much faster than formatting them one by one with
+ * ngli_bstr_printf().
+ */
+#define DECLARE_FLT_PRINT_FUNC(type, name, max_len)                     \
+static void print_##type##s(struct bstr *b, int n, const type *v)       \
 {                                                                       \
-    const union { uint##nbit##_t i; type f; } u = {.f = f};             \
-    const uint##nbit##_t v = u.i;                                       \
-    const int sign = v >> (nbit - 1);                                   \
-    const uint##nbit##_t exp_mask = (1 << (nbit - shift_exp - 1)) - 1;  \
-    const uint##nbit##_t exp  = v >> shift_exp & exp_mask;              \
-    const uint##nbit##_t mant = v & ((1ULL << shift_exp) - 1);          \
-    ngli_bstr_printf(b, "%s%" PRIX##nbit "%c%" PRIX##nbit,              \
-                    sign ? "-" : "", exp, z, mant);                     \
-}                                                                       \
-
-DECLARE_FLT_PRINT_FUNC(float,  32, 23, 'z')
-DECLARE_FLT_PRINT_FUNC(double, 64, 52, 'Z')
+    char buf[PRINT_CHUNK_SIZE * (max_len + 1) + 1];                     \
+    for (int i = 0; i < n; i += PRINT_CHUNK_SIZE) {                     \
+        const int nb = NGLI_MIN(n - i, PRINT_CHUNK_SIZE);               \
+        int len = 0;                                                    \
+        if (i)                                                          \
+            buf[len++] = ',';                                           \
+        len += ngli_hexfloat_write_##name##s(buf + len, v + i, nb);     \
+        buf[len] = 0;                                                   \
+        ngli_bstr_print(b, buf);                                        \
+    }                                                                   \
+}
+
+DECLARE_FLT_PRINT_FUNC(float,  f32, NGLI_HEXFLOAT_F32_MAX_LEN)
+DECLARE_FLT_PRINT_FUNC(double, f64, NGLI_HEXFLOAT_F64_MAX_LEN)
 
 #define print_int(b, v)      ngli_bstr_printf(b, "%d", v)
 #define print_unsigned(b, v) ngli_bstr_printf(b, "%u", v)
@@ -95,8 +113,6 @@ static void print_##type##s(struct bstr *b, int n, const type *v)       \
     }                                                                   \
 }
 
-DECLARE_PRINT_FUNC(float)
-DECLARE_PRINT_FUNC(double)
 DECLARE_PRINT_FUNC(int)
 DECLARE_PRINT_FUNC(unsigned)
 
@@ -0,0 +1,474 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "darray.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodes.h"
+#include "nodegl.h"
+#include "serialize_bin.h"
+#include "utils.h"
+
+extern const struct node_param ngli_base_node_params[];
+
+struct bin_buffer {
+    uint8_t *data;
+    size_t size;
+    size_t cap;
+    int error;
+};
+
+struct serializer {
+    struct hmap *nlist;
+    struct bin_buffer nodes;
+    struct bin_buffer data;
+    uint32_t nb_nodes;
+};
+
+static void buf_write(struct bin_buffer *b, const void *data, size_t size)
+{
+    if (b->error || !size)
+        return;
+    if (size > b->cap - b->size) {
+        const size_t cap = NGLI_MAX(b->cap * 2, b->size + size);
+        uint8_t *ptr = ngli_realloc(b->data, cap);
+        if (!ptr) {
+            b->error = NGL_ERROR_MEMORY;
+            return;
+        }
+        b->data = ptr;
+        b->cap = cap;
+    }
+    if (data)
+        memcpy(b->data + b->size, data, size);
+    else
+        memset(b->data + b->size, 0, size);
+    b->size += size;
+}
+
+static void buf_pad(struct bin_buffer *b, size_t align)
+{
+    buf_write(b, NULL, NGLI_ALIGN(b->size, align) - b->size);
+}
+
+static void buf_write_u32(struct bin_buffer *b, uint32_t v)
+{
+    buf_write(b, &v, sizeof(v));
+}
+
+static void buf_patch_u32(struct bin_buffer *b, size_t pos, uint32_t v)
+{
+    if (!b->error)
+        memcpy(b->data + pos, &v, sizeof(v));
+}
+
+static void buf_write_str(struct bin_buffer *b, const char *s)
+{
+    buf_write(b, s, strlen(s) + 1);
+    buf_pad(b, 4);
+}
+
+static int register_node(struct serializer *s, const struct ngl_node *node)
+{
+    char key[32];
+    int ret = snprintf(key, sizeof(key), "%p", node);
+    if (ret < 0)
+        return ret;
+    /* The index is offset by one so it can not be confused with NULL */
+    ret = ngli_hmap_set(s->nlist, key, (void *)(uintptr_t)(s->nb_nodes + 1));
+    if (ret < 0)
+        return ret;
+    s->nb_nodes++;
+    return 0;
+}
+
+static int get_node_id(const struct serializer *s, const struct ngl_node *node)
+{
+    char key[32];
+    (void)snprintf(key, sizeof(key), "%p", node);
+    const uintptr_t val = (uintptr_t)ngli_hmap_get(s->nlist, key);
+    return (int)val - 1;
+}
+
+struct item {
+    const char *key;
+    void *data;
+};
+
+static int cmp_item(const void *p1, const void *p2)
+{
+    const struct item *i1 = p1;
+    const struct item *i2 = p2;
+    return strcmp(i1->key, i2->key);
+}
+
+static int hmap_to_sorted_items(struct darray *items_array, struct hmap *hm)
+{
+    ngli_darray_init(items_array, sizeof(struct item), 0);
+
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(hm, entry))) {
+        struct item item = {.key = entry->key, .data = entry->data};
+        if (!ngli_darray_push(items_array, &item)) {
+            ngli_darray_reset(items_array);
+            return NGL_ERROR_MEMORY;
+        }
+    }
+
+    void *items = ngli_darray_data(items_array);
+    const int nb_items = ngli_darray_count(items_array);
+    qsort(items, nb_items, sizeof(struct item), cmp_item);
+
+    return 0;
+}
+
+struct param_pos {
+    size_t size_pos;
+    size_t payload_pos;
+};
+
+static struct param_pos begin_param(struct serializer *s, const struct node_param *p)
+{
+    struct bin_buffer *b = &s->nodes;
+    struct param_pos pos = {0};
+    buf_write_u32(b, p->type);
+    buf_write_u32(b, strlen(p->key) + 1);
+    pos.size_pos = b->size;
+    buf_write_u32(b, 0);
+    buf_write_str(b, p->key);
+    pos.payload_pos = b->size;
+    return pos;
+}
+
+static void end_param(struct serializer *s, struct param_pos pos, int *nb_params)
+{
+    struct bin_buffer *b = &s->nodes;
+    buf_pad(b, 4);
+    buf_patch_u32(b, pos.size_pos, b->size - pos.payload_pos);
+    (*nb_params)++;
+}
+
+static void write_param(struct serializer *s, const struct node_param *p,
+                        const void *data, size_t size, int *nb_params)
+{
+    const struct param_pos pos = begin_param(s, p);
+    buf_write(&s->nodes, data, size);
+    end_param(s, pos, nb_params);
+}
+
+static void write_blob_param(struct serializer *s, const struct node_param *p,
+                             const void *data, size_t size, int *nb_params)
+{
+    buf_pad(&s->data, NGLI_BIN_DATA_ALIGN);
+    const uint64_t blob[2] = {s->data.size, size};
+    buf_write(&s->data, data, size);
+    write_param(s, p, blob, sizeof(blob), nb_params);
+}
+
+static int serialize_options(struct serializer *s,
+                             const struct ngl_node *node,
+                             uint8_t *priv,
+                             const struct node_param *p,
+                             int *nb_params)
+{
+    while (p && p->key) {
+        const uint8_t *srcp = priv + p->offset;
+        switch (p->type) {
+            case PARAM_TYPE_SELECT: {
+                const int v = *(int *)srcp;
+                const char *str = ngli_params_get_select_str(p->choices->consts, v);
+                ngli_assert(str);
+                if (v != p->def_value.i64)
+                    write_param(s, p, str, strlen(str) + 1, nb_params);
+                break;
+            }
+            case PARAM_TYPE_FLAGS: {
+                const int v = *(int *)srcp;
+                if (v == p->def_value.i64)
+                    break;
+                char *str = ngli_params_get_flags_str(p->choices->consts, v);
+                if (!str) {
+                    LOG(ERROR, "unable to allocate param flags string");
+                    return NGL_ERROR_MEMORY;
+                }
+                write_param(s, p, str, strlen(str) + 1, nb_params);
+                ngli_free(str);
+                break;
+            }
+            case PARAM_TYPE_BOOL:
+            case PARAM_TYPE_INT:
+            case PARAM_TYPE_UINT: {
+                const int v = *(int *)srcp;
+                if (v != p->def_value.i64)
+                    write_param(s, p, &v, sizeof(v), nb_params);
+                break;
+            }
+            case PARAM_TYPE_I64: {
+                const int64_t v = *(int64_t *)srcp;
+                if (v != p->def_value.i64)
+                    write_param(s, p, &v, sizeof(v), nb_params);
+                break;
+            }
+            case PARAM_TYPE_DBL: {
+                const double v = *(double *)srcp;
+                if (v != p->def_value.dbl)
+                    write_param(s, p, &v, sizeof(v), nb_params);
+                break;
+            }
+            case PARAM_TYPE_RATIONAL: {
+                if (memcmp(srcp, p->def_value.r, sizeof(p->def_value.r)))
+                    write_param(s, p, srcp, sizeof(p->def_value.r), nb_params);
+                break;
+            }
+            case PARAM_TYPE_STR: {
+                const char *str = *(char **)srcp;
+                if (!str || (p->def_value.str && !strcmp(str, p->def_value.str)))
+                    break;
+                if (!strcmp(p->key, "label") &&
+                    ngli_is_default_label(node->class->name, str))
+                    break;
+                write_param(s, p, str, strlen(str) + 1, nb_params);
+                break;
+            }
+            case PARAM_TYPE_DATA: {
+                const uint8_t *data = *(uint8_t **)srcp;
+                const int size = *(int *)(srcp + sizeof(uint8_t *));
+                if (data && size)
+                    write_blob_param(s, p, data, size, nb_params);
+                break;
+            }
+            case PARAM_TYPE_IVEC2:
+            case PARAM_TYPE_IVEC3:
+            case PARAM_TYPE_IVEC4: {
+                const size_t size = (p->type - PARAM_TYPE_IVEC2 + 2) * sizeof(int);
+                if (memcmp(srcp, p->def_value.ivec, size))
+                    write_param(s, p, srcp, size, nb_params);
+                break;
+            }
+            case PARAM_TYPE_UIVEC2:
+            case PARAM_TYPE_UIVEC3:
+            case PARAM_TYPE_UIVEC4: {
+                const size_t size = (p->type - PARAM_TYPE_UIVEC2 + 2) * sizeof(unsigned);
+                if (memcmp(srcp, p->def_value.uvec, size))
+                    write_param(s, p, srcp, size, nb_params);
+                break;
+            }
+            case PARAM_TYPE_VEC2:
+            case PARAM_TYPE_VEC3:
+            case PARAM_TYPE_VEC4: {
+                const size_t size = (p->type - PARAM_TYPE_VEC2 + 2) * sizeof(float);
+                if (memcmp(srcp, p->def_value.vec, size))
+                    write_param(s, p, srcp, size, nb_params);
+                break;
+            }
+            case PARAM_TYPE_MAT4: {
+                const size_t size = 16 * sizeof(float);
+                if (memcmp(srcp, p->def_value.mat, size))
+                    write_param(s, p, srcp, size, nb_params);
+                break;
+            }
+            case PARAM_TYPE_NODE: {
+                const struct ngl_node *child = *(struct ngl_node **)srcp;
+                if (!child)
+                    break;
+                const uint32_t node_id = get_node_id(s, child);
+                write_param(s, p, &node_id, sizeof(node_id), nb_params);
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **children = *(struct ngl_node ***)srcp;
+                const int nb_children = *(int *)(srcp + sizeof(struct ngl_node **));
+                if (!nb_children)
+                    break;
+                const struct param_pos pos = begin_param(s, p);
+                for (int i = 0; i < nb_children; i++)
+                    buf_write_u32(&s->nodes, get_node_id(s, children[i]));
+                end_param(s, pos, nb_params);
+                break;
+            }
+            case PARAM_TYPE_DBLLIST: {
+                const double *elems = *(double **)srcp;
+                const int nb_elems = *(int *)(srcp + sizeof(double *));
+                if (nb_elems)
+                    write_blob_param(s, p, elems, nb_elems * sizeof(*elems), nb_params);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)srcp;
+                const int nb_children = hmap ? ngli_hmap_count(hmap) : 0;
+                if (!nb_children)
+                    break;
+
+                struct darray items_array;
+                int ret = hmap_to_sorted_items(&items_array, hmap);
+                if (ret < 0)
+                    return ret;
+                const struct param_pos pos = begin_param(s, p);
+                buf_write_u32(&s->nodes, nb_children);
+                const struct item *items = ngli_darray_data(&items_array);
+                for (int i = 0; i < ngli_darray_count(&items_array); i++) {
+                    const struct item *item = &items[i];
+                    buf_write_u32(&s->nodes, get_node_id(s, item->data));
+                    buf_write_str(&s->nodes, item->key);
+                }
+                end_param(s, pos, nb_params);
+                ngli_darray_reset(&items_array);
+                break;
+            }
+            default:
+                LOG(ERROR, "cannot serialize %s: unsupported parameter type", p->key);
+                return NGL_ERROR_BUG;
+        }
+        p++;
+    }
+    return 0;
+}
+
+static int serialize(struct serializer *s, const struct ngl_node *node);
+
+static int serialize_children(struct serializer *s,
+                              uint8_t *priv,
+                              const struct node_param *p)
+{
+    while (p && p->key) {
+        switch (p->type) {
+            case PARAM_TYPE_NODE: {
+                const struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
+                if (child) {
+                    int ret = serialize(s, child);
+                    if (ret < 0)
+                        return ret;
+                }
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **children = *(struct ngl_node ***)(priv + p->offset);
+                const int nb_children = *(int *)(priv + p->offset + sizeof(struct ngl_node **));
+
+                for (int i = 0; i < nb_children; i++) {
+                    int ret = serialize(s, children[i]);
+                    if (ret < 0)
+                        return ret;
+                }
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(priv + p->offset);
+                if (!hmap)
+                    break;
+
+                struct darray items_array;
+                int ret = hmap_to_sorted_items(&items_array, hmap);
+                if (ret < 0)
+                    return ret;
+                const struct item *items = ngli_darray_data(&items_array);
+                for (int i = 0; i < ngli_darray_count(&items_array); i++) {
+                    const struct item *item = &items[i];
+                    int ret = serialize(s, item->data);
+                    if (ret < 0) {
+                        ngli_darray_reset(&items_array);
+                        return ret;
+                    }
+                }
+                ngli_darray_reset(&items_array);
+                break;
+            }
+        }
+        p++;
+    }
+    return 0;
+}
+
+static int serialize(struct serializer *s, const struct ngl_node *node)
+{
+    if (get_node_id(s, node) >= 0)
+        return 0;
+
+    int ret;
+
+    if ((ret = serialize_children(s, (uint8_t *)node, ngli_base_node_params)) < 0 ||
+        (ret = serialize_children(s, node->priv_data, node->class->params)) < 0)
+        return ret;
+
+    buf_write_u32(&s->nodes, node->class->id);
+    const size_t nb_params_pos = s->nodes.size;
+    buf_write_u32(&s->nodes, 0);
+
+    int nb_params = 0;
+    if ((ret = serialize_options(s, node, node->priv_data, node->class->params, &nb_params)) < 0 ||
+        (ret = serialize_options(s, node, (uint8_t *)node, ngli_base_node_params, &nb_params)) < 0)
+        return ret;
+    buf_patch_u32(&s->nodes, nb_params_pos, nb_params);
+
+    if (s->nodes.error < 0 || s->data.error < 0)
+        return NGL_ERROR_MEMORY;
+
+    return register_node(s, node);
+}
+
+void *ngl_node_serialize_bin(const struct ngl_node *node, size_t *sizep)
+{
+    uint8_t *ret = NULL;
+    struct serializer s = {.nlist = ngli_hmap_create()};
+    if (!s.nlist)
+        goto end;
+
+    if (serialize(&s, node) < 0)
+        goto end;
+
+    const size_t nodes_offset = NGLI_ALIGN(sizeof(struct bin_header), NGLI_BIN_DATA_ALIGN);
+    const size_t data_offset = NGLI_ALIGN(nodes_offset + s.nodes.size, NGLI_BIN_DATA_ALIGN);
+    const size_t size = data_offset + s.data.size;
+    ret = ngli_calloc(1, size);
+    if (!ret)
+        goto end;
+
+    struct bin_header header = {
+        .byte_order   = NGLI_BIN_BYTE_ORDER,
+        .version      = NGLI_BIN_VERSION,
+        .ngl_version  = NODEGL_VERSION_INT,
+        .nb_nodes     = s.nb_nodes,
+        .nodes_offset = nodes_offset,
+        .nodes_size   = s.nodes.size,
+        .data_offset  = data_offset,
+        .data_size    = s.data.size,
+    };
+    memcpy(header.magic, NGLI_BIN_MAGIC, sizeof(header.magic));
+
+    memcpy(ret, &header, sizeof(header));
+    if (s.nodes.size)
+        memcpy(ret + nodes_offset, s.nodes.data, s.nodes.size);
+    if (s.data.size)
+        memcpy(ret + data_offset, s.data.data, s.data.size);
+    *sizep = size;
+
+end:
+    ngli_hmap_freep(&s.nlist);
+    ngli_free(s.nodes.data);
+    ngli_free(s.data.data);
+    return ret;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SERIALIZE_BIN_H
+#define SERIALIZE_BIN_H
+
+#include <stdint.h>
+
+/*
+ * Binary scene layout (all fields in native byte order, the byte_order field
+ * is used to reject files written on a machine of different endianness):
+ *
+ *   header | node table | data section
+ *
+ * The node table contains the nodes in dependency order (children first),
+ * each node being:
+ *
+ *   u32 type, u32 nb_params, params...
+ *
+ * and each param:
+ *
+ *   u32 param type, u32 key size, u32 payload size,
+ *   key (nul terminated), payload
+ *
+ * with the key and the payload both padded to 4 bytes. Node references are
+ * u32 absolute indexes in the node table. Bulk payloads (PARAM_TYPE_DATA and
+ * PARAM_TYPE_DBLLIST) are stored in the data section and referenced by a u64
+ * offset and a u64 size in bytes; every blob is aligned on
+ * NGLI_BIN_DATA_ALIGN bytes from the start of the file so they can be used
+ * directly from a memory mapping of the file.
+ */
+
+#define NGLI_BIN_MAGIC "NGLB"
+#define NGLI_BIN_VERSION 1
+#define NGLI_BIN_BYTE_ORDER 0x01020304
+#define NGLI_BIN_DATA_ALIGN 16
+
+struct bin_header {
+    char magic[4];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t ngl_version;
+    uint32_t nb_nodes;
+    uint32_t reserved;
+    uint64_t nodes_offset;
+    uint64_t nodes_size;
+    uint64_t data_offset;
+    uint64_t data_size;
+};
+
+#endif
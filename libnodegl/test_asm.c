@@ -20,6 +20,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "utils.h"
@@ -99,5 +100,77 @@ int main(void)
         }
     }
 
+    if (ngli_mat4_mul_array_c != ngli_mat4_mul_array) {
+        static const int counts[] = {1, 2, 7};
+        for (int n = 0; n < NGLI_ARRAY_NB(counts); n++) {
+            const int count = counts[n];
+            printf(":: Testing mat4 mul array of %d\n", count);
+
+            float m_src[7 * 4*4];
+            float m_ref[7 * 4*4];
+            float m_out[7 * 4*4] = {0};
+            float m_diff[7 * 4*4];
+
+            for (int i = 0; i < count; i++)
+                memcpy(&m_src[i * 4*4], i & 1 ? m1 : m2, sizeof(m1));
+
+            ngli_mat4_mul_array_c(m_ref, m1, m_src, count);
+            ngli_mat4_mul_array(m_out, m1, m_src, count);
+            flt_diff(m_diff, m_ref, m_out, count * 4*4);
+            flt_check(m_diff, count * 4*4);
+        }
+    }
+
+    if (ngli_mat3_inverse_c != ngli_mat3_inverse) {
+        static const float m3s[][3*3] = {
+            { 0.73016f, 0.51184f, 0.20930f,
+             -9.42693f, 1.47287f, 0.34995f,
+              0.42603f,-1.50442f, 1.34210f},
+            { 2.00000f, 0.50000f, 0.10000f,
+             -0.30000f, 1.50000f, 0.20000f,
+              0.40000f,-0.60000f, 3.00000f},
+            { 1.00000f, 2.00000f, 3.00000f,
+              2.00000f, 4.00000f, 6.00000f,
+              0.50000f, 0.25000f, 1.00000f},
+        };
+        for (int i = 0; i < NGLI_ARRAY_NB(m3s); i++) {
+            printf(":: Testing mat3 inverse %d/%d\n", i + 1, NGLI_ARRAY_NB(m3s));
+
+            const float *m3 = m3s[i];
+            float m3_ref[3*3];
+            float m3_out[3*3] = {0};
+            float m3_diff[3*3];
+
+            ngli_mat3_inverse_c(m3_ref, m3);
+            ngli_mat3_inverse(m3_out, m3);
+            flt_diff(m3_diff, m3_ref, m3_out, 3*3);
+            flt_check(m3_diff, 3*3);
+        }
+    }
+
+    if (ngli_quat_slerp_c != ngli_quat_slerp) {
+        static const float quats[][4] = {
+            { 0.00000f, 0.00000f, 0.00000f, 1.00000f},
+            { 0.50000f, 0.50000f, 0.50000f, 0.50000f},
+            {-0.27060f, 0.65328f, 0.27060f, 0.65328f},
+            {-0.50010f,-0.49990f,-0.50000f,-0.50000f},
+        };
+        static const float ts[] = {0.f, 0.25f, 0.5f, 1.f};
+        for (int i = 0; i < NGLI_ARRAY_NB(quats) - 1; i++) {
+            for (int j = 0; j < NGLI_ARRAY_NB(ts); j++) {
+                printf(":: Testing quat slerp %d/%d t=%g\n", i + 1, NGLI_ARRAY_NB(quats) - 1, ts[j]);
+
+                NGLI_ALIGNED_VEC(q_ref);
+                NGLI_ALIGNED_VEC(q_out) = {0};
+                NGLI_ALIGNED_VEC(q_diff);
+
+                ngli_quat_slerp_c(q_ref, quats[i], quats[i + 1], ts[j]);
+                ngli_quat_slerp(q_out, quats[i], quats[i + 1], ts[j]);
+                flt_diff(q_diff, q_ref, q_out, 4);
+                flt_check(q_diff, 4);
+            }
+        }
+    }
+
     return 0;
 }
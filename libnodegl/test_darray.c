@@ -55,6 +55,18 @@ int main(void)
     count = ngli_darray_count(&darray);
     ngli_assert(count == 0);
 
+    for (int i = 0; i < 5; i++)
+        ngli_darray_push(&darray, &i);
+    ngli_darray_remove(&darray, 0);
+    ngli_darray_remove(&darray, 3);
+    ngli_darray_remove(&darray, 1);
+    count = ngli_darray_count(&darray);
+    ngli_assert(count == 2);
+    element = ngli_darray_get(&darray, 0);
+    ngli_assert(*element == 1);
+    element = ngli_darray_get(&darray, 1);
+    ngli_assert(*element == 3);
+
     ngli_darray_reset(&darray);
 
     return 0;
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "easinglut.h"
+#include "hmap.h"
+#include "nodegl.h"
+#include "utils.h"
+
+static const struct {
+    const char *name;
+    int nb_args;
+    double args[1];
+} easings[] = {
+    {"linear"},
+    {"quadratic_in"}, {"quadratic_out"}, {"quadratic_in_out"}, {"quadratic_out_in"},
+    {"cubic_in"},     {"cubic_out"},     {"cubic_in_out"},     {"cubic_out_in"},
+    {"quartic_in"},   {"quartic_out"},   {"quartic_in_out"},   {"quartic_out_in"},
+    {"quintic_in"},   {"quintic_out"},   {"quintic_in_out"},   {"quintic_out_in"},
+    {"power_in", 1, {7.3}}, {"power_out", 1, {7.3}}, {"power_in_out", 1, {7.3}}, {"power_out_in", 1, {7.3}},
+    {"sinus_in"},     {"sinus_out"},     {"sinus_in_out"},     {"sinus_out_in"},
+    {"exp_in"},       {"exp_out"},       {"exp_in_out"},       {"exp_out_in"},
+    {"circular_in"},  {"circular_out"},  {"circular_in_out"},  {"circular_out_in"},
+    {"bounce_in"},    {"bounce_out"},
+    {"elastic_in"},   {"elastic_out"},
+    {"back_in"},      {"back_out"},      {"back_in_out"},      {"back_out_in"},
+};
+
+#define NB_POINTS 10007
+
+/* Number of approximations kept by ngl_easing_evaluate_approx() */
+#define MAX_APPROX_CACHE_ENTRIES 64
+
+/*
+ * Check the approximation of the first easings against their exact evaluation
+ * on a grid that does not line up with the segments. Returns the number of
+ * approximations built.
+ */
+static int test_easings(int nb_easings, double tolerance, double *offsets)
+{
+    int nb_approx = 0;
+    for (int i = 0; i < nb_easings; i++) {
+        const char *name = easings[i].name;
+        double *args = (double *)easings[i].args;
+        const int nb_args = easings[i].nb_args;
+
+        double v;
+        int ret = ngl_easing_evaluate_approx(name, args, nb_args, offsets, tolerance, 0., &v);
+        if (ret == NGL_ERROR_LIMIT_EXCEEDED) {
+            /* Derivative discontinuities and infinite slopes may not converge */
+            printf("%-16s tolerance=%-6g not reachable\n", name, tolerance);
+            nb_approx++;
+            continue;
+        }
+        ngli_assert(ret == 0);
+        nb_approx++;
+
+        double error = 0.;
+        for (int j = 0; j <= NB_POINTS; j++) {
+            const double t = j / (double)NB_POINTS;
+            double approx, exact;
+            ngli_assert(ngl_easing_evaluate_approx(name, args, nb_args, offsets, tolerance, t, &approx) == 0);
+            ngli_assert(ngl_easing_evaluate(name, args, nb_args, offsets, t, &exact) == 0);
+            error = NGLI_MAX(error, fabs(approx - exact));
+
+            /* The boundaries are interpolated, up to the rounding errors */
+            if (j == 0 || j == NB_POINTS)
+                ngli_assert(fabs(approx - exact) < 1e-12);
+        }
+        printf("%-16s tolerance=%-6g error=%g\n", name, tolerance, error);
+        ngli_assert(error <= tolerance);
+    }
+    return nb_approx;
+}
+
+static double power(void *user_arg, double x)
+{
+    const double *exponent = user_arg;
+    return pow(x, *exponent);
+}
+
+static void test_cache(void)
+{
+    double exponent = 3.;
+    double sqrt_exponent = .5;
+    struct hmap *cache = ngli_easinglut_cache_create();
+    ngli_assert(cache);
+
+    const struct easinglut *lut0 = NULL, *lut1 = NULL, *lut2 = NULL;
+    ngli_assert(ngli_easinglut_cache_get(cache, "cubic", &lut0, power, &exponent, 1e-4) == 0);
+    ngli_assert(ngli_easinglut_cache_get(cache, "cubic", &lut1, power, &exponent, 1e-4) == 0);
+    ngli_assert(lut0 && lut0 == lut1);
+    ngli_assert(ngli_hmap_count(cache) == 1);
+
+    /* Unreachable approximations are shared as well, as NULL */
+    ngli_assert(ngli_easinglut_cache_get(cache, "sqrt", &lut2, power, &sqrt_exponent, 1e-6) == 0);
+    ngli_assert(!lut2);
+    ngli_assert(ngli_hmap_count(cache) == 2);
+
+    ngli_easinglut_cache_release(cache, "cubic");
+    ngli_assert(ngli_hmap_count(cache) == 2);
+    ngli_easinglut_cache_release(cache, "cubic");
+    ngli_easinglut_cache_release(cache, "sqrt");
+    ngli_assert(ngli_hmap_count(cache) == 0);
+
+    ngli_hmap_freep(&cache);
+}
+
+int main(void)
+{
+    double offsets[] = {0.3, 0.7};
+    const int nb_easings = NGLI_ARRAY_NB(easings);
+    int nb_approx = test_easings(nb_easings, 1e-4, NULL);
+    nb_approx += test_easings(16, 1e-3, offsets);
+    nb_approx += test_easings(MAX_APPROX_CACHE_ENTRIES - nb_approx, 1e-2, NULL);
+    ngli_assert(nb_approx == MAX_APPROX_CACHE_ENTRIES);
+
+    /* Past the kept approximations, the easings are evaluated exactly */
+    for (int i = 0; i < nb_easings; i++) {
+        double *args = (double *)easings[i].args;
+        for (int j = 0; j <= 16; j++) {
+            const double t = j / 16.;
+            double approx, exact;
+            ngli_assert(ngl_easing_evaluate_approx(easings[i].name, args, easings[i].nb_args, NULL, 1e-6, t, &approx) == 0);
+            ngli_assert(ngl_easing_evaluate(easings[i].name, args, easings[i].nb_args, NULL, t, &exact) == 0);
+            ngli_assert(approx == exact);
+        }
+    }
+
+    double v;
+    ngli_assert(ngl_easing_evaluate_approx("cubic_in", NULL, 0, NULL, 0., 0.5, &v) == NGL_ERROR_INVALID_ARG);
+    ngli_assert(ngl_easing_evaluate_approx("unknown", NULL, 0, NULL, 1e-4, 0.5, &v) < 0);
+
+    test_cache();
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hexfloat.h"
+#include "memory.h"
+#include "utils.h"
+
+#define NB_RANDOM_VALUES (1 << 20)
+
+/* Reference implementation of the format, with the standard printf */
+#define DECLARE_REF_FUNC(name, type, nbit, shift_exp, z)                    \
+static int ref_write_##name(char *dst, size_t size, type f)                 \
+{                                                                           \
+    const union { uint##nbit##_t i; type f; } u = {.f = f};                 \
+    const uint##nbit##_t exp_mask = (1 << (nbit - shift_exp - 1)) - 1;      \
+    return snprintf(dst, size, "%s%" PRIX##nbit "%c%" PRIX##nbit,           \
+                    u.i >> (nbit - 1) ? "-" : "",                           \
+                    u.i >> shift_exp & exp_mask, z,                         \
+                    (uint##nbit##_t)(u.i & ((1ULL << shift_exp) - 1)));     \
+}
+
+DECLARE_REF_FUNC(f32, float,  32, 23, 'z')
+DECLARE_REF_FUNC(f64, double, 64, 52, 'Z')
+
+static uint64_t rand_state = 0x2545f4914f6cdd1d;
+
+static uint64_t get_rand(void)
+{
+    /* xorshift64 */
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 7;
+    rand_state ^= rand_state << 17;
+    return rand_state;
+}
+
+/* Encode, compare with the reference, decode and compare the bits */
+#define DECLARE_CHECK_FUNC(name, type, nbit)                                \
+static void check_##name(uint##nbit##_t bits)                               \
+{                                                                           \
+    const union { uint##nbit##_t i; type f; } u = {.i = bits};              \
+    char ref[64], buf[64];                                                  \
+    const int ref_len = ref_write_##name(ref, sizeof(ref), u.f);            \
+    const int len = ngli_hexfloat_write_##name(buf, u.f);                   \
+    ngli_assert(len == ref_len);                                            \
+    ngli_assert(len <= NGLI_HEXFLOAT_##nbit##_MAX_LEN);                     \
+    ngli_assert(!memcmp(buf, ref, len));                                    \
+                                                                            \
+    buf[len] = 0;                                                           \
+    union { uint##nbit##_t i; type f; } r;                                  \
+    ngli_assert(ngli_hexfloat_read_##name(buf, &r.f) == len);               \
+    ngli_assert(r.i == bits);                                               \
+}
+
+#define NGLI_HEXFLOAT_32_MAX_LEN NGLI_HEXFLOAT_F32_MAX_LEN
+#define NGLI_HEXFLOAT_64_MAX_LEN NGLI_HEXFLOAT_F64_MAX_LEN
+
+DECLARE_CHECK_FUNC(f32, float,  32)
+DECLARE_CHECK_FUNC(f64, double, 64)
+
+static void test_values(void)
+{
+    static const uint32_t special_f32[] = {
+        0x00000000, 0x80000000, /* +0, -0 */
+        0x00000001, 0x807fffff, /* denormals */
+        0x3f800000, 0xbf800000, /* 1, -1 */
+        0x7f7fffff, 0xff7fffff, /* max, -max */
+        0x7f800000, 0xff800000, /* inf, -inf */
+        0x7fc00000, 0xffffffff, /* nan */
+    };
+    static const uint64_t special_f64[] = {
+        0x0000000000000000, 0x8000000000000000,
+        0x0000000000000001, 0x800fffffffffffff,
+        0x3ff0000000000000, 0xbff0000000000000,
+        0x7fefffffffffffff, 0xffefffffffffffff,
+        0x7ff0000000000000, 0xfff0000000000000,
+        0x7ff8000000000000, 0xffffffffffffffff,
+    };
+
+    for (int i = 0; i < NGLI_ARRAY_NB(special_f32); i++)
+        check_f32(special_f32[i]);
+    for (int i = 0; i < NGLI_ARRAY_NB(special_f64); i++)
+        check_f64(special_f64[i]);
+
+    for (int i = 0; i < NB_RANDOM_VALUES; i++) {
+        const uint64_t r = get_rand();
+        /* Random bits and random mantissa sizes */
+        check_f32((uint32_t)r);
+        check_f32((uint32_t)r & ~((1U << (r >> 59)) - 1));
+        check_f64(r);
+        check_f64(r & ~((1ULL << (r >> 58)) - 1));
+    }
+}
+
+static void test_lists(void)
+{
+    const int n = 1000;
+    float *f = ngli_calloc(n, sizeof(*f));
+    float *f2 = ngli_calloc(n, sizeof(*f2));
+    char *buf = ngli_calloc(n, NGLI_HEXFLOAT_F32_MAX_LEN + 1);
+    char *ref = ngli_calloc(n, NGLI_HEXFLOAT_F32_MAX_LEN + 1);
+    ngli_assert(f && f2 && buf && ref);
+
+    int ref_len = 0;
+    for (int i = 0; i < n; i++) {
+        const union { uint32_t i; float f; } u = {.i = (uint32_t)get_rand()};
+        f[i] = u.f;
+        if (i)
+            ref[ref_len++] = ',';
+        ref_len += ref_write_f32(ref + ref_len, NGLI_HEXFLOAT_F32_MAX_LEN + 1, f[i]);
+    }
+
+    const int len = ngli_hexfloat_write_f32s(buf, f, n);
+    ngli_assert(len == ref_len);
+    ngli_assert(!memcmp(buf, ref, len));
+    buf[len] = 0;
+
+    int nb_vals = 0;
+    ngli_assert(ngli_hexfloat_read_f32s(buf, f2, n, &nb_vals) == len);
+    ngli_assert(nb_vals == n);
+    ngli_assert(!memcmp(f, f2, n * sizeof(*f)));
+
+    /* The list must not overflow the destination */
+    ngli_assert(ngli_hexfloat_read_f32s(buf, f2, n - 1, &nb_vals) < 0);
+
+    /* Parsing stops at the first character which is not a separator */
+    double d[2];
+    ngli_assert(ngli_hexfloat_read_f64s("3FFZ0,-400Z8000000000000 7FFZ0", d, 2, &nb_vals) == 24);
+    ngli_assert(nb_vals == 2 && d[0] == 1.0 && d[1] == -3.0);
+
+    ngli_free(ref);
+    ngli_free(buf);
+    ngli_free(f2);
+    ngli_free(f);
+}
+
+static void test_invalid(void)
+{
+    static const char *invalid_f32[] = {
+        "", "-", "z", "7F", "7Fz", "z0", "7FZ0", "7F,0", "-z1",
+        "7Fz123456789", "123456789z0", "g7Fz0",
+        /* Fields overflowing into the exponent or the sign */
+        "100z0", "7Fz800000", "7Fz1000000", "FFFFFFFFz0", "0zFFFFFFFF",
+    };
+    static const char *invalid_f64[] = {
+        "800Z0", "1000Z0", "3FFZ10000000000000", "3FFZ20000000000000",
+        "FFFFFFFFFFFFFFFFZ0", "0ZFFFFFFFFFFFFFFFF",
+    };
+
+    for (int i = 0; i < NGLI_ARRAY_NB(invalid_f32); i++) {
+        float f;
+        ngli_assert(ngli_hexfloat_read_f32(invalid_f32[i], &f) < 0);
+    }
+    for (int i = 0; i < NGLI_ARRAY_NB(invalid_f64); i++) {
+        double d;
+        ngli_assert(ngli_hexfloat_read_f64(invalid_f64[i], &d) < 0);
+    }
+
+    /* Largest fields */
+    double d;
+    ngli_assert(ngli_hexfloat_read_f64("-7FFZFFFFFFFFFFFFF", &d) == 18);
+
+    /* Lower case digits are accepted */
+    float f;
+    ngli_assert(ngli_hexfloat_read_f32("7fz4ccccd", &f) == 9);
+    ngli_assert(f == 1.6f);
+}
+
+static void test_throughput(void)
+{
+    const int n = NB_RANDOM_VALUES;
+    float *f = ngli_calloc(n, sizeof(*f));
+    char *buf = ngli_calloc(n, NGLI_HEXFLOAT_F32_MAX_LEN + 1);
+    ngli_assert(f && buf);
+    for (int i = 0; i < n; i++)
+        f[i] = (float)(int32_t)get_rand() / (1 << 20);
+
+    int64_t t0 = ngli_gettime_relative();
+    int ref_len = 0;
+    for (int i = 0; i < n; i++) {
+        if (i)
+            buf[ref_len++] = ',';
+        ref_len += ref_write_f32(buf + ref_len, NGLI_HEXFLOAT_F32_MAX_LEN + 1, f[i]);
+    }
+    const int64_t ref_time = ngli_gettime_relative() - t0;
+
+    t0 = ngli_gettime_relative();
+    const int len = ngli_hexfloat_write_f32s(buf, f, n);
+    const int64_t write_time = ngli_gettime_relative() - t0;
+    ngli_assert(len == ref_len);
+    buf[len] = 0;
+
+    t0 = ngli_gettime_relative();
+    int nb_vals;
+    ngli_assert(ngli_hexfloat_read_f32s(buf, f, n, &nb_vals) == len);
+    const int64_t read_time = ngli_gettime_relative() - t0;
+
+    const double mb = len / (1024. * 1024.);
+    printf("encode: %.1fMB/s (printf: %.1fMB/s), decode: %.1fMB/s\n",
+           mb * 1000000. / NGLI_MAX(write_time, 1),
+           mb * 1000000. / NGLI_MAX(ref_time, 1),
+           mb * 1000000. / NGLI_MAX(read_time, 1));
+
+    ngli_free(buf);
+    ngli_free(f);
+}
+
+int main(void)
+{
+    test_values();
+    test_lists();
+    test_invalid();
+    test_throughput();
+    return 0;
+}
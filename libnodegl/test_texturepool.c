@@ -0,0 +1,150 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <string.h>
+
+#include "format.h"
+#include "gctx.h"
+#include "memory.h"
+#include "texturepool.h"
+#include "utils.h"
+
+/* Texture backend only keeping track of the textures it allocated */
+static int nb_live_textures;
+static int nb_created_textures;
+
+static struct texture *texture_create(struct gctx *gctx)
+{
+    struct texture *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->gctx = gctx;
+    nb_live_textures++;
+    nb_created_textures++;
+    return s;
+}
+
+static int texture_init(struct texture *s, const struct texture_params *params)
+{
+    s->params = *params;
+    return 0;
+}
+
+static void texture_freep(struct texture **sp)
+{
+    ngli_freep(sp);
+    nb_live_textures--;
+}
+
+static const struct gctx_class test_gctx_class = {
+    .texture_create = texture_create,
+    .texture_init   = texture_init,
+    .texture_freep  = texture_freep,
+};
+
+static struct texture *get_texture(struct texturepool *pool, const struct texture_params *params)
+{
+    struct texture *texture = NULL;
+    int ret = ngli_texturepool_get_texture(pool, &texture, params);
+    ngli_assert(ret == 0 && texture);
+    ngli_assert(!memcmp(&texture->params, params, sizeof(*params)));
+    return texture;
+}
+
+int main(void)
+{
+    struct gctx gctx = {.class = &test_gctx_class};
+    const struct texture_params params = {
+        .type   = NGLI_TEXTURE_TYPE_2D,
+        .format = NGLI_FORMAT_R8G8B8A8_UNORM,
+        .width  = 16,
+        .height = 16,
+        .depth  = 1,
+    };
+    struct texture_params other_params = params;
+    other_params.width = 8;
+    const int64_t size = 16 * 16 * 4;
+
+    /* Disabled pool: the released textures are destroyed */
+    struct texturepool pool = {0};
+    ngli_texturepool_init(&pool, &gctx, 0);
+    struct texture *t0 = get_texture(&pool, &params);
+    ngli_texturepool_release_texture(&pool, &t0);
+    ngli_assert(!t0);
+    ngli_assert(nb_live_textures == 0);
+    ngli_texturepool_reset(&pool);
+
+    /* A released texture is recycled by the next request with the same parameters */
+    ngli_texturepool_init(&pool, &gctx, 2 * size);
+    nb_created_textures = 0;
+    t0 = get_texture(&pool, &params);
+    struct texture *t1 = get_texture(&pool, &params);
+    ngli_assert(t0 != t1);
+    struct texture *released = t0;
+    ngli_texturepool_release_texture(&pool, &t0);
+    ngli_assert(!t0);
+    ngli_assert(nb_live_textures == 2);
+    ngli_assert(pool.size == size);
+
+    /* ... but not by a request with different parameters */
+    struct texture *t2 = get_texture(&pool, &other_params);
+    ngli_assert(t2 != released);
+    ngli_assert(nb_created_textures == 3);
+
+    t0 = get_texture(&pool, &params);
+    ngli_assert(t0 == released);
+    ngli_assert(nb_created_textures == 3);
+    ngli_assert(pool.size == 0);
+
+    /* The recycled texture left the pool: it is not handed out twice */
+    struct texture *t3 = get_texture(&pool, &params);
+    ngli_assert(t3 != t0 && t3 != t1);
+    ngli_assert(nb_created_textures == 4);
+
+    /* The least recently released textures are evicted to honor the budget */
+    struct texture *kept0 = t1;
+    struct texture *kept1 = t3;
+    ngli_texturepool_release_texture(&pool, &t0);
+    ngli_texturepool_release_texture(&pool, &t1);
+    ngli_texturepool_release_texture(&pool, &t3);
+    ngli_assert(pool.size == 2 * size);
+    ngli_assert(nb_live_textures == 3);
+
+    /* The most recently released textures are recycled first */
+    struct texture *t4 = get_texture(&pool, &params);
+    struct texture *t5 = get_texture(&pool, &params);
+    ngli_assert(t4 == kept1 && t5 == kept0);
+    ngli_assert(pool.size == 0);
+    struct texture *t6 = get_texture(&pool, &params);
+    ngli_assert(nb_created_textures == 5);
+
+    /* Resetting the pool destroys the pooled textures */
+    ngli_texturepool_release_texture(&pool, &t2);
+    ngli_texturepool_release_texture(&pool, &t4);
+    ngli_texturepool_reset(&pool);
+    ngli_assert(nb_live_textures == 2);
+    ngli_texture_freep(&t5);
+    ngli_texture_freep(&t6);
+    ngli_assert(nb_live_textures == 0);
+
+    return 0;
+}
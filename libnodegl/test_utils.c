@@ -29,6 +29,30 @@ static void test_numbered_line(uint32_t crc, const char *s)
     ngli_freep(&p);
 }
 
+static inline int get_key(const int *keys, int i)
+{
+    return keys[i];
+}
+
+NGLI_DEFINE_MONOTONIC_SEARCH_FUNC(search_key, const int *, int, get_key)
+
+static int search_key_ref(const int *keys, int nb_keys, int t)
+{
+    int ret = -1;
+    for (int i = 0; i < nb_keys && keys[i] <= t; i++)
+        ret = i;
+    return ret;
+}
+
+static void test_monotonic_search(void)
+{
+    static const int keys[] = {-5, -5, 0, 1, 1, 1, 3, 7, 8, 13, 21, 21, 34, 55, 89, 144, 233};
+    for (int nb_keys = 0; nb_keys <= NGLI_ARRAY_NB(keys); nb_keys++)
+        for (int hint = -1; hint <= nb_keys; hint++)
+            for (int t = -7; t < 240; t++)
+                ngli_assert(search_key(keys, nb_keys, hint, t) == search_key_ref(keys, nb_keys, t));
+}
+
 int main(void)
 {
     ngli_assert(ngli_crc32("") == 0);
@@ -47,5 +71,7 @@ int main(void)
     test_numbered_line(0x00000000, "");
     test_numbered_line(0x25b15360, X X X X X X X X X);
     test_numbered_line(0x759455a5, X X X X X X X X X X);
+
+    test_monotonic_search();
     return 0;
 }
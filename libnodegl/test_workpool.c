@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "utils.h"
+#include "workpool.h"
+
+#define NB_JOBS 1000
+
+static void increment(void *user_arg, int job_id)
+{
+    int *counters = user_arg;
+    /* Uneven amount of work per job */
+    volatile int x = 0;
+    for (int i = 0; i < (job_id % 17) * 100; i++)
+        x++;
+    counters[job_id]++;
+}
+
+static void run_batches(struct workpool *workpool)
+{
+    static int counters[NB_JOBS];
+    memset(counters, 0, sizeof(counters));
+
+    for (int batch = 0; batch < 50; batch++) {
+        const int nb_jobs = batch % 3 ? NB_JOBS : batch % 7;
+        ngli_workpool_run(workpool, increment, counters, nb_jobs);
+    }
+
+    for (int i = 0; i < NB_JOBS; i++) {
+        int expected = 0;
+        for (int batch = 0; batch < 50; batch++) {
+            const int nb_jobs = batch % 3 ? NB_JOBS : batch % 7;
+            expected += i < nb_jobs;
+        }
+        ngli_assert(counters[i] == expected);
+    }
+}
+
+int main(void)
+{
+    run_batches(NULL);
+
+    static const int nb_threads[] = {1, 2, 4, 16};
+    for (int i = 0; i < NGLI_ARRAY_NB(nb_threads); i++) {
+        struct workpool *workpool = ngli_workpool_create(nb_threads[i]);
+        ngli_assert(workpool);
+        run_batches(workpool);
+        ngli_workpool_freep(&workpool);
+        ngli_assert(!workpool);
+    }
+
+    return 0;
+}
@@ -53,6 +53,7 @@ enum {
     NGLI_TEXTURE_USAGE_STORAGE_BIT                  = 1 << 3,
     NGLI_TEXTURE_USAGE_COLOR_ATTACHMENT_BIT         = 1 << 4,
     NGLI_TEXTURE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT = 1 << 5,
+    NGLI_TEXTURE_USAGE_DYNAMIC_BIT                  = 1 << 6,
 };
 
 enum texture_type {
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <string.h>
+
+#include "format.h"
+#include "log.h"
+#include "nodegl.h"
+#include "texturepool.h"
+#include "utils.h"
+
+struct texturepool_entry {
+    struct texture *texture;
+    int64_t size;
+};
+
+static int64_t get_texture_size(const struct texture *texture)
+{
+    const struct texture_params *params = &texture->params;
+    int64_t size = (int64_t)params->width
+                 * params->height
+                 * NGLI_MAX(params->depth, 1)
+                 * NGLI_MAX(params->samples, 1)
+                 * ngli_format_get_bytes_per_pixel(params->format);
+    if (params->type == NGLI_TEXTURE_TYPE_CUBE)
+        size *= 6;
+    if (params->mipmap_filter != NGLI_MIPMAP_FILTER_NONE)
+        size += size / 3;
+    return size;
+}
+
+static void remove_entry(struct texturepool *s, int index)
+{
+    struct texturepool_entry *entry = ngli_darray_get(&s->entries, index);
+    s->size -= entry->size;
+    ngli_darray_remove(&s->entries, index);
+}
+
+int ngli_texturepool_init(struct texturepool *s, struct gctx *gctx, int64_t max_size)
+{
+    s->gctx = gctx;
+    s->max_size = NGLI_MAX(max_size, 0);
+    s->size = 0;
+    ngli_darray_init(&s->entries, sizeof(struct texturepool_entry), 0);
+    return 0;
+}
+
+int ngli_texturepool_get_texture(struct texturepool *s, struct texture **dstp, const struct texture_params *params)
+{
+    /* Look for the most recently released texture sharing the same shape */
+    const struct texturepool_entry *entries = ngli_darray_data(&s->entries);
+    for (int i = ngli_darray_count(&s->entries) - 1; i >= 0; i--) {
+        struct texture *texture = entries[i].texture;
+        if (!memcmp(&texture->params, params, sizeof(*params))) {
+            TRACE("recycle texture %dx%dx%d from the pool",
+                  params->width, params->height, params->depth);
+            remove_entry(s, i);
+            *dstp = texture;
+            return 0;
+        }
+    }
+
+    struct texture *texture = ngli_texture_create(s->gctx);
+    if (!texture)
+        return NGL_ERROR_MEMORY;
+
+    int ret = ngli_texture_init(texture, params);
+    if (ret < 0) {
+        ngli_texture_freep(&texture);
+        return ret;
+    }
+
+    *dstp = texture;
+    return 0;
+}
+
+void ngli_texturepool_release_texture(struct texturepool *s, struct texture **texturep)
+{
+    struct texture *texture = *texturep;
+    if (!texture)
+        return;
+
+    /* Wrapped textures and textures with an external storage do not own
+     * their content so they can not be recycled */
+    const int64_t size = get_texture_size(texture);
+    if (!s->max_size || texture->wrapped || texture->external_storage || size > s->max_size) {
+        ngli_texture_freep(texturep);
+        return;
+    }
+
+    const struct texturepool_entry entry = {.texture = texture, .size = size};
+    if (!ngli_darray_push(&s->entries, &entry)) {
+        ngli_texture_freep(texturep);
+        return;
+    }
+    s->size += size;
+    *texturep = NULL;
+
+    /* Evict the least recently released textures to honor the budget */
+    while (s->size > s->max_size) {
+        struct texturepool_entry *oldest = ngli_darray_get(&s->entries, 0);
+        struct texture *evicted = oldest->texture;
+        remove_entry(s, 0);
+        ngli_texture_freep(&evicted);
+    }
+}
+
+void ngli_texturepool_reset(struct texturepool *s)
+{
+    if (!s->gctx)
+        return;
+    struct texturepool_entry *entries = ngli_darray_data(&s->entries);
+    for (int i = 0; i < ngli_darray_count(&s->entries); i++)
+        ngli_texture_freep(&entries[i].texture);
+    ngli_darray_reset(&s->entries);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef TEXTUREPOOL_H
+#define TEXTUREPOOL_H
+
+#include <stdint.h>
+
+#include "darray.h"
+#include "texture.h"
+
+struct texturepool {
+    struct gctx *gctx;
+    int64_t max_size;
+    int64_t size;
+    struct darray entries; // texturepool_entry, from the least to the most recently released
+};
+
+int ngli_texturepool_init(struct texturepool *s, struct gctx *gctx, int64_t max_size);
+int ngli_texturepool_get_texture(struct texturepool *s, struct texture **dstp, const struct texture_params *params);
+void ngli_texturepool_release_texture(struct texturepool *s, struct texture **texturep);
+void ngli_texturepool_reset(struct texturepool *s);
+
+#endif
@@ -54,11 +54,57 @@ const float *ngli_get_last_transformation_matrix(const struct ngl_node *node)
     return NULL;
 }
 
+static int is_transform(const struct ngl_node *node)
+{
+    switch (node->class->id) {
+        case NGL_NODE_ROTATE:
+        case NGL_NODE_ROTATEQUAT:
+        case NGL_NODE_SCALE:
+        case NGL_NODE_SKEW:
+        case NGL_NODE_TRANSFORM:
+        case NGL_NODE_TRANSLATE:
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Fold the chain of non-animated transforms below the node into a single
+ * matrix. Their matrices can only change through live changes, which are
+ * tracked by the update generation, while the node own matrix changes every
+ * time it is evaluated if it is animated.
+ */
+static void fold_transforms(struct ngl_node *node)
+{
+    struct transform_priv *s = node->priv_data;
+    const uint64_t generation = node->ctx->update_generation;
+
+    if (s->folded_child && s->folded_generation == generation &&
+        (!s->animated || s->folded_eval_time == node->last_eval_time))
+        return;
+
+    memcpy(s->folded_matrix, s->matrix, sizeof(s->folded_matrix));
+    struct ngl_node *child = s->child;
+    while (is_transform(child)) {
+        const struct transform_priv *trf = child->priv_data;
+        if (trf->animated)
+            break;
+        ngli_mat4_mul(s->folded_matrix, s->folded_matrix, trf->matrix);
+        child = trf->child;
+    }
+
+    s->folded_child = child;
+    s->folded_generation = generation;
+    s->folded_eval_time = node->last_eval_time;
+    s->world_valid = 0;
+}
+
 void ngli_transform_draw(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct transform_priv *s = node->priv_data;
-    struct ngl_node *child = s->child;
+
+    fold_transforms(node);
 
     float *next_matrix = ngli_darray_push(&ctx->modelview_matrix_stack, NULL);
     if (!next_matrix)
@@ -69,7 +115,20 @@ void ngli_transform_draw(struct ngl_node *node)
      * underlying matrix stack buffer */
     const float *prev_matrix = next_matrix - 4 * 4;
 
-    ngli_mat4_mul(next_matrix, prev_matrix, s->matrix);
-    ngli_node_draw(child);
+    if (!s->world_valid || memcmp(s->parent_matrix, prev_matrix, sizeof(s->parent_matrix))) {
+        memcpy(s->parent_matrix, prev_matrix, sizeof(s->parent_matrix));
+        ngli_mat4_mul(s->world_matrix, prev_matrix, s->folded_matrix);
+        s->world_valid = 1;
+    }
+    memcpy(next_matrix, s->world_matrix, sizeof(s->world_matrix));
+
+    /* The folded transforms are not drawn but still account for the draw */
+    for (struct ngl_node *child = s->child; child != s->folded_child;) {
+        const struct transform_priv *trf = child->priv_data;
+        child->draw_count++;
+        child = trf->child;
+    }
+
+    ngli_node_draw(s->folded_child);
     ngli_darray_pop(&ctx->modelview_matrix_stack);
 }
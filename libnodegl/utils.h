@@ -100,6 +100,54 @@
                          NGLI_ARG_VEC4((v)+4*2),    \
                          NGLI_ARG_VEC4((v)+4*3)
 
+/*
+ * Define a function looking for the index of the last key lower or equal to t
+ * in a monotonically increasing sequence, or -1 if t is before the first key.
+ * get_key(keys, i) must return the i-th key.
+ *
+ * The search gallops from the hint index (typically the result of the
+ * previous lookup) and then bisects the bracketed interval, so lookups for
+ * consecutive times are O(1) and random seeks O(log n).
+ */
+#define NGLI_DEFINE_MONOTONIC_SEARCH_FUNC(name, keys_type, key_type, get_key)   \
+static int name(keys_type keys, int nb_keys, int hint, key_type t)              \
+{                                                                               \
+    if (nb_keys <= 0 || t < get_key(keys, 0))                                   \
+        return -1;                                                              \
+    if (hint < 0 || hint >= nb_keys)                                            \
+        hint = 0;                                                               \
+                                                                                \
+    /* bracket the result such that key(lo) <= t < key(hi) */                   \
+    int lo, hi, step = 1;                                                       \
+    if (get_key(keys, hint) <= t) {                                             \
+        lo = hint;                                                              \
+        hi = hint + 1;                                                          \
+        while (hi < nb_keys && get_key(keys, hi) <= t) {                        \
+            lo = hi;                                                            \
+            step <<= 1;                                                         \
+            hi = lo + step;                                                     \
+        }                                                                       \
+        hi = NGLI_MIN(hi, nb_keys);                                             \
+    } else {                                                                    \
+        hi = hint;                                                              \
+        lo = hint - 1;                                                          \
+        while (lo > 0 && get_key(keys, lo) > t) {                               \
+            hi = lo;                                                            \
+            step <<= 1;                                                         \
+            lo = hi - step;                                                     \
+        }                                                                       \
+        lo = NGLI_MAX(lo, 0);                                                   \
+    }                                                                           \
+                                                                                \
+    while (hi - lo > 1) {                                                       \
+        const int mid = lo + ((hi - lo) >> 1);                                  \
+        if (get_key(keys, mid) <= t)                                            \
+            lo = mid;                                                           \
+        else                                                                    \
+            hi = mid;                                                           \
+    }                                                                           \
+    return lo;                                                                  \
+}
 
 char *ngli_strdup(const char *s);
 int64_t ngli_gettime_relative(void);
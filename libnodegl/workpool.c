@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <pthread.h>
+
+#include "log.h"
+#include "memory.h"
+#include "workpool.h"
+
+struct workpool {
+    pthread_t *threads;
+    int nb_threads;
+    int nb_started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond_wkr;
+    pthread_cond_t cond_ctl;
+
+    /* Current batch, protected by lock */
+    workpool_func_type func;
+    void *user_arg;
+    int nb_jobs;
+    int next_job;
+    int nb_done;
+    unsigned batch_id;
+    int stop;
+};
+
+/* Must be called with the lock held, returns with the lock held */
+static void run_jobs(struct workpool *s)
+{
+    while (s->next_job < s->nb_jobs) {
+        const int job_id = s->next_job++;
+        workpool_func_type func = s->func;
+        void *user_arg = s->user_arg;
+
+        pthread_mutex_unlock(&s->lock);
+        func(user_arg, job_id);
+        pthread_mutex_lock(&s->lock);
+
+        if (++s->nb_done == s->nb_jobs)
+            pthread_cond_signal(&s->cond_ctl);
+    }
+}
+
+static void *worker_thread(void *arg)
+{
+    struct workpool *s = arg;
+
+    pthread_mutex_lock(&s->lock);
+    unsigned batch_id = s->batch_id;
+    for (;;) {
+        while (!s->stop && s->batch_id == batch_id)
+            pthread_cond_wait(&s->cond_wkr, &s->lock);
+        if (s->stop)
+            break;
+        batch_id = s->batch_id;
+        run_jobs(s);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+
+struct workpool *ngli_workpool_create(int nb_threads)
+{
+    struct workpool *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+
+    /* The calling thread takes part in the batches */
+    s->nb_threads = nb_threads - 1;
+    if (s->nb_threads > 0) {
+        s->threads = ngli_calloc(s->nb_threads, sizeof(*s->threads));
+        if (!s->threads) {
+            ngli_free(s);
+            return NULL;
+        }
+    }
+
+    if (pthread_mutex_init(&s->lock, NULL)) {
+        ngli_free(s->threads);
+        ngli_free(s);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&s->cond_wkr, NULL)) {
+        pthread_mutex_destroy(&s->lock);
+        ngli_free(s->threads);
+        ngli_free(s);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&s->cond_ctl, NULL)) {
+        pthread_cond_destroy(&s->cond_wkr);
+        pthread_mutex_destroy(&s->lock);
+        ngli_free(s->threads);
+        ngli_free(s);
+        return NULL;
+    }
+
+    for (int i = 0; i < s->nb_threads; i++) {
+        if (pthread_create(&s->threads[i], NULL, worker_thread, s)) {
+            ngli_workpool_freep(&s);
+            return NULL;
+        }
+        s->nb_started++;
+    }
+
+    LOG(DEBUG, "work pool created with %d threads", nb_threads);
+    return s;
+}
+
+void ngli_workpool_run(struct workpool *s, workpool_func_type func, void *user_arg, int nb_jobs)
+{
+    if (!s || !s->nb_started || nb_jobs == 1) {
+        for (int i = 0; i < nb_jobs; i++)
+            func(user_arg, i);
+        return;
+    }
+
+    if (nb_jobs <= 0)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    s->func = func;
+    s->user_arg = user_arg;
+    s->nb_jobs = nb_jobs;
+    s->next_job = 0;
+    s->nb_done = 0;
+    s->batch_id++;
+    pthread_cond_broadcast(&s->cond_wkr);
+
+    run_jobs(s);
+    while (s->nb_done < s->nb_jobs)
+        pthread_cond_wait(&s->cond_ctl, &s->lock);
+    pthread_mutex_unlock(&s->lock);
+}
+
+void ngli_workpool_freep(struct workpool **sp)
+{
+    struct workpool *s = *sp;
+    if (!s)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    s->stop = 1;
+    pthread_cond_broadcast(&s->cond_wkr);
+    pthread_mutex_unlock(&s->lock);
+
+    for (int i = 0; i < s->nb_started; i++)
+        pthread_join(s->threads[i], NULL);
+
+    pthread_cond_destroy(&s->cond_ctl);
+    pthread_cond_destroy(&s->cond_wkr);
+    pthread_mutex_destroy(&s->lock);
+    ngli_free(s->threads);
+    ngli_freep(sp);
+}
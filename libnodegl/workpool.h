@@ -0,0 +1,44 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+typedef void (*workpool_func_type)(void *user_arg, int job_id);
+
+/*
+ * Pool of threads running batches of independent jobs. The jobs of a batch
+ * are picked one by one by whichever thread is available (including the
+ * calling thread), so uneven jobs are balanced across the threads.
+ */
+struct workpool;
+
+struct workpool *ngli_workpool_create(int nb_threads);
+
+/*
+ * Run func() for every job id in [0,nb_jobs) and wait for all of them to
+ * complete. A NULL pool runs the jobs sequentially on the calling thread.
+ */
+void ngli_workpool_run(struct workpool *s, workpool_func_type func, void *user_arg, int nb_jobs);
+
+void ngli_workpool_freep(struct workpool **sp);
+
+#endif
@@ -19,6 +19,8 @@
  * under the License.
  */
 
+#define _POSIX_C_SOURCE 200112L // for the socket control messages with glibc
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,6 +28,7 @@
 #include <winsock2.h>
 #else
 #include <sys/socket.h>
+#include <unistd.h>
 #endif
 
 #include <nodegl.h>
@@ -40,6 +43,12 @@ static void u32_write(uint8_t *buf, uint32_t v)
     buf[3] = v       & 0xff;
 }
 
+static void u64_write(uint8_t *buf, uint64_t v)
+{
+    u32_write(buf,     v >> 32);
+    u32_write(buf + 4, v & 0xffffffff);
+}
+
 static void pkt_update_header(struct ipc_pkt *pkt)
 {
     memcpy(pkt->data, "nglp", 4); // 'p' stands for packet
@@ -52,6 +61,7 @@ struct ipc_pkt *ipc_pkt_create(void)
     if (!pkt)
         return NULL;
     pkt->size = 8;
+    pkt->nb_fds = 0;
     pkt->data = malloc(pkt->size);
     if (!pkt->data) {
         free(pkt);
@@ -81,11 +91,79 @@ int ipc_pkt_add_qtag_scene(struct ipc_pkt *pkt, const char *scene)
     return pack(pkt, IPC_SCENE, scene, strlen(scene) + 1);
 }
 
+int ipc_pkt_add_qtag_scene_patch(struct ipc_pkt *pkt, const char *patch)
+{
+    return pack(pkt, IPC_SCENE_PATCH, patch, strlen(patch) + 1);
+}
+
+static void close_fd(int fd)
+{
+#ifndef _WIN32
+    close(fd);
+#endif
+}
+
+static void close_fds(struct ipc_pkt *pkt)
+{
+    for (int i = 0; i < pkt->nb_fds; i++)
+        close_fd(pkt->fds[i]);
+    pkt->nb_fds = 0;
+}
+
+/*
+ * The descriptor is owned by the packet from now on (even on failure), and its
+ * index in the packet file descriptors is written in the tag data
+ */
+static int pack_fd(struct ipc_pkt *pkt, uint32_t tag, int fd, const void *data, int datalen)
+{
+#ifdef _WIN32
+    return NGL_ERROR_UNSUPPORTED;
+#else
+    if (pkt->nb_fds >= IPC_MAX_FDS) {
+        close_fd(fd);
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    }
+    int ret = pack(pkt, tag, NULL, 4 + datalen);
+    if (ret < 0) {
+        close_fd(fd);
+        return ret;
+    }
+    uint8_t *dst = pkt->data + pkt->size - 4 - datalen;
+    u32_write(dst, pkt->nb_fds);
+    if (data)
+        memcpy(dst + 4, data, datalen);
+    pkt->fds[pkt->nb_fds++] = fd;
+    return 0;
+#endif
+}
+
+int ipc_pkt_add_qtag_scene_fd(struct ipc_pkt *pkt, int scene_fd)
+{
+    return pack_fd(pkt, IPC_SCENE_FD, scene_fd, NULL, 0);
+}
+
 int ipc_pkt_add_qtag_file(struct ipc_pkt *pkt, const char *filename)
 {
     return pack(pkt, IPC_FILE, filename, strlen(filename) + 1);
 }
 
+int ipc_pkt_add_qtag_file_fd(struct ipc_pkt *pkt, const char *filename, int file_fd)
+{
+    return pack_fd(pkt, IPC_FILE_FD, file_fd, filename, strlen(filename) + 1);
+}
+
+int ipc_pkt_add_qtag_fileinfo(struct ipc_pkt *pkt, int64_t size, uint64_t hash, int chunk_size)
+{
+    int ret = pack(pkt, IPC_FILEINFO, NULL, 20);
+    if (ret < 0)
+        return ret;
+    uint8_t *dst = pkt->data + pkt->size - 20;
+    u64_write(dst,      size);
+    u64_write(dst + 8,  hash);
+    u32_write(dst + 16, chunk_size);
+    return 0;
+}
+
 int ipc_pkt_add_qtag_filepart(struct ipc_pkt *pkt, const uint8_t *chunk, int chunk_size)
 {
     return pack(pkt, IPC_FILEPART, chunk, chunk_size);
@@ -148,6 +226,16 @@ int ipc_pkt_add_rtag_info(struct ipc_pkt *pkt, const char *info)
     return pack(pkt, IPC_INFO, info, strlen(info) + 1);
 }
 
+int ipc_pkt_add_rtag_fileinfo(struct ipc_pkt *pkt, int chunk_size)
+{
+    int ret = pack(pkt, IPC_FILEINFO, NULL, 4);
+    if (ret < 0)
+        return ret;
+    uint8_t *dst = pkt->data + pkt->size - 4;
+    u32_write(dst, chunk_size);
+    return 0;
+}
+
 int ipc_pkt_add_rtag_filepart(struct ipc_pkt *pkt, int written)
 {
     int ret = pack(pkt, IPC_FILEPART, NULL, 4);
@@ -168,14 +256,52 @@ void ipc_pkt_freep(struct ipc_pkt **pktp)
     struct ipc_pkt *pkt = *pktp;
     if (!pkt)
         return;
+    close_fds(pkt);
     free(pkt->data);
     free(pkt);
     *pktp = NULL;
 }
 
+int ipc_pkt_get_fd(const struct ipc_pkt *pkt, int index)
+{
+    if (index < 0 || index >= pkt->nb_fds)
+        return -1;
+    return pkt->fds[index];
+}
+
+#ifndef _WIN32
+union ipc_cmsg {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE(IPC_MAX_FDS * sizeof(int))];
+};
+
+static int send_fds(int fd, const struct ipc_pkt *pkt)
+{
+    struct iovec iov = {.iov_base = pkt->data, .iov_len = pkt->size};
+    union ipc_cmsg cmsg;
+    struct msghdr msg = {
+        .msg_iov        = &iov,
+        .msg_iovlen     = 1,
+        .msg_control    = cmsg.buf,
+        .msg_controllen = CMSG_SPACE(pkt->nb_fds * sizeof(int)),
+    };
+    memset(cmsg.buf, 0, sizeof(cmsg.buf));
+    struct cmsghdr *hdr = CMSG_FIRSTHDR(&msg);
+    hdr->cmsg_level = SOL_SOCKET;
+    hdr->cmsg_type  = SCM_RIGHTS;
+    hdr->cmsg_len   = CMSG_LEN(pkt->nb_fds * sizeof(int));
+    memcpy(CMSG_DATA(hdr), pkt->fds, pkt->nb_fds * sizeof(int));
+    return sendmsg(fd, &msg, 0);
+}
+#endif
+
 int ipc_send(int fd, const struct ipc_pkt *pkt)
 {
+#ifdef _WIN32
     const int n = send(fd, pkt->data, pkt->size, 0);
+#else
+    const int n = pkt->nb_fds ? send_fds(fd, pkt) : send(fd, pkt->data, pkt->size, 0);
+#endif
     if (n < 0) {
         perror("send");
         return NGL_ERROR_IO;
@@ -188,11 +314,57 @@ int ipc_send(int fd, const struct ipc_pkt *pkt)
     return 0;
 }
 
-static int readbuf(int fd, uint8_t *buf, int size)
+#ifndef _WIN32
+/* Receive data along with the file descriptors possibly attached to it */
+static int recv_fds(int fd, uint8_t *buf, int size, struct ipc_pkt *pkt)
+{
+    struct iovec iov = {.iov_base = buf, .iov_len = size};
+    union ipc_cmsg cmsg;
+    struct msghdr msg = {
+        .msg_iov        = &iov,
+        .msg_iovlen     = 1,
+        .msg_control    = cmsg.buf,
+        .msg_controllen = sizeof(cmsg.buf),
+    };
+    const int n = recvmsg(fd, &msg, 0);
+    if (n < 0)
+        return n;
+
+    for (struct cmsghdr *hdr = CMSG_FIRSTHDR(&msg); hdr; hdr = CMSG_NXTHDR(&msg, hdr)) {
+        if (hdr->cmsg_level != SOL_SOCKET || hdr->cmsg_type != SCM_RIGHTS)
+            continue;
+        const int nb_fds = (hdr->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const uint8_t *fds = CMSG_DATA(hdr);
+        for (int i = 0; i < nb_fds; i++) {
+            int recv_fd;
+            memcpy(&recv_fd, fds + i * sizeof(int), sizeof(int));
+            if (pkt->nb_fds < IPC_MAX_FDS)
+                pkt->fds[pkt->nb_fds++] = recv_fd;
+            else
+                close_fd(recv_fd);
+        }
+    }
+
+    if (msg.msg_flags & MSG_CTRUNC) {
+        fprintf(stderr, "file descriptors were discarded from the packet\n");
+        return NGL_ERROR_LIMIT_EXCEEDED;
+    }
+
+    return n;
+}
+#endif
+
+static int readbuf(int fd, uint8_t *buf, int size, struct ipc_pkt *pkt)
 {
     int nr = 0;
     while (nr != size) {
+#ifdef _WIN32
         const int n = recv(fd, buf + nr, size - nr, 0);
+#else
+        const int n = pkt ? recv_fds(fd, buf + nr, size - nr, pkt) : recv(fd, buf + nr, size - nr, 0);
+#endif
+        if (n == NGL_ERROR_LIMIT_EXCEEDED)
+            return n;
         if (n == 0)
             return 0;
         if (n < 0) {
@@ -206,13 +378,17 @@ static int readbuf(int fd, uint8_t *buf, int size)
 
 void ipc_pkt_reset(struct ipc_pkt *pkt)
 {
+    close_fds(pkt);
     pkt->size = 8;
     pkt_update_header(pkt);
 }
 
 int ipc_recv(int fd, struct ipc_pkt *pkt)
 {
-    int ret = readbuf(fd, pkt->data, 8);
+    close_fds(pkt);
+
+    /* The file descriptors are attached to the first byte of the packet */
+    int ret = readbuf(fd, pkt->data, 8, pkt);
     if (ret <= 0)
         return ret;
 
@@ -233,10 +409,37 @@ int ipc_recv(int fd, struct ipc_pkt *pkt)
         return NGL_ERROR_MEMORY;
     pkt->data = dst;
 
-    ret = readbuf(fd, pkt->data + 8, size);
+    ret = readbuf(fd, pkt->data + 8, size, NULL);
     if (ret <= 0)
         return ret;
 
     pkt->size += size;
     return ret;
 }
+
+int ipc_get_local_socket_path(char *buf, int size, const char *host, const char *port)
+{
+    const int ret = snprintf(buf, size, "/tmp/ngl-desktop/%s-%s/ipc.sock", host, port);
+    if (ret < 0 || ret >= size)
+        return NGL_ERROR_MEMORY;
+    return 0;
+}
+
+int ipc_hash_file(FILE *fp, uint64_t *hash)
+{
+    uint8_t buf[64 * 1024];
+    uint64_t h = 0xcbf29ce484222325;
+    for (;;) {
+        const size_t n = fread(buf, 1, sizeof(buf), fp);
+        for (size_t i = 0; i < n; i++) {
+            h ^= buf[i];
+            h *= 0x100000001b3;
+        }
+        if (n < sizeof(buf))
+            break;
+    }
+    if (ferror(fp))
+        return NGL_ERROR_IO;
+    *hash = h;
+    return 0;
+}
@@ -23,14 +23,20 @@
 #define IPC_H
 
 #include <stdint.h>
+#include <stdio.h>
 
 #define IPC_U32(a,b,c,d) (((uint32_t)(a))<<24 | (b)<<16 | (c)<<8 | (d))
 #define IPC_U32_READ(buf) IPC_U32((buf)[0], (buf)[1], (buf)[2], (buf)[3])
+#define IPC_U64_READ(buf) ((uint64_t)IPC_U32_READ(buf) << 32 | IPC_U32_READ((buf) + 4))
 #define IPC_U32_FMT(tag) (tag)>>24, (tag)>>16&0xff, (tag)>>8&0xff, (tag)&0xff
 
 enum ipc_tag {
     IPC_SCENE        = IPC_U32('s','c','n','e'),
+    IPC_SCENE_PATCH  = IPC_U32('p','t','c','h'),
+    IPC_SCENE_FD     = IPC_U32('s','c','f','d'),
     IPC_FILE         = IPC_U32('f','i','l','e'),
+    IPC_FILE_FD      = IPC_U32('f','i','f','d'),
+    IPC_FILEINFO     = IPC_U32('f','i','n','f'),
     IPC_FILEPART     = IPC_U32('f','p','r','t'),
     IPC_FILEEND      = IPC_U32('f','e','n','d'),
     IPC_DURATION     = IPC_U32('d','u','r','t'),
@@ -42,9 +48,18 @@ enum ipc_tag {
     IPC_RECONFIGURE  = IPC_U32('r','c','f','g'),
 };
 
+#define IPC_MAX_FDS 16
+
+/*
+ * On a local (Unix) socket, file descriptors can be passed along the packet
+ * data (see the *_fd tags), in which case they are owned by the packet and
+ * closed when it is reset or freed.
+ */
 struct ipc_pkt {
     uint8_t *data;
     int size;
+    int fds[IPC_MAX_FDS];
+    int nb_fds;
 };
 
 struct ipc_pkt *ipc_pkt_create(void);
@@ -53,7 +68,11 @@ void ipc_pkt_freep(struct ipc_pkt **pktp);
 
 /* Query tags */
 int ipc_pkt_add_qtag_scene(struct ipc_pkt *pkt, const char *scene);
+int ipc_pkt_add_qtag_scene_patch(struct ipc_pkt *pkt, const char *patch);
+int ipc_pkt_add_qtag_scene_fd(struct ipc_pkt *pkt, int scene_fd);
 int ipc_pkt_add_qtag_file(struct ipc_pkt *pkt, const char *filename);
+int ipc_pkt_add_qtag_file_fd(struct ipc_pkt *pkt, const char *filename, int file_fd);
+int ipc_pkt_add_qtag_fileinfo(struct ipc_pkt *pkt, int64_t size, uint64_t hash, int chunk_size);
 int ipc_pkt_add_qtag_filepart(struct ipc_pkt *pkt, const uint8_t *chunk, int chunk_size);
 int ipc_pkt_add_qtag_duration(struct ipc_pkt *pkt, double duration);
 int ipc_pkt_add_qtag_aspect(struct ipc_pkt *pkt, const int *aspect);
@@ -65,10 +84,23 @@ int ipc_pkt_add_qtag_reconfigure(struct ipc_pkt *pkt);
 
 /* Response tags */
 int ipc_pkt_add_rtag_info(struct ipc_pkt *pkt, const char *info);
+int ipc_pkt_add_rtag_fileinfo(struct ipc_pkt *pkt, int chunk_size);
 int ipc_pkt_add_rtag_filepart(struct ipc_pkt *pkt, int written);
 int ipc_pkt_add_rtag_fileend(struct ipc_pkt *pkt, const char *dest_filename);
 
+/* Get the file descriptor referenced by index in a *_fd tag, -1 if invalid */
+int ipc_pkt_get_fd(const struct ipc_pkt *pkt, int index);
+
 int ipc_send(int fd, const struct ipc_pkt *pkt);
 int ipc_recv(int fd, struct ipc_pkt *pkt);
 
+/*
+ * Hash of the remaining content of a file, used to identify the files which
+ * do not need to be uploaded again (FNV-1a, 64-bit)
+ */
+int ipc_hash_file(FILE *fp, uint64_t *hash);
+
+/* Path of the local socket of the ngl-desktop instance listening on host:port */
+int ipc_get_local_socket_path(char *buf, int size, const char *host, const char *port);
+
 #endif
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <nodegl.h>
+
+#include "common.h"
+#include "opts.h"
+
+struct ctx {
+    /* options */
+    int log_level;
+    const char *input;
+    const char *output;
+    const char *mode;
+    int nb_runs;
+    int nb_threads;
+    int nb_groups;
+    int nb_vertices;
+    int nb_keyframes;
+};
+
+#define OFFSET(x) offsetof(struct ctx, x)
+static const struct opt options[] = {
+    {"-l", "--loglevel",  OPT_TYPE_LOGLEVEL, .offset=OFFSET(log_level)},
+    {"-i", "--input",     OPT_TYPE_STR,      .offset=OFFSET(input)},
+    {"-o", "--output",    OPT_TYPE_STR,      .offset=OFFSET(output)},
+    {"-m", "--mode",      OPT_TYPE_STR,      .offset=OFFSET(mode)},
+    {"-r", "--runs",      OPT_TYPE_INT,      .offset=OFFSET(nb_runs)},
+    {"-j", "--threads",   OPT_TYPE_INT,      .offset=OFFSET(nb_threads)},
+    {"-n", "--groups",    OPT_TYPE_INT,      .offset=OFFSET(nb_groups)},
+    {"-c", "--vertices",  OPT_TYPE_INT,      .offset=OFFSET(nb_vertices)},
+    {"-k", "--keyframes", OPT_TYPE_INT,      .offset=OFFSET(nb_keyframes)},
+};
+
+/*
+ * Every group holds a vertices buffer and an animation, which is
+ * representative of the bulk of the data carried by real world scenes.
+ */
+static struct ngl_node *get_group(const struct ctx *s, int id)
+{
+    float *vertices = malloc(s->nb_vertices * 3 * sizeof(*vertices));
+    if (!vertices)
+        return NULL;
+    for (int i = 0; i < s->nb_vertices * 3; i++)
+        vertices[i] = (float)((id * 7 + i) % 1000) / 999.f - .5f;
+    struct ngl_node *buffer = ngl_node_create(NGL_NODE_BUFFERVEC3);
+    ngl_node_param_set(buffer, "data", s->nb_vertices * 3 * (int)sizeof(*vertices), vertices);
+    free(vertices);
+
+    struct ngl_node *anim = ngl_node_create(NGL_NODE_ANIMATEDFLOAT);
+    for (int i = 0; i < s->nb_keyframes; i++) {
+        struct ngl_node *kf = ngl_node_create(NGL_NODE_ANIMKEYFRAMEFLOAT);
+        ngl_node_param_set(kf, "time", i / 60.);
+        ngl_node_param_set(kf, "value", (double)((id + i) % 17) / 16.);
+        ngl_node_param_add(anim, "keyframes", 1, &kf);
+        ngl_node_unrefp(&kf);
+    }
+
+    struct ngl_node *group = ngl_node_create(NGL_NODE_GROUP);
+    struct ngl_node *children[] = {buffer, anim};
+    ngl_node_param_add(group, "children", ARRAY_NB(children), children);
+    ngl_node_unrefp(&buffer);
+    ngl_node_unrefp(&anim);
+    return group;
+}
+
+static int write_scene(const struct ctx *s)
+{
+    struct ngl_node *scene = ngl_node_create(NGL_NODE_GROUP);
+    if (!scene)
+        return EXIT_FAILURE;
+    for (int i = 0; i < s->nb_groups; i++) {
+        struct ngl_node *group = get_group(s, i);
+        if (!group) {
+            ngl_node_unrefp(&scene);
+            return EXIT_FAILURE;
+        }
+        ngl_node_param_add(scene, "children", 1, &group);
+        ngl_node_unrefp(&group);
+    }
+
+    const char *ext = strrchr(s->output, '.');
+    const int bin = ext && !strcmp(ext, ".nglb");
+    size_t size = 0;
+    void *data = bin ? ngl_node_serialize_bin(scene, &size) : ngl_node_serialize(scene);
+    ngl_node_unrefp(&scene);
+    if (!data)
+        return EXIT_FAILURE;
+    if (!bin)
+        size = strlen(data);
+
+    FILE *fp = fopen(s->output, "wb");
+    if (!fp) {
+        free(data);
+        return EXIT_FAILURE;
+    }
+    const size_t n = fwrite(data, 1, size, fp);
+    fclose(fp);
+    free(data);
+    if (n != size)
+        return EXIT_FAILURE;
+
+    printf("%s: %d groups, %zu bytes\n", s->output, s->nb_groups, size);
+    return 0;
+}
+
+static int read_func(void *arg, char *buf, int size)
+{
+    FILE *fp = arg;
+    const size_t n = fread(buf, 1, size, fp);
+    if (ferror(fp))
+        return NGL_ERROR_IO;
+    return (int)n;
+}
+
+static struct ngl_node *load_scene(const struct ctx *s)
+{
+    FILE *fp = fopen(s->input, "rb");
+    if (!fp)
+        return NULL;
+
+    struct ngl_node *scene = NULL;
+    char magic[4] = {0};
+    const size_t n = fread(magic, 1, sizeof(magic), fp);
+    if (n == sizeof(magic) && !memcmp(magic, "NGLB", sizeof(magic))) {
+        fseek(fp, 0, SEEK_END);
+        const long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        void *data = malloc(size);
+        if (data && fread(data, 1, size, fp) == (size_t)size)
+            scene = ngl_node_deserialize_bin(data, size);
+        free(data);
+    } else if (!strcmp(s->mode, "stream")) {
+        fseek(fp, 0, SEEK_SET);
+        scene = ngl_node_deserialize_stream(fp, read_func);
+    } else {
+        fclose(fp);
+        fp = NULL;
+        char *str = get_text_file_content(s->input);
+        if (str)
+            scene = !strcmp(s->mode, "parallel") ? ngl_node_deserialize_parallel(str, s->nb_threads)
+                                                 : ngl_node_deserialize(str);
+        free(str);
+    }
+
+    if (fp)
+        fclose(fp);
+    return scene;
+}
+
+static long get_max_rss(void)
+{
+#ifdef _WIN32
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) < 0)
+        return -1;
+    return usage.ru_maxrss;
+#endif
+}
+
+static int bench_scene(const struct ctx *s)
+{
+    int64_t min_time = INT64_MAX;
+    int64_t total_time = 0;
+
+    for (int i = 0; i < s->nb_runs; i++) {
+        const int64_t t0 = gettime_relative();
+        struct ngl_node *scene = load_scene(s);
+        const int64_t t1 = gettime_relative();
+        if (!scene) {
+            fprintf(stderr, "unable to load %s\n", s->input);
+            return EXIT_FAILURE;
+        }
+        ngl_node_unrefp(&scene);
+
+        const int64_t t = t1 - t0;
+        min_time = t < min_time ? t : min_time;
+        total_time += t;
+    }
+
+    printf("%s (%s): best %.3fms, average %.3fms over %d runs, max RSS %ldkB\n",
+           s->input, s->mode, min_time / 1000., total_time / 1000. / s->nb_runs,
+           s->nb_runs, get_max_rss());
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct ctx s = {
+        .log_level    = NGL_LOG_WARNING,
+        .mode         = "text",
+        .nb_runs      = 5,
+        .nb_threads   = 4,
+        .nb_groups    = 100,
+        .nb_vertices  = 10000,
+        .nb_keyframes = 100,
+    };
+
+    int ret = opts_parse(argc, argc, argv, options, ARRAY_NB(options), &s);
+    if (ret < 0 || ret == OPT_HELP || (!s.input == !s.output)) {
+        opts_print_usage(argv[0], options, ARRAY_NB(options), NULL);
+        fprintf(stderr, "\nExactly one of --output (scene generation) or --input (load benchmark) must be set.\n"
+                        "Scenes ending with .nglb use the binary format, --mode selects text, stream or parallel loading.\n");
+        return ret == OPT_HELP ? 0 : EXIT_FAILURE;
+    }
+
+    if (strcmp(s.mode, "text") && strcmp(s.mode, "stream") && strcmp(s.mode, "parallel")) {
+        fprintf(stderr, "unknown mode %s\n", s.mode);
+        return EXIT_FAILURE;
+    }
+
+    if (s.nb_runs <= 0 || s.nb_groups < 0 || s.nb_vertices < 0 || s.nb_keyframes < 0) {
+        fprintf(stderr, "invalid benchmark parameters\n");
+        return EXIT_FAILURE;
+    }
+
+    ngl_log_set_min_level(s.log_level);
+
+    return s.output ? write_scene(&s) : bench_scene(&s);
+}
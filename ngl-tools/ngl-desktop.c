@@ -44,10 +44,15 @@
 #define SHUT_RDWR SD_BOTH
 #else
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/utsname.h>
 #include <netdb.h>
+#include <poll.h>
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <pthread.h>
@@ -64,6 +69,8 @@
 #define O_BINARY 0
 #endif
 
+#define MAX_UPLOAD_CHUNK_SIZE (16 * 1024 * 1024)
+
 struct ctx {
     /* options */
     const char *host;
@@ -77,6 +84,9 @@ struct ctx {
     int sock_fd;
     struct addrinfo *addr_info;
     struct addrinfo *addr;
+    int local_fd;
+    char local_path[1024];
+    int wakeup_fds[2];
 
     char root_dir[1024];
     char session_file[1024];
@@ -91,6 +101,8 @@ struct ctx {
     struct ipc_pkt *recv_pkt;
     FILE *upload_fp;
     char upload_path[1024];
+    char upload_tmp_path[1024];
+    int upload_chunk_size;
 };
 
 #define OFFSET(x) offsetof(struct ctx, x)
@@ -136,14 +148,9 @@ static int remove_session_file(struct ctx *s)
     return 0;
 }
 
-static int send_player_signal(enum player_signal sig, const void *data, int data_size)
+/* The data is owned by the player event from now on */
+static int push_player_signal(enum player_signal sig, void *p)
 {
-    void *p = NULL;
-    if (data_size) {
-        p = malloc(data_size);
-        memcpy(p, data, data_size);
-    }
-
     SDL_Event event = {
         .user = {
             .type  = SDL_USEREVENT,
@@ -156,6 +163,16 @@ static int send_player_signal(enum player_signal sig, const void *data, int data
     return 0;
 }
 
+static int send_player_signal(enum player_signal sig, const void *data, int data_size)
+{
+    void *p = NULL;
+    if (data_size) {
+        p = malloc(data_size);
+        memcpy(p, data, data_size);
+    }
+    return push_player_signal(sig, p);
+}
+
 static int handle_tag_scene(const uint8_t *data, int size)
 {
     if (size < 1 || data[size - 1] != 0) // check if string is nul-terminated
@@ -164,16 +181,52 @@ static int handle_tag_scene(const uint8_t *data, int size)
     return send_player_signal(PLAYER_SIGNAL_SCENE, scene, size);
 }
 
-static int handle_tag_file(struct ctx *s, const uint8_t *data, int size)
+static int handle_tag_scene_patch(const uint8_t *data, int size)
 {
     if (size < 1 || data[size - 1] != 0) // check if string is nul-terminated
         return NGL_ERROR_INVALID_DATA;
+    const char *patch = (const char *)data;
+    return send_player_signal(PLAYER_SIGNAL_SCENE_PATCH, patch, size);
+}
 
-    if (s->upload_fp) {
-        fprintf(stderr, "a file is already uploading");
-        return NGL_ERROR_INVALID_USAGE;
+#ifndef _WIN32
+static int handle_tag_scene_fd(struct ctx *s, const uint8_t *data, int size)
+{
+    if (size != 4)
+        return NGL_ERROR_INVALID_DATA;
+    const int fd = ipc_pkt_get_fd(s->recv_pkt, IPC_U32_READ(data));
+    if (fd < 0)
+        return NGL_ERROR_INVALID_DATA;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || lseek(fd, 0, SEEK_SET) < 0) {
+        perror("scene fd");
+        return NGL_ERROR_IO;
     }
+    if (st.st_size > INT32_MAX - 1)
+        return NGL_ERROR_LIMIT_EXCEEDED;
+
+    /* The scene is read straight into the buffer handed over to the player */
+    char *scene = malloc(st.st_size + 1);
+    if (!scene)
+        return NGL_ERROR_MEMORY;
+    size_t nr = 0;
+    while (nr < st.st_size) {
+        const ssize_t n = read(fd, scene + nr, st.st_size - nr);
+        if (n <= 0) {
+            perror("read");
+            free(scene);
+            return NGL_ERROR_IO;
+        }
+        nr += n;
+    }
+    scene[nr] = 0;
+    return push_player_signal(PLAYER_SIGNAL_SCENE, scene);
+}
+#endif
 
+static int get_upload_path(struct ctx *s, const char *filename)
+{
     /*
      * Basic (and probably too strict) check to make sure the file is not going
      * to be uploaded outside the files directory.
@@ -182,7 +235,6 @@ static int handle_tag_file(struct ctx *s, const uint8_t *data, int size)
      * process model instead of threads (because the session file should not be
      * mixed with the uploaded files).
      */
-    const char *filename = (const char *)data;
     if (strstr(filename, "..") || strchr(filename, '/')) {
         fprintf(stderr, "Only a filename is allowed\n");
         return NGL_ERROR_INVALID_ARG;
@@ -191,35 +243,131 @@ static int handle_tag_file(struct ctx *s, const uint8_t *data, int size)
     int ret = snprintf(s->upload_path, sizeof(s->upload_path), "%s%s", s->files_dir, filename);
     if (ret < 0 || ret >= sizeof(s->upload_path))
         return NGL_ERROR_MEMORY;
+    return 0;
+}
+
+static int handle_tag_file(struct ctx *s, const uint8_t *data, int size)
+{
+    if (size < 1 || data[size - 1] != 0) // check if string is nul-terminated
+        return NGL_ERROR_INVALID_DATA;
+
+    if (s->upload_fp) {
+        fprintf(stderr, "a file is already uploading");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    int ret = get_upload_path(s, (const char *)data);
+    if (ret < 0)
+        return ret;
+
+    /*
+     * The file is uploaded next to its destination, which it only replaces
+     * once complete: an interrupted upload never leaves a truncated file.
+     */
+    ret = snprintf(s->upload_tmp_path, sizeof(s->upload_tmp_path), "%s.part", s->upload_path);
+    if (ret < 0 || ret >= sizeof(s->upload_tmp_path))
+        return NGL_ERROR_MEMORY;
 
-    s->upload_fp = fopen(s->upload_path, "wb");
+    s->upload_fp = fopen(s->upload_tmp_path, "wb");
     if (!s->upload_fp) {
-        perror(s->upload_path);
+        perror(s->upload_tmp_path);
         return NGL_ERROR_IO;
     }
+    s->upload_chunk_size = MAX_UPLOAD_CHUNK_SIZE;
 
     return 0;
 }
 
 static void close_upload_file(struct ctx *s)
 {
-    if (s->upload_fp)
-        fclose(s->upload_fp);
+    if (!s->upload_fp)
+        return;
+    fclose(s->upload_fp);
     s->upload_fp = NULL;
+    remove(s->upload_tmp_path);
 }
 
-static int handle_tag_filepart(struct ctx *s, const uint8_t *data, int size)
+static int finish_upload_file(struct ctx *s)
+{
+    const int ret = fclose(s->upload_fp);
+    s->upload_fp = NULL;
+    if (ret) {
+        perror("fclose");
+        remove(s->upload_tmp_path);
+        return NGL_ERROR_IO;
+    }
+#ifdef _WIN32
+    remove(s->upload_path); // rename() does not replace existing files on Windows
+#endif
+    if (rename(s->upload_tmp_path, s->upload_path) < 0) {
+        perror(s->upload_path);
+        remove(s->upload_tmp_path);
+        return NGL_ERROR_IO;
+    }
+    return ipc_pkt_add_rtag_fileend(s->send_pkt, s->upload_path);
+}
+
+/* Check if the uploaded file is already present with the same content */
+static int is_uploaded(const char *path, int64_t size, uint64_t hash)
 {
+    struct stat st;
+    if (stat(path, &st) < 0 || st.st_size != size)
+        return 0;
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+    uint64_t cur_hash;
+    const int ret = ipc_hash_file(fp, &cur_hash);
+    fclose(fp);
+    return ret == 0 && cur_hash == hash;
+}
+
+/*
+ * Check if the file to upload is already present in the files directory, in
+ * which case the upload is cancelled before any part is sent. Otherwise, the
+ * size of the parts the client may send is negotiated.
+ */
+static int handle_tag_fileinfo(struct ctx *s, const uint8_t *data, int size)
+{
+    if (size != 20)
+        return NGL_ERROR_INVALID_DATA;
+
     if (!s->upload_fp) {
         fprintf(stderr, "file is not opened\n");
         return NGL_ERROR_INVALID_USAGE;
     }
 
-    if (!size) {
+    const int64_t file_size = IPC_U64_READ(data);
+    const uint64_t hash     = IPC_U64_READ(data + 8);
+    const int chunk_size    = IPC_U32_READ(data + 16);
+    if (chunk_size <= 0)
+        return NGL_ERROR_INVALID_DATA;
+
+    if (is_uploaded(s->upload_path, file_size, hash)) {
         close_upload_file(s);
         return ipc_pkt_add_rtag_fileend(s->send_pkt, s->upload_path);
     }
 
+    s->upload_chunk_size = chunk_size < MAX_UPLOAD_CHUNK_SIZE ? chunk_size : MAX_UPLOAD_CHUNK_SIZE;
+    return ipc_pkt_add_rtag_fileinfo(s->send_pkt, s->upload_chunk_size);
+}
+
+static int handle_tag_filepart(struct ctx *s, const uint8_t *data, int size)
+{
+    if (!s->upload_fp) {
+        fprintf(stderr, "file is not opened\n");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    if (!size)
+        return finish_upload_file(s);
+
+    if (size > s->upload_chunk_size) {
+        fprintf(stderr, "file part too large: %d > %d\n", size, s->upload_chunk_size);
+        close_upload_file(s);
+        return NGL_ERROR_INVALID_DATA;
+    }
+
     const size_t n = fwrite(data, 1, size, s->upload_fp);
     if (ferror(s->upload_fp)) {
         perror("fwrite");
@@ -236,6 +384,115 @@ static int handle_tag_filepart(struct ctx *s, const uint8_t *data, int size)
     return ipc_pkt_add_rtag_filepart(s->send_pkt, size);
 }
 
+#ifndef _WIN32
+static int copy_file(int dst_fd, int src_fd, off_t size)
+{
+#ifdef __linux__
+    /* The copy is entirely done by the kernel, within the page cache */
+    while (size > 0) {
+        const ssize_t n = sendfile(dst_fd, src_fd, NULL, size);
+        if (n <= 0)
+            break;
+        size -= n;
+    }
+    if (!size)
+        return 0;
+#endif
+    char buf[64 * 1024];
+    for (;;) {
+        const ssize_t n = read(src_fd, buf, sizeof(buf));
+        if (n == 0)
+            return 0;
+        if (n < 0) {
+            perror("read");
+            return NGL_ERROR_IO;
+        }
+        for (ssize_t nw = 0; nw < n;) {
+            const ssize_t w = write(dst_fd, buf + nw, n - nw);
+            if (w < 0) {
+                perror("write");
+                return NGL_ERROR_IO;
+            }
+            nw += w;
+        }
+    }
+}
+
+/* The descriptor is rewound for the copy following the hash */
+static int hash_fd(int fd, uint64_t *hash)
+{
+    const int dup_fd = dup(fd);
+    FILE *fp = dup_fd >= 0 ? fdopen(dup_fd, "rb") : NULL;
+    if (!fp) {
+        perror("file fd");
+        if (dup_fd >= 0)
+            close(dup_fd);
+        return NGL_ERROR_IO;
+    }
+    const int ret = ipc_hash_file(fp, hash);
+    fclose(fp);
+    if (ret < 0)
+        return ret;
+    if (lseek(fd, 0, SEEK_SET) < 0) {
+        perror("file fd");
+        return NGL_ERROR_IO;
+    }
+    return 0;
+}
+
+/*
+ * The file is read from the descriptor shared by a client running on the same
+ * host, so it is uploaded in one go instead of going through file parts. As
+ * with the file info of a remote upload, a file already present with the
+ * same size and hash is not copied again (it may be in use by the player).
+ */
+static int handle_tag_file_fd(struct ctx *s, const uint8_t *data, int size)
+{
+    if (size < 5 || data[size - 1] != 0) // check if string is nul-terminated
+        return NGL_ERROR_INVALID_DATA;
+    const int fd = ipc_pkt_get_fd(s->recv_pkt, IPC_U32_READ(data));
+    if (fd < 0)
+        return NGL_ERROR_INVALID_DATA;
+
+    if (s->upload_fp) {
+        fprintf(stderr, "a file is already uploading");
+        return NGL_ERROR_INVALID_USAGE;
+    }
+
+    int ret = get_upload_path(s, (const char *)data + 4);
+    if (ret < 0)
+        return ret;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || lseek(fd, 0, SEEK_SET) < 0) {
+        perror("file fd");
+        return NGL_ERROR_IO;
+    }
+
+    struct stat dst_st;
+    if (stat(s->upload_path, &dst_st) == 0 && dst_st.st_size == st.st_size) {
+        uint64_t hash;
+        ret = hash_fd(fd, &hash);
+        if (ret < 0)
+            return ret;
+        if (is_uploaded(s->upload_path, st.st_size, hash))
+            return ipc_pkt_add_rtag_fileend(s->send_pkt, s->upload_path);
+    }
+
+    const int dst_fd = open(s->upload_path, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+    if (dst_fd < 0) {
+        perror(s->upload_path);
+        return NGL_ERROR_IO;
+    }
+    ret = copy_file(dst_fd, fd, st.st_size);
+    close(dst_fd);
+    if (ret < 0)
+        return ret;
+
+    return ipc_pkt_add_rtag_fileend(s->send_pkt, s->upload_path);
+}
+#endif
+
 static int handle_tag_duration(const uint8_t *data, int size)
 {
     if (size != 8)
@@ -343,7 +600,13 @@ static int handle_commands(struct ctx *s, int fd)
             int ret;
             switch (tag) {
             case IPC_SCENE:        ret = handle_tag_scene(data, size);        break;
+            case IPC_SCENE_PATCH:  ret = handle_tag_scene_patch(data, size);  break;
             case IPC_FILE:         ret = handle_tag_file(s, data, size);      break;
+            case IPC_FILEINFO:     ret = handle_tag_fileinfo(s, data, size);  break;
+#ifndef _WIN32
+            case IPC_SCENE_FD:     ret = handle_tag_scene_fd(s, data, size);  break;
+            case IPC_FILE_FD:      ret = handle_tag_file_fd(s, data, size);   break;
+#endif
             case IPC_FILEPART:     ret = handle_tag_filepart(s, data, size);  break;
             case IPC_DURATION:     ret = handle_tag_duration(data, size);     break;
             case IPC_ASPECT_RATIO: ret = handle_tag_aspect_ratio(data, size); break;
@@ -412,16 +675,48 @@ static void close_conn(struct ctx *s, int conn_fd)
     close_upload_file(s);
 }
 
+static int accept_conn(struct ctx *s)
+{
+#ifdef _WIN32
+    const int conn_fd = accept(s->sock_fd, s->addr->ai_addr, &s->addr->ai_addrlen);
+#else
+    /*
+     * Clients running on the same host connect through the local socket, which
+     * allows them to share file descriptors instead of streaming the data.
+     */
+    struct pollfd fds[] = {
+        {.fd = s->sock_fd,       .events = POLLIN},
+        {.fd = s->local_fd,      .events = POLLIN},
+        {.fd = s->wakeup_fds[0], .events = POLLIN},
+    };
+    for (;;) {
+        if (poll(fds, ARRAY_NB(fds), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            return -1;
+        }
+        if (fds[2].revents) // server stop
+            return -1;
+        if (fds[0].revents || fds[1].revents)
+            break;
+    }
+    const int conn_fd = fds[1].revents ? accept(s->local_fd, NULL, NULL)
+                                       : accept(s->sock_fd, s->addr->ai_addr, &s->addr->ai_addrlen);
+#endif
+    if (conn_fd < 0)
+        perror("accept");
+    return conn_fd;
+}
+
 static void *server_start(void *arg)
 {
     struct ctx *s = arg;
 
     for (;;) {
-        const int conn_fd = accept(s->sock_fd, s->addr->ai_addr, &s->addr->ai_addrlen);
-        if (conn_fd < 0) {
-            perror("accept");
+        const int conn_fd = accept_conn(s);
+        if (conn_fd < 0)
             break;
-        }
         fprintf(stderr, ">> accepted client %d\n", conn_fd);
 
         pthread_mutex_lock(&s->lock);
@@ -446,6 +741,10 @@ static void stop_server(struct ctx *s)
     pthread_mutex_lock(&s->lock);
     s->stop_order = 1;
     pthread_mutex_unlock(&s->lock);
+#ifndef _WIN32
+    if (s->wakeup_fds[1] != -1 && write(s->wakeup_fds[1], "", 1) < 0)
+        perror("write");
+#endif
 }
 
 static struct ngl_node *get_default_scene(const char *host, const char *port)
@@ -536,6 +835,58 @@ static int setup_network(struct ctx *s)
     return 0;
 }
 
+static int setup_local_socket(struct ctx *s)
+{
+#ifndef _WIN32
+    if (pipe(s->wakeup_fds) < 0) {
+        perror("pipe");
+        return NGL_ERROR_IO;
+    }
+
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    int ret = ipc_get_local_socket_path(s->local_path, sizeof(s->local_path), s->host, s->port);
+    if (ret < 0 || strlen(s->local_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "local socket path is too long, only the network is available\n");
+        s->local_path[0] = 0;
+        return 0;
+    }
+    memcpy(addr.sun_path, s->local_path, strlen(s->local_path) + 1);
+
+    /* A stale socket may remain from a previous session which was not ended properly */
+    unlink(s->local_path);
+
+    /* The local socket is only an optimization: the clients fall back on the network */
+    s->local_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s->local_fd < 0 ||
+        bind(s->local_fd, (const struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(s->local_fd, 0) < 0) {
+        perror(s->local_path);
+        fprintf(stderr, "unable to setup the local socket, only the network is available\n");
+        if (s->local_fd != -1) {
+            close_socket(s->local_fd);
+            s->local_fd = -1;
+            unlink(s->local_path);
+        }
+        s->local_path[0] = 0;
+    }
+#endif
+    return 0;
+}
+
+static void remove_local_socket(struct ctx *s)
+{
+#ifndef _WIN32
+    if (s->local_fd != -1) {
+        close_socket(s->local_fd);
+        unlink(s->local_path);
+    }
+    if (s->wakeup_fds[0] != -1)
+        close(s->wakeup_fds[0]);
+    if (s->wakeup_fds[1] != -1)
+        close(s->wakeup_fds[1]);
+#endif
+}
+
 static int makedirs(const char *path, int mode)
 {
     char cur_path[1024];
@@ -603,6 +954,8 @@ int main(int argc, char *argv[])
         .cfg.clear_color[3] = 1.f,
         .lock               = PTHREAD_MUTEX_INITIALIZER,
         .sock_fd            = -1,
+        .local_fd           = -1,
+        .wakeup_fds         = {-1, -1},
         .player_ui          = 1,
         .framerate[0]       = 60,
         .framerate[1]       = 1,
@@ -627,6 +980,7 @@ int main(int argc, char *argv[])
     if ((ret = setup_paths(&s)) < 0 ||
         (ret = setup_network(&s)) < 0 ||
         (ret = create_session_file(&s)) < 0 ||
+        (ret = setup_local_socket(&s)) < 0 ||
         (ret = pthread_create(&s.thread, NULL, server_start, &s)) < 0)
         goto end;
     s.thread_started = 1;
@@ -654,6 +1008,8 @@ end:
     if (s.thread_started)
         pthread_join(s.thread, NULL);
 
+    remove_local_socket(&s);
+
     pthread_mutex_destroy(&s.lock);
 
     ipc_pkt_freep(&s.send_pkt);
@@ -32,9 +32,11 @@
 #include <Fileapi.h>
 #else
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netdb.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #endif
 
 #include <nodegl.h>
@@ -43,13 +45,15 @@
 #include "ipc.h"
 #include "opts.h"
 
-#define UPLOAD_CHUNK_SIZE (1024 * 1024)
+#define UPLOAD_CHUNK_SIZE (4 * 1024 * 1024)
+#define UPLOAD_WINDOW 4 // maximum number of file parts in flight
 
 struct ctx {
     /* options */
     const char *host;
     const char *port;
     const char *scene;
+    const char *prev_scene;
     int show_info;
     const char *uploadfile;
     double duration;
@@ -59,10 +63,13 @@ struct ctx {
     int samples;
     int reconfigure;
 
+    int local;
     struct ipc_pkt *send_pkt;
     struct ipc_pkt *recv_pkt;
     FILE *upload_fp;
     uint8_t *upload_buffer;
+    int upload_chunk_size;
+    int upload_started;
     int64_t upload_size;
     int64_t uploaded_size;
 };
@@ -72,6 +79,7 @@ static const struct opt options[] = {
     {"-x", "--host",          OPT_TYPE_STR,      .offset=OFFSET(host)},
     {"-p", "--port",          OPT_TYPE_STR,      .offset=OFFSET(port)},
     {"-f", "--scene",         OPT_TYPE_STR,      .offset=OFFSET(scene)},
+    {"-d", "--diff",          OPT_TYPE_STR,      .offset=OFFSET(prev_scene)},
     {"-?", "--info",          OPT_TYPE_TOGGLE,   .offset=OFFSET(show_info)},
     {"-u", "--uploadfile",    OPT_TYPE_STR,      .offset=OFFSET(uploadfile)},
     {"-t", "--duration",      OPT_TYPE_TIME,     .offset=OFFSET(duration)},
@@ -108,50 +116,141 @@ static int get_filesize(const char *filename, int64_t *size)
     return 0;
 }
 
+#ifndef _WIN32
+/* Anonymous temporary file, which is usually backed by memory */
+static int get_tmpfile_fd(const char *data)
+{
+    FILE *fp = tmpfile();
+    if (!fp) {
+        perror("tmpfile");
+        return -1;
+    }
+    const size_t size = strlen(data);
+    int fd = -1;
+    if (fwrite(data, 1, size, fp) == size && !fflush(fp))
+        fd = dup(fileno(fp));
+    fclose(fp);
+    return fd;
+}
+#endif
+
+static int add_scene(struct ctx *s, struct ipc_pkt *pkt, const char *serial_scene)
+{
+#ifndef _WIN32
+    /*
+     * Local clients only share a descriptor to the scene, which saves the
+     * copies through the socket
+     */
+    if (s->local) {
+        const int fd = get_tmpfile_fd(serial_scene);
+        if (fd >= 0)
+            return ipc_pkt_add_qtag_scene_fd(pkt, fd);
+    }
+#endif
+    return ipc_pkt_add_qtag_scene(pkt, serial_scene);
+}
+
+static int add_upload(struct ctx *s, struct ipc_pkt *pkt)
+{
+    char name[512];
+    const size_t name_len = strcspn(s->uploadfile, "=");
+    if (s->uploadfile[name_len] != '=') {
+        fprintf(stderr, "upload file does not match \"remotename=localname\" format\n");
+        return NGL_ERROR_INVALID_ARG;
+    }
+    if (name_len >= sizeof(name)) {
+        fprintf(stderr, "remote file name too long %zd >= %zd\n", name_len, sizeof(name));
+        return NGL_ERROR_MEMORY;
+    }
+    int n = snprintf(name, sizeof(name), "%.*s", (int)name_len, s->uploadfile);
+    if (n < 0 || n >= sizeof(name))
+        return NGL_ERROR_MEMORY;
+    const size_t name_size = name_len + 1;
+
+    const char *filename = s->uploadfile + name_size;
+
+#ifndef _WIN32
+    /* The server reads the whole file at once from the shared descriptor */
+    if (s->local) {
+        const int fd = open(filename, O_RDONLY);
+        if (fd < 0) {
+            perror(filename);
+            return NGL_ERROR_IO;
+        }
+        s->upload_started = 1;
+        return ipc_pkt_add_qtag_file_fd(pkt, name, fd);
+    }
+#endif
+
+    int ret = get_filesize(filename, &s->upload_size);
+    if (ret < 0)
+        return ret;
+
+    s->upload_fp = fopen(filename, "rb");
+    if (!s->upload_fp) {
+        perror("fopen");
+        return NGL_ERROR_IO;
+    }
+
+    /* The hash allows the server to skip the files it already has */
+    uint64_t hash;
+    ret = ipc_hash_file(s->upload_fp, &hash);
+    if (ret < 0)
+        return ret;
+    rewind(s->upload_fp);
+
+    s->upload_chunk_size = UPLOAD_CHUNK_SIZE;
+    s->upload_buffer = malloc(s->upload_chunk_size);
+    if (!s->upload_buffer)
+        return NGL_ERROR_MEMORY;
+
+    ret = ipc_pkt_add_qtag_file(pkt, name);
+    if (ret < 0)
+        return ret;
+    return ipc_pkt_add_qtag_fileinfo(pkt, s->upload_size, hash, s->upload_chunk_size);
+}
+
 static int craft_packet(struct ctx *s, struct ipc_pkt *pkt)
 {
+#ifndef _WIN32
+    if (s->scene && s->local && !s->prev_scene && strcmp(s->scene, "-")) {
+        const int fd = open(s->scene, O_RDONLY);
+        if (fd < 0) {
+            perror(s->scene);
+            return NGL_ERROR_IO;
+        }
+        int ret = ipc_pkt_add_qtag_scene_fd(pkt, fd);
+        if (ret < 0)
+            return ret;
+    } else
+#endif
     if (s->scene) {
         char *serial_scene = get_text_file_content(strcmp(s->scene, "-") ? s->scene : NULL);
         if (!serial_scene)
             return -1;
-        int ret = ipc_pkt_add_qtag_scene(pkt, serial_scene);
-        free(serial_scene);
-        if (ret < 0)
-            return ret;
-    }
 
-    if (s->uploadfile) {
-        char name[512];
-        const size_t name_len = strcspn(s->uploadfile, "=");
-        if (s->uploadfile[name_len] != '=') {
-            fprintf(stderr, "upload file does not match \"remotename=localname\" format\n");
-            return NGL_ERROR_INVALID_ARG;
+        /*
+         * Only send the changes against the scene previously sent when
+         * possible, and fallback on the full scene otherwise
+         */
+        char *patch = NULL;
+        if (s->prev_scene) {
+            char *prev_serial_scene = get_text_file_content(s->prev_scene);
+            if (prev_serial_scene)
+                patch = ngl_node_diff(prev_serial_scene, serial_scene);
+            free(prev_serial_scene);
         }
-        if (name_len >= sizeof(name)) {
-            fprintf(stderr, "remote file name too long %zd >= %zd\n", name_len, sizeof(name));
-            return NGL_ERROR_MEMORY;
-        }
-        int n = snprintf(name, sizeof(name), "%.*s", (int)name_len, s->uploadfile);
-        if (n < 0 || n >= sizeof(name))
-            return NGL_ERROR_MEMORY;
-        const size_t name_size = name_len + 1;
 
-        const char *filename = s->uploadfile + name_size;
-        int ret = get_filesize(filename, &s->upload_size);
+        int ret = patch ? ipc_pkt_add_qtag_scene_patch(pkt, patch)
+                        : add_scene(s, pkt, serial_scene);
+        free(patch);
+        free(serial_scene);
         if (ret < 0)
             return ret;
+    }
 
-        s->upload_fp = fopen(filename, "rb");
-        if (!s->upload_fp) {
-            perror("fopen");
-            return NGL_ERROR_IO;
-        }
-
-        s->upload_buffer = malloc(UPLOAD_CHUNK_SIZE);
-        if (!s->upload_buffer)
-            return NGL_ERROR_MEMORY;
-
-        ret = ipc_pkt_add_qtag_file(pkt, name);
+    if (s->uploadfile) {
+        int ret = add_upload(s, pkt);
         if (ret < 0)
             return ret;
     }
@@ -219,6 +318,18 @@ static int handle_info(const uint8_t *data, int size)
     return 0;
 }
 
+static int handle_fileinfo(struct ctx *s, const uint8_t *data, int size)
+{
+    if (size != 4)
+        return NGL_ERROR_INVALID_DATA;
+    const int chunk_size = IPC_U32_READ(data);
+    if (chunk_size <= 0 || chunk_size > s->upload_chunk_size)
+        return NGL_ERROR_INVALID_DATA;
+    s->upload_chunk_size = chunk_size;
+    s->upload_started = 1;
+    return 0;
+}
+
 static int handle_filepart(struct ctx *s, const uint8_t *data, int size)
 {
     if (size != 4)
@@ -233,7 +344,7 @@ static int handle_fileend(struct ctx *s, const uint8_t *data, int size)
 {
     if (size < 1 || data[size - 1] != 0) // check if string is nul-terminated
         return NGL_ERROR_INVALID_DATA;
-    fprintf(stderr, "\ruploading %s... done\n", s->uploadfile);
+    fprintf(stderr, "\ruploading %s... %s\n", s->uploadfile, s->upload_started ? "done" : "already uploaded");
     close_upload_file(s);
     const char *filename = (const char *)data;
     printf("%s\n", filename);
@@ -260,6 +371,7 @@ static int handle_response(struct ctx *s, const struct ipc_pkt *pkt)
         int ret;
         switch (tag) {
         case IPC_INFO:      ret = handle_info(data, size);        break;
+        case IPC_FILEINFO:  ret = handle_fileinfo(s, data, size); break;
         case IPC_FILEPART:  ret = handle_filepart(s, data, size); break;
         case IPC_FILEEND:   ret = handle_fileend(s, data, size);  break;
         default:
@@ -274,20 +386,108 @@ static int handle_response(struct ctx *s, const struct ipc_pkt *pkt)
         data_size -= size;
     }
 
-    if (s->upload_fp) {
-        ipc_pkt_reset(s->send_pkt);
+    return 0;
+}
 
-        const size_t n = fread(s->upload_buffer, 1, UPLOAD_CHUNK_SIZE, s->upload_fp);
-        if (ferror(s->upload_fp))
-            return NGL_ERROR_IO;
-        int ret = ipc_pkt_add_qtag_filepart(s->send_pkt, s->upload_buffer, n);
+/*
+ * Several file parts are sent before waiting for their acknowledgement so the
+ * throughput is not bound by the round trip time. The last part is empty and
+ * its response is the end of the upload.
+ */
+static int upload_file(struct ctx *s, int fd)
+{
+    int nb_in_flight = 0;
+    int eof = 0;
+    while (s->upload_fp) {
+        while (!eof && nb_in_flight < UPLOAD_WINDOW) {
+            ipc_pkt_reset(s->send_pkt);
+
+            const size_t n = fread(s->upload_buffer, 1, s->upload_chunk_size, s->upload_fp);
+            if (ferror(s->upload_fp))
+                return NGL_ERROR_IO;
+            eof = n == 0;
+            int ret = ipc_pkt_add_qtag_filepart(s->send_pkt, s->upload_buffer, n);
+            if (ret < 0)
+                return ret;
+            ret = ipc_send(fd, s->send_pkt);
+            if (ret < 0)
+                return ret;
+            nb_in_flight++;
+        }
+
+        int ret = ipc_recv(fd, s->recv_pkt);
+        if (ret <= 0)
+            return ret < 0 ? ret : NGL_ERROR_IO;
+        ret = handle_response(s, s->recv_pkt);
         if (ret < 0)
             return ret;
+        nb_in_flight--;
     }
-
     return 0;
 }
 
+/*
+ * When ngl-desktop runs on the same host, its local socket is preferred so
+ * that the scenes and files can be shared through file descriptors
+ */
+static int connect_local(struct ctx *s)
+{
+#ifdef _WIN32
+    return -1;
+#else
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    int ret = ipc_get_local_socket_path(addr.sun_path, sizeof(addr.sun_path), s->host, s->port);
+    if (ret < 0)
+        return ret;
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    s->local = 1;
+    return fd;
+#endif
+}
+
+static int connect_network(struct ctx *s)
+{
+    struct addrinfo hints = {
+        .ai_family   = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+
+    struct addrinfo *addr_info = NULL;
+    int ret = getaddrinfo(s->host, s->port, &hints, &addr_info);
+    if (ret) {
+        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(ret));
+        return -1;
+    }
+
+    int fd = -1;
+    struct addrinfo *rp;
+    for (rp = addr_info; rp; rp = rp->ai_next) {
+        fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+        if (fd < 0)
+            continue;
+
+        ret = connect(fd, rp->ai_addr, rp->ai_addrlen);
+        if (ret != -1)
+            break;
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(addr_info);
+
+    if (!rp)
+        fprintf(stderr, "unable to connect to %s\n", s->host);
+    return fd;
+}
+
 int main(int argc, char *argv[])
 {
     struct ctx s = {
@@ -306,6 +506,8 @@ int main(int argc, char *argv[])
         return ret == OPT_HELP ? 0 : EXIT_FAILURE;
     }
 
+    int fd = -1;
+
 #ifdef _WIN32
     WSADATA wsa_data;
     int sret = WSAStartup(MAKEWORD(2, 2), &wsa_data);
@@ -315,9 +517,6 @@ int main(int argc, char *argv[])
     }
 #endif
 
-    struct addrinfo *addr_info = NULL;
-    int fd = -1;
-
     s.send_pkt = ipc_pkt_create();
     s.recv_pkt = ipc_pkt_create();
     if (!s.send_pkt || !s.recv_pkt) {
@@ -325,59 +524,35 @@ int main(int argc, char *argv[])
         goto end;
     }
 
-    ret = craft_packet(&s, s.send_pkt);
-    if (ret < 0)
-        goto end;
-
-    struct addrinfo hints = {
-        .ai_family   = AF_UNSPEC,
-        .ai_socktype = SOCK_STREAM,
-    };
-
-    ret = getaddrinfo(s.host, s.port, &hints, &addr_info);
-    if (ret) {
-        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(ret));
+    fd = connect_local(&s);
+    if (fd < 0)
+        fd = connect_network(&s);
+    if (fd < 0) {
         ret = EXIT_FAILURE;
         goto end;
     }
 
-    struct addrinfo *rp;
-    for (rp = addr_info; rp; rp = rp->ai_next) {
-        fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
-        if (fd < 0)
-            continue;
-
-        ret = connect(fd, rp->ai_addr, rp->ai_addrlen);
-        if (ret != -1)
-            break;
-
-        close(fd);
-    }
-
-    if (!rp) {
-        fprintf(stderr, "unable to connect to %s\n", s.host);
-        ret = EXIT_FAILURE;
+    /* The packet content depends on whether the server is local or not */
+    ret = craft_packet(&s, s.send_pkt);
+    if (ret < 0)
         goto end;
-    }
 
-    do {
-        ret = ipc_send(fd, s.send_pkt);
-        if (ret < 0)
-            goto end;
+    ret = ipc_send(fd, s.send_pkt);
+    if (ret < 0)
+        goto end;
 
-        ret = ipc_recv(fd, s.recv_pkt);
-        if (ret < 0)
-            goto end;
+    ret = ipc_recv(fd, s.recv_pkt);
+    if (ret < 0)
+        goto end;
 
-        ret = handle_response(&s, s.recv_pkt);
-        if (ret < 0)
-            goto end;
+    ret = handle_response(&s, s.recv_pkt);
+    if (ret < 0)
+        goto end;
 
-    } while (s.upload_fp);
+    if (s.upload_fp)
+        ret = upload_file(&s, fd);
 
 end:
-    if (addr_info)
-        freeaddrinfo(addr_info);
     close_upload_file(&s);
     ipc_pkt_freep(&s.send_pkt);
     ipc_pkt_freep(&s.recv_pkt);
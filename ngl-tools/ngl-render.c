@@ -19,6 +19,8 @@
  * under the License.
  */
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,24 +33,92 @@
 #else
 #include <unistd.h>
 #endif
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 
 #include <nodegl.h>
 
 #include "common.h"
 #include "opts.h"
+#include "writer.h"
 #include "wsi.h"
 
 #ifndef O_BINARY
 #define O_BINARY 0
 #endif
 
+static int is_bin_scene(const char *filename)
+{
+    if (!filename)
+        return 0;
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+        return 0;
+    char magic[4];
+    const size_t n = fread(magic, 1, sizeof(magic), fp);
+    fclose(fp);
+    return n == sizeof(magic) && !memcmp(magic, "NGLB", sizeof(magic));
+}
+
+static struct ngl_node *get_bin_scene(const char *filename)
+{
+    const int fd = open(filename, O_RDONLY | O_BINARY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+    const size_t size = st.st_size;
+
+#ifdef _WIN32
+    void *data = malloc(size);
+    if (!data || read(fd, data, size) != (int)size) {
+        free(data);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    struct ngl_node *scene = ngl_node_deserialize_bin(data, size);
+    free(data);
+#else
+    /* The scene data is mapped rather than read, then copied by the deserialization */
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+    struct ngl_node *scene = ngl_node_deserialize_bin(data, size);
+    munmap(data, size);
+#endif
+    return scene;
+}
+
+static int read_scene_chunk(void *arg, char *buf, int size)
+{
+    FILE *fp = arg;
+    const size_t n = fread(buf, 1, size, fp);
+    if (ferror(fp))
+        return NGL_ERROR_IO;
+    return (int)n;
+}
+
 static struct ngl_node *get_scene(const char *filename)
 {
-    char *buf = get_text_file_content(filename);
-    if (!buf)
+    if (is_bin_scene(filename))
+        return get_bin_scene(filename);
+
+    /* Text scenes are parsed while being read to avoid holding the whole file */
+    FILE *fp = filename ? fopen(filename, "rb") : stdin;
+    if (!fp) {
+        fprintf(stderr, "unable to open %s\n", filename);
         return NULL;
-    struct ngl_node *scene = ngl_node_deserialize(buf);
-    free(buf);
+    }
+    struct ngl_node *scene = ngl_node_deserialize_stream(fp, read_scene_chunk);
+    if (fp != stdin)
+        fclose(fp);
     return scene;
 }
 
@@ -58,6 +128,8 @@ struct range {
     int freq;
 };
 
+struct job;
+
 struct ctx {
     /* options */
     int log_level;
@@ -68,6 +140,35 @@ struct ctx {
     struct range *ranges;
     int nb_ranges;
     int aspect[2];
+    int nb_jobs;
+    int format;
+    int pix_fmt;
+
+    /* parallel rendering */
+    char *serial_scene;
+    struct writer *writer;
+    struct job *jobs;
+    int64_t *range_nb_frames;
+    int64_t nb_frames;
+    int chunk_nb_frames;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int64_t next_chunk;
+    int error;
+};
+
+/*
+ * The frames of all the ranges are split in chunks of contiguous frames
+ * distributed in turn to the jobs, each rendering with its own context. A job
+ * keeps the frames of its current chunk in memory until all the previous
+ * chunks are written, so that the output is written in order.
+ */
+struct job {
+    struct ctx *s;
+    int index;
+    uint8_t *frames;
+    int ret;
+    pthread_t thread;
 };
 
 static int opt_timerange(const char *arg, void *dst)
@@ -93,6 +194,40 @@ static int opt_timerange(const char *arg, void *dst)
     return 0;
 }
 
+static int opt_format(const char *arg, void *dst)
+{
+    static const char *names[] = {
+        [WRITER_FORMAT_RAW] = "raw",
+        [WRITER_FORMAT_Y4M] = "y4m",
+        [WRITER_FORMAT_NUT] = "nut",
+    };
+    for (int i = 0; i < ARRAY_NB(names); i++) {
+        if (!strcmp(arg, names[i])) {
+            *(int *)dst = i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Invalid output format \"%s\" (raw, y4m or nut expected)\n", arg);
+    return NGL_ERROR_INVALID_ARG;
+}
+
+static int opt_pix_fmt(const char *arg, void *dst)
+{
+    static const char *names[] = {
+        [WRITER_PIX_FMT_RGBA]    = "rgba",
+        [WRITER_PIX_FMT_NV12]    = "nv12",
+        [WRITER_PIX_FMT_YUV420P] = "yuv420p",
+    };
+    for (int i = 0; i < ARRAY_NB(names); i++) {
+        if (!strcmp(arg, names[i])) {
+            *(int *)dst = i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Invalid pixel format \"%s\" (rgba, nv12 or yuv420p expected)\n", arg);
+    return NGL_ERROR_INVALID_ARG;
+}
+
 #define OFFSET(x) offsetof(struct ctx, x)
 static const struct opt options[] = {
     {"-d", "--debug",         OPT_TYPE_TOGGLE,   .offset=OFFSET(debug)},
@@ -107,8 +242,237 @@ static const struct opt options[] = {
     {"-z", "--swap_interval", OPT_TYPE_INT,      .offset=OFFSET(cfg.swap_interval)},
     {"-c", "--clear_color",   OPT_TYPE_COLOR,    .offset=OFFSET(cfg.clear_color)},
     {"-m", "--samples",       OPT_TYPE_INT,      .offset=OFFSET(cfg.samples)},
+    {"-e", "--elide_static",  OPT_TYPE_TOGGLE,   .offset=OFFSET(cfg.elide_static_frames)},
+    {"-j", "--jobs",          OPT_TYPE_INT,      .offset=OFFSET(nb_jobs)},
+    {"-f", "--format",        OPT_TYPE_CUSTOM,   .offset=OFFSET(format), .func=opt_format},
+    {"-p", "--pix_fmt",       OPT_TYPE_CUSTOM,   .offset=OFFSET(pix_fmt), .func=opt_pix_fmt},
 };
 
+static float get_range_time(const struct range *r, int64_t k)
+{
+    return r->start + k*1./r->freq;
+}
+
+static int64_t get_range_nb_frames(const struct range *r)
+{
+    const float t1 = r->start + r->duration;
+    int64_t k = 0;
+    while (get_range_time(r, k) < t1)
+        k++;
+    return k;
+}
+
+/* Time of a frame, indexed over the concatenation of all the ranges */
+static float get_frame_time(const struct ctx *s, int64_t frame)
+{
+    for (int i = 0; i < s->nb_ranges; i++) {
+        const int64_t nb_frames = s->range_nb_frames[i];
+        if (frame < nb_frames)
+            return get_range_time(&s->ranges[i], frame);
+        frame -= nb_frames;
+    }
+    return -1.f;
+}
+
+static int get_error(struct ctx *s)
+{
+    pthread_mutex_lock(&s->lock);
+    const int error = s->error;
+    pthread_mutex_unlock(&s->lock);
+    return error;
+}
+
+static void set_error(struct ctx *s)
+{
+    pthread_mutex_lock(&s->lock);
+    s->error = 1;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/* Queue the frames of a chunk to the writer once the previous chunks are */
+static int write_chunk(struct job *job, int64_t chunk, int nb_frames)
+{
+    struct ctx *s = job->s;
+    const size_t frame_size = 4 * s->cfg.width * s->cfg.height;
+
+    pthread_mutex_lock(&s->lock);
+    while (s->next_chunk != chunk && !s->error)
+        pthread_cond_wait(&s->cond, &s->lock);
+    const int error = s->error;
+    pthread_mutex_unlock(&s->lock);
+    if (error)
+        return 0;
+
+    int ret = 0;
+    for (int i = 0; i < nb_frames && ret >= 0; i++)
+        ret = writer_queue_frame(s->writer, job->frames + i * frame_size);
+
+    pthread_mutex_lock(&s->lock);
+    s->next_chunk++;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    return ret;
+}
+
+static int run_job(struct job *job)
+{
+    struct ctx *s = job->s;
+    struct ngl_ctx *ctx = NULL;
+    struct ngl_node *scene = NULL;
+    struct ngl_config cfg = s->cfg;
+    const size_t frame_size = 4 * cfg.width * cfg.height;
+
+    int ret = NGL_ERROR_MEMORY;
+    uint8_t *capture_buffer = NULL;
+    if (s->writer) {
+        capture_buffer = calloc(cfg.width * cfg.height, 4);
+        job->frames = malloc(s->chunk_nb_frames * frame_size);
+        if (!capture_buffer || !job->frames)
+            goto end;
+    }
+    cfg.capture_buffer = capture_buffer;
+
+    /* A scene can only be attached to one context, so every job has its own */
+    scene = ngl_node_deserialize(s->serial_scene);
+    ctx = ngl_create();
+    if (!scene || !ctx)
+        goto end;
+
+    if ((ret = ngl_configure(ctx, &cfg)) < 0 ||
+        (ret = ngl_set_scene(ctx, scene)) < 0)
+        goto end;
+
+    const int64_t chunk_nb_frames = s->chunk_nb_frames;
+    for (int64_t chunk = job->index; chunk * chunk_nb_frames < s->nb_frames; chunk += s->nb_jobs) {
+        const int64_t start_frame = chunk * chunk_nb_frames;
+        int64_t end_frame = start_frame + chunk_nb_frames;
+        if (end_frame > s->nb_frames)
+            end_frame = s->nb_frames;
+        for (int64_t i = start_frame; i < end_frame; i++) {
+            if (get_error(s))
+                goto end;
+
+            const float t = get_frame_time(s, i);
+            if (s->debug)
+                printf("draw @ t=%f [job %d/%d]\n", t, job->index + 1, s->nb_jobs);
+            ret = ngl_draw(ctx, t);
+            if (ret < 0) {
+                fprintf(stderr, "Unable to draw @ t=%g\n", t);
+                goto end;
+            }
+            /* An elided frame leaves the capture buffer untouched, so it is copied */
+            if (capture_buffer)
+                memcpy(job->frames + (i - start_frame) * frame_size, capture_buffer, frame_size);
+        }
+        if (capture_buffer) {
+            ret = write_chunk(job, chunk, (int)(end_frame - start_frame));
+            if (ret < 0)
+                goto end;
+        }
+    }
+
+end:
+    ngl_node_unrefp(&scene);
+    ngl_freep(&ctx);
+    free(capture_buffer);
+    free(job->frames);
+    job->frames = NULL;
+    return ret;
+}
+
+static void *job_thread(void *arg)
+{
+    struct job *job = arg;
+    job->ret = run_job(job);
+    if (job->ret < 0)
+        set_error(job->s);
+    return NULL;
+}
+
+/* The frames of the chunks kept in memory by the jobs are bounded by this size */
+#define MAX_CHUNK_SIZE (64 << 20)
+#define MAX_CHUNK_NB_FRAMES 32
+
+static int render_parallel(struct ctx *s, struct ngl_node *scene, struct writer *writer)
+{
+    if (!s->cfg.offscreen) {
+        fprintf(stderr, "Parallel rendering is only supported offscreen\n");
+        return EXIT_FAILURE;
+    }
+
+    s->serial_scene = ngl_node_serialize(scene);
+    if (!s->serial_scene)
+        return EXIT_FAILURE;
+
+    s->range_nb_frames = calloc(s->nb_ranges, sizeof(*s->range_nb_frames));
+    if (!s->range_nb_frames)
+        return EXIT_FAILURE;
+
+    s->nb_frames = 0;
+    for (int i = 0; i < s->nb_ranges; i++) {
+        s->range_nb_frames[i] = get_range_nb_frames(&s->ranges[i]);
+        s->nb_frames += s->range_nb_frames[i];
+    }
+
+    const size_t frame_size = 4 * s->cfg.width * s->cfg.height;
+    s->chunk_nb_frames = MAX_CHUNK_SIZE / frame_size;
+    if (s->chunk_nb_frames < 1)
+        s->chunk_nb_frames = 1;
+    else if (s->chunk_nb_frames > MAX_CHUNK_NB_FRAMES)
+        s->chunk_nb_frames = MAX_CHUNK_NB_FRAMES;
+
+    s->jobs = calloc(s->nb_jobs, sizeof(*s->jobs));
+    if (!s->jobs) {
+        free(s->range_nb_frames);
+        s->range_nb_frames = NULL;
+        return EXIT_FAILURE;
+    }
+    s->writer = writer;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+
+    const int64_t start = gettime_relative();
+
+    int nb_started = 0;
+    for (int i = 0; i < s->nb_jobs; i++) {
+        struct job *job = &s->jobs[i];
+        job->s     = s;
+        job->index = i;
+        if (pthread_create(&job->thread, NULL, job_thread, job)) {
+            job->ret = NGL_ERROR_GENERIC;
+            set_error(s);
+            break;
+        }
+        nb_started++;
+    }
+
+    int ret = 0;
+    for (int i = 0; i < s->nb_jobs; i++) {
+        struct job *job = &s->jobs[i];
+        if (i < nb_started)
+            pthread_join(job->thread, NULL);
+        if (job->ret < 0)
+            ret = EXIT_FAILURE;
+    }
+    if (writer && writer_flush(writer) < 0)
+        ret = EXIT_FAILURE;
+
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    free(s->jobs);
+    s->jobs = NULL;
+    free(s->range_nb_frames);
+    s->range_nb_frames = NULL;
+
+    if (!ret) {
+        const double tdiff = (gettime_relative() - start) / 1000000.;
+        printf("Rendered %" PRId64 " frames in %g with %d jobs (FPS=%g)\n",
+               s->nb_frames, tdiff, s->nb_jobs, s->nb_frames / tdiff);
+    }
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
     struct ctx s = {
@@ -122,6 +486,9 @@ int main(int argc, char *argv[])
         .cfg.clear_color[3] = 1.f,
         .aspect[0]          = 1,
         .aspect[1]          = 1,
+        .nb_jobs            = 1,
+        .format             = WRITER_FORMAT_RAW,
+        .pix_fmt            = -1,
     };
 
     SDL_Window *window = NULL;
@@ -139,6 +506,15 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (s.nb_jobs < 1) {
+        fprintf(stderr, "Invalid number of jobs %d\n", s.nb_jobs);
+        return EXIT_FAILURE;
+    }
+
+    /* y4m only supports planar YUV */
+    if (s.pix_fmt == -1)
+        s.pix_fmt = s.format == WRITER_FORMAT_Y4M ? WRITER_PIX_FMT_YUV420P : WRITER_PIX_FMT_RGBA;
+
     printf("%s -> %s %dx%d\n", s.input ? s.input : "<stdin>", s.output ? s.output : "-", s.cfg.width, s.cfg.height);
 
     if (!s.cfg.offscreen) {
@@ -155,6 +531,7 @@ int main(int argc, char *argv[])
     int fd = -1;
     struct ngl_ctx *ctx = NULL;
     uint8_t *capture_buffer = NULL;
+    struct writer *writer = NULL;
 
     struct ngl_node *scene = get_scene(s.input);
     if (!scene) {
@@ -181,6 +558,30 @@ int main(int argc, char *argv[])
         capture_buffer = calloc(s.cfg.width * s.cfg.height, 4);
         if (!capture_buffer)
             goto end;
+
+        /* The headers use the rate of the first range */
+        const struct writer_params params = {
+            .fd      = fd,
+            .width   = s.cfg.width,
+            .height  = s.cfg.height,
+            .rate    = {s.ranges[0].freq, 1},
+            .format  = s.format,
+            .pix_fmt = s.pix_fmt,
+        };
+        writer = writer_create(&params);
+        if (!writer) {
+            ngl_node_unrefp(&scene);
+            ret = EXIT_FAILURE;
+            goto end;
+        }
+    }
+
+    get_viewport(s.cfg.width, s.cfg.height, s.aspect, s.cfg.viewport);
+
+    if (s.nb_jobs > 1) {
+        ret = render_parallel(&s, scene, writer);
+        ngl_node_unrefp(&scene);
+        goto end;
     }
 
     ctx = ngl_create();
@@ -189,7 +590,6 @@ int main(int argc, char *argv[])
         goto end;
     }
 
-    get_viewport(s.cfg.width, s.cfg.height, s.aspect, s.cfg.viewport);
     s.cfg.capture_buffer = capture_buffer;
 
     if (!s.cfg.offscreen) {
@@ -231,8 +631,11 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Unable to draw @ t=%g\n", t);
                 goto end;
             }
-            if (capture_buffer)
-                write(fd, capture_buffer, 4 * s.cfg.width * s.cfg.height);
+            if (writer) {
+                ret = writer_queue_frame(writer, capture_buffer);
+                if (ret < 0)
+                    goto end;
+            }
             if (!s.cfg.offscreen) {
                 SDL_Event event;
                 while (SDL_PollEvent(&event)) {
@@ -246,14 +649,19 @@ int main(int argc, char *argv[])
         printf("Rendered %d frames in %g (FPS=%g)\n", k, tdiff, k / tdiff);
     }
 
+    if (writer)
+        ret = writer_flush(writer);
+
 end:
     ngl_freep(&ctx);
+    writer_freep(&writer);
 
     if (fd != -1)
         close(fd);
 
     free(capture_buffer);
     free(s.ranges);
+    free(s.serial_scene);
 
     if (!s.cfg.offscreen) {
         SDL_DestroyWindow(window);
@@ -50,12 +50,18 @@ static FILE *open_ofile(const char *output)
     return fopen(output, "wb");
 }
 
+static int has_bin_ext(const char *output)
+{
+    const char *ext = strrchr(output, '.');
+    return ext && !strcmp(ext, ".nglb");
+}
+
 int main(int argc, char *argv[])
 {
     int ret = 0;
 
     if (argc != 4) {
-        fprintf(stderr, "Usage: %s <module> <scene_func> <output.ngl>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <module> <scene_func> <output.ngl|output.nglb>\n", argv[0]);
         return 0;
     }
 
@@ -69,15 +75,23 @@ int main(int argc, char *argv[])
         goto end;
     }
 
-    char *serialized_scene = ngl_node_serialize(scene);
+    size_t slen = 0;
+    void *serialized_scene = NULL;
+    if (has_bin_ext(argv[3])) {
+        serialized_scene = ngl_node_serialize_bin(scene, &slen);
+    } else {
+        serialized_scene = ngl_node_serialize(scene);
+        if (serialized_scene)
+            slen = strlen(serialized_scene);
+    }
     ngl_node_unrefp(&scene);
     if (!serialized_scene) {
         ret = EXIT_FAILURE;
         goto end;
     }
 
-    const size_t slen = strlen(serialized_scene);
     const size_t n = fwrite(serialized_scene, 1, slen, of);
+    free(serialized_scene);
     if (n != slen) {
         ret = EXIT_FAILURE;
         goto end;
@@ -427,11 +427,11 @@ static int set_scene(struct ngl_node *scene)
     struct player *p = g_player;
 
     if (p->enable_ui) {
-        scene = add_progress_bar(scene);
-        if (!scene)
+        struct ngl_node *group = add_progress_bar(scene);
+        if (!group)
             return NGL_ERROR_MEMORY;
-        ret = ngl_set_scene(p->ngl, scene);
-        ngl_node_unrefp(&scene);
+        ret = ngl_set_scene(p->ngl, group);
+        ngl_node_unrefp(&group);
     } else {
         ret = ngl_set_scene(p->ngl, scene);
     }
@@ -439,6 +439,14 @@ static int set_scene(struct ngl_node *scene)
         p->pgbar_opacity_node  = NULL;
         p->pgbar_duration_node = NULL;
         p->pgbar_text_node     = NULL;
+        ngl_node_unrefp(&p->scene);
+        return ret;
+    }
+
+    /* Keep track of the user scene so it can be patched later on */
+    if (scene != p->scene) {
+        ngl_node_unrefp(&p->scene);
+        p->scene = scene ? ngl_node_ref(scene) : NULL;
     }
     return ret;
 }
@@ -527,6 +535,7 @@ void player_uninit(void)
             free(event.user.data1);
 
     ngl_freep(&p->ngl);
+    ngl_node_unrefp(&p->scene);
     SDL_DestroyWindow(p->window);
     SDL_Quit();
 }
@@ -541,6 +550,30 @@ static int handle_scene(const void *data)
     return ret;
 }
 
+static int handle_scene_patch(const void *data)
+{
+    struct player *p = g_player;
+
+    if (!p->scene)
+        return 0;
+
+    int ret = ngl_node_patch(p->scene, data);
+    if (ret == NGL_ERROR_INVALID_USAGE) {
+        /* Some of the parameters can not be changed while the scene is live */
+        struct ngl_node *scene = ngl_node_ref(p->scene);
+        kill_scene();
+        ret = ngl_node_patch(scene, data);
+        const int set_ret = set_scene(scene);
+        ngl_node_unrefp(&scene);
+        if (ret >= 0)
+            ret = set_ret;
+    }
+    /* The patch was likely computed against another scene: keep running */
+    if (ret < 0)
+        fprintf(stderr, "unable to patch the scene: %d\n", ret);
+    return 0;
+}
+
 static int handle_duration(const void *data)
 {
     struct player *p = g_player;
@@ -604,6 +637,7 @@ typedef int (*handle_func)(const void *data);
 
 static const handle_func handle_map[] = {
     [PLAYER_SIGNAL_SCENE]        = handle_scene,
+    [PLAYER_SIGNAL_SCENE_PATCH]  = handle_scene_patch,
     [PLAYER_SIGNAL_DURATION]     = handle_duration,
     [PLAYER_SIGNAL_ASPECT_RATIO] = handle_aspect_ratio,
     [PLAYER_SIGNAL_FRAMERATE]    = handle_framerate,
@@ -34,6 +34,7 @@
  */
 enum player_signal {
     PLAYER_SIGNAL_SCENE,
+    PLAYER_SIGNAL_SCENE_PATCH,
     PLAYER_SIGNAL_DURATION,
     PLAYER_SIGNAL_ASPECT_RATIO,
     PLAYER_SIGNAL_FRAMERATE,
@@ -54,6 +55,7 @@ struct player {
     int framerate[2];
 
     struct ngl_ctx *ngl;
+    struct ngl_node *scene;
     struct ngl_config ngl_config;
     int64_t clock_off;
     int64_t frame_ts;
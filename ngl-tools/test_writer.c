@@ -0,0 +1,284 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32) && defined(_MSC_VER)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <nodegl.h>
+
+#include "writer.h"
+
+#define NB_FRAMES 2
+
+#define check(cond) do {                                \
+    if (!(cond)) {                                      \
+        fprintf(stderr, "Assert %s @ %s:%d\n",          \
+                #cond, __FILE__, __LINE__);             \
+        abort();                                        \
+    }                                                   \
+} while (0)
+
+struct output {
+    uint8_t *data;
+    size_t size;
+};
+
+/*
+ * Write NB_FRAMES frames of the specified color (the first one from the
+ * calling thread, the others through the writer thread) into a temporary file
+ * and read them back
+ */
+static void write_frames(struct output *out, const struct writer_params *params, const uint8_t *color)
+{
+    FILE *f = tmpfile();
+    check(f);
+
+    struct writer_params par = *params;
+    par.fd = fileno(f);
+    struct writer *w = writer_create(&par);
+    check(w);
+
+    const size_t rgba_size = 4 * par.width * par.height;
+    uint8_t *rgba = malloc(rgba_size);
+    check(rgba);
+    for (size_t i = 0; i < rgba_size; i += 4)
+        memcpy(rgba + i, color, 4);
+
+    check(writer_write_frame(w, rgba) == 0);
+    for (int i = 1; i < NB_FRAMES; i++)
+        check(writer_queue_frame(w, rgba) == 0);
+    check(writer_flush(w) == 0);
+    writer_freep(&w);
+    free(rgba);
+
+    const long size = lseek(par.fd, 0, SEEK_END);
+    check(size > 0);
+    out->size = size;
+    out->data = malloc(out->size);
+    check(out->data);
+    check(lseek(par.fd, 0, SEEK_SET) == 0);
+    check(read(par.fd, out->data, out->size) == (int)out->size);
+    fclose(f);
+}
+
+static size_t get_yuv_frame_size(int width, int height)
+{
+    return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+}
+
+static void check_value(const uint8_t *p, size_t size, uint8_t value)
+{
+    for (size_t i = 0; i < size; i++)
+        check(p[i] == value);
+}
+
+static void test_raw(void)
+{
+    static const uint8_t color[4] = {0x12, 0x34, 0x56, 0x78};
+    const struct writer_params params = {
+        .width   = 3,
+        .height  = 5,
+        .rate    = {60, 1},
+        .format  = WRITER_FORMAT_RAW,
+        .pix_fmt = WRITER_PIX_FMT_RGBA,
+    };
+    struct output out;
+    write_frames(&out, &params, color);
+
+    check(out.size == NB_FRAMES * 4 * 3 * 5);
+    for (size_t i = 0; i < out.size; i += 4)
+        check(!memcmp(out.data + i, color, 4));
+    free(out.data);
+}
+
+static void test_y4m(void)
+{
+    /* Odd dimensions: the chroma planes are rounded up */
+    static const uint8_t white[4] = {0xff, 0xff, 0xff, 0xff};
+    const struct writer_params params = {
+        .width   = 5,
+        .height  = 3,
+        .rate    = {30000, 1001},
+        .format  = WRITER_FORMAT_Y4M,
+        .pix_fmt = WRITER_PIX_FMT_YUV420P,
+    };
+    struct output out;
+    write_frames(&out, &params, white);
+
+    static const char header[] = "YUV4MPEG2 W5 H3 F30000:1001 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+    static const char frame_header[] = "FRAME\n";
+    const size_t header_len = sizeof(header) - 1;
+    const size_t frame_header_len = sizeof(frame_header) - 1;
+    const size_t frame_size = get_yuv_frame_size(5, 3);
+    check(frame_size == 5 * 3 + 2 * 3 * 2);
+    check(out.size == header_len + NB_FRAMES * (frame_header_len + frame_size));
+    check(!memcmp(out.data, header, header_len));
+
+    const uint8_t *p = out.data + header_len;
+    for (int i = 0; i < NB_FRAMES; i++) {
+        check(!memcmp(p, frame_header, frame_header_len));
+        p += frame_header_len;
+        check_value(p, 5 * 3, 235);             /* Y */
+        check_value(p + 5 * 3, 2 * 3 * 2, 128); /* U and V */
+        p += frame_size;
+    }
+    free(out.data);
+
+    /* y4m only supports yuv420p */
+    struct writer_params rgba_params = params;
+    rgba_params.pix_fmt = WRITER_PIX_FMT_RGBA;
+    check(!writer_create(&rgba_params));
+}
+
+static uint64_t get_u64(const uint8_t **p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = v << 8 | *(*p)++;
+    return v;
+}
+
+static uint64_t get_v(const uint8_t **p)
+{
+    uint64_t v = 0;
+    uint8_t c;
+    do {
+        c = *(*p)++;
+        v = v << 7 | (c & 0x7f);
+    } while (c & 0x80);
+    return v;
+}
+
+static void test_nut(void)
+{
+    static const uint8_t black[4] = {0x00, 0x00, 0x00, 0xff};
+    const struct writer_params params = {
+        .width   = 6,
+        .height  = 4,
+        .rate    = {25, 1},
+        .format  = WRITER_FORMAT_NUT,
+        .pix_fmt = WRITER_PIX_FMT_NV12,
+    };
+    struct output out;
+    write_frames(&out, &params, black);
+
+    static const char file_id[] = "nut/multimedia container";
+    check(!memcmp(out.data, file_id, sizeof(file_id)));
+
+    const uint8_t *p = out.data + sizeof(file_id);
+    check(get_u64(&p) >> 48 == ('N' << 8 | 'M'));
+    const uint64_t main_size = get_v(&p);
+    p += main_size;
+    check(get_u64(&p) >> 48 == ('N' << 8 | 'S'));
+    const uint64_t stream_size = get_v(&p);
+    const uint8_t *stream_header = p;
+    check(get_v(&p) == 0);      /* stream_id */
+    check(get_v(&p) == 0);      /* stream_class */
+    check(get_v(&p) == 4);
+    check(!memcmp(p, "NV12", 4));
+    p = stream_header + stream_size;
+
+    const size_t frame_size = get_yuv_frame_size(6, 4);
+    const uint8_t *last_syncpoint = NULL;
+    for (int i = 0; i < NB_FRAMES; i++) {
+        const uint8_t *syncpoint = p;
+        check(get_u64(&p) >> 48 == ('N' << 8 | 'K'));
+        const uint64_t syncpoint_size = get_v(&p);
+        const uint8_t *syncpoint_data = p;
+        check(get_v(&p) == i);  /* global_key_pts */
+
+        /*
+         * The decoder locates the previous syncpoint at most 15 bytes after
+         * syncpoint - 16 * back_ptr_div16 - 15
+         */
+        const uint64_t back_ptr_div16 = get_v(&p);
+        if (last_syncpoint) {
+            /* The frame size is chosen to not align the syncpoints on 16 bytes */
+            const ptrdiff_t back_ptr = syncpoint - last_syncpoint;
+            check(back_ptr % 16);
+            check(back_ptr_div16 == back_ptr / 16);
+        } else {
+            check(back_ptr_div16 == 0);
+        }
+        last_syncpoint = syncpoint;
+        p = syncpoint_data + syncpoint_size;
+
+        check(*p++ == 0);       /* frame_code */
+        check(get_v(&p) == i + 128);
+        check(get_v(&p) == frame_size);
+        p += 4;                 /* checksum */
+
+        check_value(p, 6 * 4, 16);              /* Y */
+        check_value(p + 6 * 4, 2 * 3 * 2, 128); /* interleaved U and V */
+        p += frame_size;
+    }
+    check(p == out.data + out.size);
+    free(out.data);
+}
+
+static void test_error(void)
+{
+    static const uint8_t rgba[4 * 2 * 2] = {0};
+    const struct writer_params params = {
+        .fd      = -1,
+        .width   = 2,
+        .height  = 2,
+        .rate    = {60, 1},
+        .format  = WRITER_FORMAT_RAW,
+        .pix_fmt = WRITER_PIX_FMT_RGBA,
+    };
+
+    /* The headers are written at creation */
+    struct writer_params y4m_params = params;
+    y4m_params.format = WRITER_FORMAT_Y4M;
+    y4m_params.pix_fmt = WRITER_PIX_FMT_YUV420P;
+    check(!writer_create(&y4m_params));
+
+    struct writer *w = writer_create(&params);
+    check(w);
+    check(writer_write_frame(w, rgba) == NGL_ERROR_IO);
+
+    /* The writer thread error is reported once the queue is full at the latest */
+    int ret = 0;
+    for (int i = 0; i < 16 && ret == 0; i++)
+        ret = writer_queue_frame(w, rgba);
+    check(ret == NGL_ERROR_IO);
+    check(writer_queue_frame(w, rgba) == NGL_ERROR_IO);
+    check(writer_flush(w) == NGL_ERROR_IO);
+    writer_freep(&w);
+    check(!w);
+}
+
+int main(void)
+{
+    test_raw();
+    test_y4m();
+    test_nut();
+    test_error();
+    return 0;
+}
@@ -0,0 +1,471 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32) && defined(_MSC_VER)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <nodegl.h>
+
+#include "writer.h"
+
+/* Number of frames the renderer can be ahead of the writer thread */
+#define NB_QUEUED_FRAMES 4
+
+#define NUT_STARTCODE(c0, c1, v) (((uint64_t)((c0) << 8 | (c1)) << 48) | (v))
+#define NUT_MAIN_STARTCODE      NUT_STARTCODE('N', 'M', 0x7A561F5F04ADULL)
+#define NUT_STREAM_STARTCODE    NUT_STARTCODE('N', 'S', 0x11405BF2F9DBULL)
+#define NUT_SYNCPOINT_STARTCODE NUT_STARTCODE('N', 'K', 0xE4ADEECA4569ULL)
+
+#define NUT_FLAG_KEY       (1 << 0)
+#define NUT_FLAG_CODED_PTS (1 << 3)
+#define NUT_FLAG_SIZE_MSB  (1 << 5)
+#define NUT_FLAG_CHECKSUM  (1 << 6)
+
+#define NUT_MSB_PTS_SHIFT 7
+
+struct writer {
+    struct writer_params params;
+    size_t frame_size;
+    uint8_t *conv_buffer;
+    int64_t nb_frames;
+    int64_t pos;
+    int64_t last_syncpoint_pos;
+    uint32_t crc_table[256];
+
+    /* writer thread */
+    int thread_started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *queue[NB_QUEUED_FRAMES];
+    int queue_start;
+    int nb_queued;
+    int eof;
+    int error;
+};
+
+static int write_buffer(struct writer *w, const uint8_t *buf, size_t size)
+{
+    while (size) {
+        const int n = write(w->params.fd, buf, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("write");
+            return NGL_ERROR_IO;
+        }
+        buf    += n;
+        size   -= n;
+        w->pos += n;
+    }
+    return 0;
+}
+
+/*
+ * RGBA to BT.709 limited range YUV, in 15-bit fixed point. The chroma of every
+ * 2x2 block is computed from the average of its pixels (centered siting).
+ */
+#define FIX(x) ((int)((x) * (1 << 15) + .5))
+#define KR .2126
+#define KB .0722
+#define KG (1. - KR - KB)
+#define Y_SCALE (219. / 255.)
+#define C_SCALE (224. / 255.)
+
+static const int y_coeffs[3]  = {FIX(Y_SCALE*KR), FIX(Y_SCALE*KG), FIX(Y_SCALE*KB)};
+static const int cb_coeffs[3] = {-FIX(C_SCALE*KR/(2.*(1.-KB))), -FIX(C_SCALE*KG/(2.*(1.-KB))), FIX(C_SCALE*.5)};
+static const int cr_coeffs[3] = {FIX(C_SCALE*.5), -FIX(C_SCALE*KG/(2.*(1.-KR))), -FIX(C_SCALE*KB/(2.*(1.-KR)))};
+
+static uint8_t get_chroma(const int *coeffs, const int *sum)
+{
+    return ((128 << 17) + coeffs[0]*sum[0] + coeffs[1]*sum[1] + coeffs[2]*sum[2] + (1 << 16)) >> 17;
+}
+
+static void convert_frame(struct writer *w, const uint8_t *src)
+{
+    const int width = w->params.width;
+    const int height = w->params.height;
+    const int c_width = (width + 1) / 2;
+    const int c_height = (height + 1) / 2;
+    const int linesize = width * 4;
+    uint8_t *dst_y = w->conv_buffer;
+    uint8_t *dst_u = dst_y + width * height;
+    uint8_t *dst_v = dst_u + c_width * c_height;
+    const int c_step = w->params.pix_fmt == WRITER_PIX_FMT_NV12 ? 2 : 1;
+    if (c_step == 2)
+        dst_v = dst_u + 1;
+
+    for (int y = 0; y < height; y++) {
+        const uint8_t *p = src + y * linesize;
+        for (int x = 0; x < width; x++) {
+            const int v = y_coeffs[0]*p[0] + y_coeffs[1]*p[1] + y_coeffs[2]*p[2];
+            dst_y[y * width + x] = ((16 << 15) + v + (1 << 14)) >> 15;
+            p += 4;
+        }
+    }
+
+    for (int y = 0; y < c_height; y++) {
+        const uint8_t *p0 = src + 2 * y * linesize;
+        const uint8_t *p1 = 2 * y + 1 < height ? p0 + linesize : p0;
+        for (int x = 0; x < c_width; x++) {
+            const int x0 = 2 * x * 4;
+            const int x1 = 2 * x + 1 < width ? x0 + 4 : x0;
+            int sum[3];
+            for (int i = 0; i < 3; i++)
+                sum[i] = p0[x0 + i] + p0[x1 + i] + p1[x0 + i] + p1[x1 + i];
+            dst_u[(y * c_width + x) * c_step] = get_chroma(cb_coeffs, sum);
+            dst_v[(y * c_width + x) * c_step] = get_chroma(cr_coeffs, sum);
+        }
+    }
+}
+
+static void init_crc_table(uint32_t *table)
+{
+    /* CRC-32 used by NUT: polynomial 0x04C11DB7, MSB first, zero initial value */
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i << 24;
+        for (int j = 0; j < 8; j++)
+            crc = crc & 0x80000000 ? crc << 1 ^ 0x04C11DB7 : crc << 1;
+        table[i] = crc;
+    }
+}
+
+static uint32_t get_crc(const struct writer *w, const uint8_t *buf, size_t size)
+{
+    uint32_t crc = 0;
+    for (size_t i = 0; i < size; i++)
+        crc = crc << 8 ^ w->crc_table[crc >> 24 ^ buf[i]];
+    return crc;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 3; i >= 0; i--)
+        *p++ = v >> (8 * i);
+    return p;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+    p = put_u32(p, v >> 32);
+    return put_u32(p, v);
+}
+
+static uint8_t *put_v(uint8_t *p, uint64_t v)
+{
+    int n = 1;
+    while (n < 10 && v >> (7 * n))
+        n++;
+    for (int i = n - 1; i >= 0; i--)
+        *p++ = (v >> (7 * i) & 0x7f) | (i ? 0x80 : 0);
+    return p;
+}
+
+static uint8_t *put_s(uint8_t *p, int64_t v)
+{
+    return put_v(p, v > 0 ? 2 * (uint64_t)v - 1 : -2 * (uint64_t)v);
+}
+
+/*
+ * Append a NUT packet (startcode, forward pointer, data and checksum) to the
+ * destination. The packets written here are small enough (<= 4096 bytes) to
+ * not require a header checksum.
+ */
+static uint8_t *put_nut_packet(const struct writer *w, uint8_t *p, uint64_t startcode,
+                               const uint8_t *data, size_t size)
+{
+    p = put_u64(p, startcode);
+    p = put_v(p, size + 4);
+    memcpy(p, data, size);
+    p += size;
+    return put_u32(p, get_crc(w, data, size));
+}
+
+static const char nut_file_id[] = "nut/multimedia container";
+
+static int write_nut_headers(struct writer *w)
+{
+    static const char *fourccs[] = {
+        [WRITER_PIX_FMT_RGBA]    = "RGBA",
+        [WRITER_PIX_FMT_NV12]    = "NV12",
+        [WRITER_PIX_FMT_YUV420P] = "I420",
+    };
+    const struct writer_params *par = &w->params;
+    uint8_t buf[512];
+    uint8_t data[128];
+
+    /* The file id string is written with its terminating nul character */
+    memcpy(buf, nut_file_id, sizeof(nut_file_id));
+    uint8_t *p = buf + sizeof(nut_file_id);
+
+    /*
+     * Main header: a single stream with a single time base, and a single frame
+     * code where the pts and the size are always explicitly coded
+     */
+    uint8_t *d = data;
+    d = put_v(d, 3);            /* version */
+    d = put_v(d, 1);            /* stream_count */
+    d = put_v(d, 65536);        /* max_distance */
+    d = put_v(d, 1);            /* time_base_count */
+    d = put_v(d, par->rate[1]); /* time_base_num */
+    d = put_v(d, par->rate[0]); /* time_base_denom */
+    d = put_v(d, NUT_FLAG_KEY | NUT_FLAG_CODED_PTS | NUT_FLAG_SIZE_MSB | NUT_FLAG_CHECKSUM);
+    d = put_v(d, 6);            /* fields */
+    d = put_s(d, 0);            /* pts delta */
+    d = put_v(d, 1);            /* size multiplier */
+    d = put_v(d, 0);            /* stream id */
+    d = put_v(d, 0);            /* size lsb */
+    d = put_v(d, 0);            /* reserved count */
+    d = put_v(d, 255);          /* count: all the frame codes except 'N' */
+    d = put_v(d, 0);            /* header_count_minus1 */
+    p = put_nut_packet(w, p, NUT_MAIN_STARTCODE, data, d - data);
+
+    d = data;
+    d = put_v(d, 0);            /* stream_id */
+    d = put_v(d, 0);            /* stream_class: video */
+    d = put_v(d, 4);
+    memcpy(d, fourccs[par->pix_fmt], 4);
+    d += 4;
+    d = put_v(d, 0);            /* time_base_id */
+    d = put_v(d, NUT_MSB_PTS_SHIFT);
+    d = put_v(d, par->rate[0]); /* max_pts_distance */
+    d = put_v(d, 0);            /* decode_delay */
+    d = put_v(d, 0);            /* stream_flags */
+    d = put_v(d, 0);            /* codec_specific_data */
+    d = put_v(d, par->width);
+    d = put_v(d, par->height);
+    d = put_v(d, 1);            /* sample_width */
+    d = put_v(d, 1);            /* sample_height */
+    d = put_v(d, par->pix_fmt == WRITER_PIX_FMT_RGBA ? 0 : 2); /* colorspace_type: BT.709 limited */
+    p = put_nut_packet(w, p, NUT_STREAM_STARTCODE, data, d - data);
+
+    return write_buffer(w, buf, p - buf);
+}
+
+/* Every frame is a keyframe preceded by a syncpoint */
+static int write_nut_frame_header(struct writer *w, size_t size)
+{
+    const int64_t pts = w->nb_frames;
+    uint8_t buf[64];
+    uint8_t data[32];
+
+    /* The first syncpoint back pointer refers to itself */
+    const int64_t back_ptr = w->last_syncpoint_pos ? w->pos - w->last_syncpoint_pos : 0;
+    w->last_syncpoint_pos = w->pos;
+    uint8_t *d = data;
+    d = put_v(d, pts);                /* global_key_pts */
+    d = put_v(d, back_ptr / 16);      /* back_ptr_div16 */
+    uint8_t *p = put_nut_packet(w, buf, NUT_SYNCPOINT_STARTCODE, data, d - data);
+
+    uint8_t *frame_header = p;
+    *p++ = 0;                         /* frame_code */
+    p = put_v(p, pts + (1 << NUT_MSB_PTS_SHIFT));
+    p = put_v(p, size);               /* data_size_msb */
+    p = put_u32(p, get_crc(w, frame_header, p - frame_header));
+
+    return write_buffer(w, buf, p - buf);
+}
+
+int writer_write_frame(struct writer *w, const uint8_t *rgba)
+{
+    const uint8_t *frame = rgba;
+    if (w->params.pix_fmt != WRITER_PIX_FMT_RGBA) {
+        convert_frame(w, rgba);
+        frame = w->conv_buffer;
+    }
+
+    int ret = 0;
+    if (w->params.format == WRITER_FORMAT_Y4M) {
+        static const uint8_t frame_header[] = "FRAME\n";
+        ret = write_buffer(w, frame_header, sizeof(frame_header) - 1);
+    } else if (w->params.format == WRITER_FORMAT_NUT) {
+        ret = write_nut_frame_header(w, w->frame_size);
+    }
+    if (ret < 0)
+        return ret;
+
+    ret = write_buffer(w, frame, w->frame_size);
+    if (ret < 0)
+        return ret;
+
+    w->nb_frames++;
+    return 0;
+}
+
+static void *writer_thread(void *arg)
+{
+    struct writer *w = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        while (!w->nb_queued && !w->eof)
+            pthread_cond_wait(&w->cond, &w->lock);
+        if (!w->nb_queued) {
+            pthread_mutex_unlock(&w->lock);
+            break;
+        }
+        const uint8_t *frame = w->queue[w->queue_start];
+        pthread_mutex_unlock(&w->lock);
+
+        /* The slot is not reused by the renderer until it is released below */
+        const int ret = writer_write_frame(w, frame);
+
+        pthread_mutex_lock(&w->lock);
+        w->queue_start = (w->queue_start + 1) % NB_QUEUED_FRAMES;
+        w->nb_queued--;
+        if (ret < 0)
+            w->error = ret;
+        pthread_cond_signal(&w->cond);
+        pthread_mutex_unlock(&w->lock);
+        if (ret < 0)
+            break;
+    }
+    return NULL;
+}
+
+static int start_thread(struct writer *w)
+{
+    const size_t size = 4 * w->params.width * w->params.height;
+    for (int i = 0; i < NB_QUEUED_FRAMES; i++) {
+        w->queue[i] = malloc(size);
+        if (!w->queue[i])
+            return NGL_ERROR_MEMORY;
+    }
+
+    w->queue_start = 0;
+    w->nb_queued = 0;
+    w->eof = 0;
+    if (pthread_create(&w->thread, NULL, writer_thread, w))
+        return NGL_ERROR_GENERIC;
+    w->thread_started = 1;
+    return 0;
+}
+
+int writer_queue_frame(struct writer *w, const uint8_t *rgba)
+{
+    if (!w->thread_started) {
+        int ret = start_thread(w);
+        if (ret < 0)
+            return ret;
+    }
+
+    pthread_mutex_lock(&w->lock);
+    while (w->nb_queued == NB_QUEUED_FRAMES && !w->error)
+        pthread_cond_wait(&w->cond, &w->lock);
+    const int error = w->error;
+    const int slot = (w->queue_start + w->nb_queued) % NB_QUEUED_FRAMES;
+    pthread_mutex_unlock(&w->lock);
+    if (error < 0)
+        return error;
+
+    memcpy(w->queue[slot], rgba, 4 * w->params.width * w->params.height);
+
+    pthread_mutex_lock(&w->lock);
+    w->nb_queued++;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    return 0;
+}
+
+int writer_flush(struct writer *w)
+{
+    if (!w->thread_started)
+        return 0;
+
+    pthread_mutex_lock(&w->lock);
+    w->eof = 1;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+
+    pthread_join(w->thread, NULL);
+    w->thread_started = 0;
+    return w->error;
+}
+
+struct writer *writer_create(const struct writer_params *params)
+{
+    if (params->format == WRITER_FORMAT_Y4M && params->pix_fmt != WRITER_PIX_FMT_YUV420P) {
+        fprintf(stderr, "y4m output is only supported with the yuv420p pixel format\n");
+        return NULL;
+    }
+
+    struct writer *w = calloc(1, sizeof(*w));
+    if (!w)
+        return NULL;
+    w->params = *params;
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->cond, NULL);
+    init_crc_table(w->crc_table);
+
+    const int width = params->width;
+    const int height = params->height;
+    if (params->pix_fmt == WRITER_PIX_FMT_RGBA) {
+        w->frame_size = 4 * width * height;
+    } else {
+        w->frame_size = width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+        w->conv_buffer = malloc(w->frame_size);
+        if (!w->conv_buffer)
+            goto fail;
+    }
+
+    int ret = 0;
+    if (params->format == WRITER_FORMAT_Y4M) {
+        char header[128];
+        const int len = snprintf(header, sizeof(header),
+                                 "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                                 width, height, params->rate[0], params->rate[1]);
+        ret = write_buffer(w, (const uint8_t *)header, len);
+    } else if (params->format == WRITER_FORMAT_NUT) {
+        ret = write_nut_headers(w);
+    }
+    if (ret < 0)
+        goto fail;
+
+    return w;
+
+fail:
+    writer_freep(&w);
+    return NULL;
+}
+
+void writer_freep(struct writer **wp)
+{
+    struct writer *w = *wp;
+    if (!w)
+        return;
+
+    writer_flush(w);
+    for (int i = 0; i < NB_QUEUED_FRAMES; i++)
+        free(w->queue[i]);
+    free(w->conv_buffer);
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+    *wp = NULL;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stdint.h>
+
+enum writer_format {
+    WRITER_FORMAT_RAW,
+    WRITER_FORMAT_Y4M,
+    WRITER_FORMAT_NUT,
+};
+
+enum writer_pix_fmt {
+    WRITER_PIX_FMT_RGBA,
+    WRITER_PIX_FMT_NV12,
+    WRITER_PIX_FMT_YUV420P,
+};
+
+struct writer_params {
+    int fd;
+    int width;
+    int height;
+    int rate[2];
+    enum writer_format format;
+    enum writer_pix_fmt pix_fmt;
+};
+
+/*
+ * Write the captured RGBA frames to a file descriptor, converted to the
+ * requested pixel format and wrapped into the requested format. The headers
+ * are written at creation.
+ */
+struct writer *writer_create(const struct writer_params *params);
+
+/* Write a frame from the calling thread */
+int writer_write_frame(struct writer *w, const uint8_t *rgba);
+
+/*
+ * Copy a frame into the queue drained by the writer thread (started on the
+ * first call), waiting for a free slot if the queue is full. The errors of the
+ * writer thread are reported by the next call.
+ */
+int writer_queue_frame(struct writer *w, const uint8_t *rgba);
+
+/* Wait for the queued frames to be written and stop the writer thread */
+int writer_flush(struct writer *w);
+
+void writer_freep(struct writer **wp);
+
+#endif
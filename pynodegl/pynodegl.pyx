@@ -21,7 +21,8 @@
 #
 
 from libc.stdlib cimport calloc
-from libc.string cimport memset
+from libc.string cimport memcpy, memset
+from libc.stdint cimport int64_t
 from libc.stdint cimport uint8_t
 from libc.stdint cimport uintptr_t
 
@@ -33,6 +34,8 @@ cdef extern from "nodegl.h":
     cdef int NGL_LOG_ERROR
     cdef int NGL_LOG_QUIET
 
+    cdef int NGL_ERROR_INVALID_DATA
+
     void ngl_log_set_min_level(int level)
 
     cdef struct ngl_node
@@ -47,6 +50,12 @@ cdef extern from "nodegl.h":
     char *ngl_node_dot(const ngl_node *node)
     char *ngl_node_serialize(const ngl_node *node)
     ngl_node *ngl_node_deserialize(const char *s)
+    ngl_node *ngl_node_deserialize_parallel(const char *s, int nb_threads)
+    ngl_node *ngl_node_deserialize_stream(void *arg, int (*read_func)(void *arg, char *buf, int size))
+    void *ngl_node_serialize_bin(const ngl_node *node, size_t *size)
+    ngl_node *ngl_node_deserialize_bin(const void *data, size_t size)
+    char *ngl_node_diff(const char *old_scene, const char *new_scene)
+    int ngl_node_patch(ngl_node *scene, const char *patch)
 
     int ngl_anim_evaluate(ngl_node *anim, void *dst, double t)
 
@@ -108,6 +117,10 @@ cdef extern from "nodegl.h":
         int hud_refresh_rate[2]
         const char *hud_export_filename
         int hud_scale
+        int64_t texture_pool_size
+        int elide_static_frames
+        int update_threads
+        int lazy_init
 
     ngl_ctx *ngl_create()
     int ngl_backends_probe(const ngl_config *user_config, int *nb_backendsp, ngl_backend **backendsp)
@@ -122,6 +135,8 @@ cdef extern from "nodegl.h":
 
     int ngl_easing_evaluate(const char *name, double *args, int nb_args,
                             double *offsets, double t, double *v)
+    int ngl_easing_evaluate_approx(const char *name, double *args, int nb_args,
+                                   double *offsets, double tolerance, double t, double *v)
     int ngl_easing_solve(const char *name, double *args, int nb_args,
                          double *offsets, double v, double *t)
 
@@ -161,13 +176,52 @@ cdef _ret_pystr(char *s):
         free(s)
     return pystr
 
+cdef _ret_pybytes(void *data, size_t size):
+    if data == NULL:
+        return None
+    try:
+        pybytes = (<char *>data)[:size]
+    finally:
+        free(data)
+    return pybytes
+
 include "nodes_def.pyx"
 
 def log_set_min_level(int level):
     ngl_log_set_min_level(level)
 
 
-cdef _eval_solve(name, src, args, offsets, evaluate):
+def node_deserialize(s, int nb_threads=0):
+    cdef ngl_node *scene
+    if nb_threads > 1:
+        scene = ngl_node_deserialize_parallel(s, nb_threads)
+    else:
+        scene = ngl_node_deserialize(s)
+    if scene == NULL:
+        return None
+    cdef _Node node = _Node.__new__(_Node)
+    node.ctx = scene
+    return node
+
+
+def node_deserialize_bin(bytes data):
+    cdef const char *ptr = data
+    cdef ngl_node *scene = ngl_node_deserialize_bin(ptr, len(data))
+    if scene == NULL:
+        return None
+    cdef _Node node = _Node.__new__(_Node)
+    node.ctx = scene
+    return node
+
+
+def node_diff(old_scene, new_scene):
+    cdef char *patch = ngl_node_diff(old_scene, new_scene)
+    if patch == NULL:
+        return None
+    return _ret_pystr(patch)
+
+
+cdef _eval_solve(name, src, args, offsets, evaluate, tolerance=0):
     cdef double c_args[2]
     cdef double *c_args_param = NULL
     cdef int nb_args = 0
@@ -189,7 +243,10 @@ cdef _eval_solve(name, src, args, offsets, evaluate):
     cdef double dst
     cdef int ret
     if evaluate:
-        ret = ngl_easing_evaluate(name, c_args_param, nb_args, c_offsets_param, src, &dst)
+        if tolerance:
+            ret = ngl_easing_evaluate_approx(name, c_args_param, nb_args, c_offsets_param, tolerance, src, &dst)
+        else:
+            ret = ngl_easing_evaluate(name, c_args_param, nb_args, c_offsets_param, src, &dst)
         if ret < 0:
             raise Exception("Error evaluating %s" % name)
     else:
@@ -200,8 +257,8 @@ cdef _eval_solve(name, src, args, offsets, evaluate):
     return dst
 
 
-def easing_evaluate(name, t, args=None, offsets=None):
-    return _eval_solve(name, t, args, offsets, True)
+def easing_evaluate(name, t, args=None, offsets=None, tolerance=0):
+    return _eval_solve(name, t, args, offsets, True, tolerance)
 
 
 def easing_solve(name, v, args=None, offsets=None):
@@ -249,6 +306,20 @@ def probe_backends(**kwargs):
     return backend_set
 
 
+cdef int _read_stream(void *arg, char *buf, int size) with gil:
+    cdef const char *ptr
+    try:
+        data = (<object>arg)(size)
+        ptr = data
+    except Exception:
+        return -1
+    cdef int data_size = len(data)
+    if data_size > size:
+        return -1
+    memcpy(buf, ptr, data_size)
+    return data_size
+
+
 cdef class Context:
     cdef ngl_ctx *ctx
     cdef object capture_buffer
@@ -291,6 +362,10 @@ cdef class Context:
         if hud_export_filename is not None:
             config.hud_export_filename = hud_export_filename
         config.hud_scale = kwargs.get('hud_scale', 0)
+        config.texture_pool_size = kwargs.get('texture_pool_size', 0)
+        config.elide_static_frames = kwargs.get('elide_static_frames', 0)
+        config.update_threads = kwargs.get('update_threads', 0)
+        config.lazy_init = kwargs.get('lazy_init', False)
 
     def configure(self, **kwargs):
         self.capture_buffer = kwargs.get('capture_buffer')
@@ -317,8 +392,29 @@ cdef class Context:
     def set_scene(self, _Node scene):
         return ngl_set_scene(self.ctx, NULL if scene is None else scene.ctx)
 
-    def set_scene_from_string(self, s):
-        cdef ngl_node *scene = ngl_node_deserialize(s);
+    def set_scene_from_string(self, s, int nb_threads=0):
+        cdef ngl_node *scene
+        if nb_threads > 1:
+            scene = ngl_node_deserialize_parallel(s, nb_threads)
+        else:
+            scene = ngl_node_deserialize(s)
+        ret = ngl_set_scene(self.ctx, scene)
+        ngl_node_unrefp(&scene)
+        return ret
+
+    def set_scene_from_stream(self, read_func):
+        cdef ngl_node *scene = ngl_node_deserialize_stream(<void *>read_func, _read_stream)
+        if scene == NULL:
+            return NGL_ERROR_INVALID_DATA
+        ret = ngl_set_scene(self.ctx, scene)
+        ngl_node_unrefp(&scene)
+        return ret
+
+    def set_scene_from_bin(self, bytes data):
+        cdef const char *ptr = data
+        cdef ngl_node *scene = ngl_node_deserialize_bin(ptr, len(data))
+        if scene == NULL:
+            return NGL_ERROR_INVALID_DATA
         ret = ngl_set_scene(self.ctx, scene)
         ngl_node_unrefp(&scene)
         return ret
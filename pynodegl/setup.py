@@ -162,9 +162,17 @@ cdef class _Node:
     def serialize(self):
         return _ret_pystr(ngl_node_serialize(self.ctx))
 
+    def serialize_bin(self):
+        cdef size_t size = 0
+        cdef void *data = ngl_node_serialize_bin(self.ctx, &size)
+        return _ret_pybytes(data, size)
+
     def dot(self):
         return _ret_pystr(ngl_node_dot(self.ctx))
 
+    def apply_patch(self, patch):
+        return ngl_node_patch(self.ctx, patch)
+
     def __dealloc__(self):
         ngl_node_unrefp(&self.ctx)
 
@@ -101,6 +101,589 @@ def api_capture_buffer(width=16, height=16):
     del ctx
 
 
+def _get_data_scene(nb_renders=1, nb_vertices=3):
+    import array
+    import math
+    renders = []
+    for i in range(nb_renders):
+        vertices = array.array('f', [math.sin(i + j) for j in range(nb_vertices * 3)])
+        animkf = [
+            ngl.AnimKeyFrameVec4(0, (1.0, 0.0, 0.0, 1.0)),
+            ngl.AnimKeyFrameVec4(1, (0.0, 0.0, 1.0, 1.0), 'exp_in', easing_args=(0.5, 2.0 + i)),
+        ]
+        render = _get_scene(ngl.Geometry(ngl.BufferVec3(data=vertices)))
+        render.update_frag_resources(color=ngl.AnimatedVec4(animkf))
+        renders.append(render)
+    return ngl.Group(children=renders) if nb_renders > 1 else renders[0]
+
+
+def api_serialize_bin(width=16, height=16):
+    import zlib
+    scene = _get_data_scene()
+    data = scene.serialize_bin()
+    ref_crc = _get_crc(scene, 0.5, width, height)
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    assert ctx.set_scene_from_bin(data) == 0
+    assert ctx.draw(0.5) == 0
+    assert zlib.crc32(capture_buffer) == ref_crc
+    assert ctx.set_scene_from_bin(data[:len(data) // 2]) < 0
+    del capture_buffer
+    del ctx
+
+    # The text and binary formats describe the same scene, including the
+    # node dictionaries, select and flags parameters
+    render = _get_data_scene()
+    render.update_vert_resources(scale=ngl.UniformFloat(value=0.5), offset=ngl.UniformVec2(value=(0.1, 0.2)))
+    scene = ngl.GraphicConfig(
+        render,
+        blend=True,
+        blend_src_factor='src_alpha',
+        blend_dst_factor='one_minus_src_alpha',
+        color_write_mask='r+g+a',
+        cull_mode='back',
+    )
+    text = scene.serialize()
+    data = scene.serialize_bin()
+    assert ngl.node_deserialize_bin(data).serialize() == text
+    assert ngl.node_deserialize(text).serialize_bin() == data
+
+
+def api_deserialize_parallel(width=16, height=16):
+    import zlib
+    # Many nodes with large data and list parameters so that the parsing is
+    # actually spread over the threads
+    scene = _get_data_scene(nb_renders=64, nb_vertices=3 * 1024)
+    scene_str = scene.serialize()
+    ref_crc = _get_crc(scene, 0.5, width, height)
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    for nb_threads in (0, 2, 4):
+        node = ngl.node_deserialize(scene_str, nb_threads=nb_threads)
+        assert node.serialize() == scene_str
+        assert ctx.set_scene(None) == 0
+        assert ctx.set_scene_from_string(scene_str, nb_threads=nb_threads) == 0
+        assert ctx.draw(0.5) == 0
+        assert zlib.crc32(capture_buffer) == ref_crc
+    del capture_buffer
+    del ctx
+
+
+def api_deserialize_stream(width=16, height=16):
+    import zlib
+    scene = _get_data_scene()
+    scene_str = scene.serialize()
+    ref_node = ngl.node_deserialize(scene_str)
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    assert ctx.set_scene(ref_node) == 0
+    assert ctx.draw(0.5) == 0
+    ref_crc = zlib.crc32(capture_buffer)
+
+    # Short reads of 1 to 7 bytes split the tokens and the lines across reads
+    scene_bytes = scene_str.encode()
+    pos = [0, 0]
+
+    def read_func(size):
+        start = pos[0]
+        pos[0] += min(size, pos[1] % 7 + 1)
+        pos[1] += 1
+        return scene_bytes[start:pos[0]]
+
+    assert ctx.set_scene(None) == 0
+    assert ctx.set_scene_from_stream(read_func) == 0
+    assert ctx.draw(0.5) == 0
+    assert zlib.crc32(capture_buffer) == ref_crc
+
+    # A read error fails the deserialization
+    def read_error(size):
+        raise IOError
+    assert ctx.set_scene_from_stream(read_error) < 0
+    del capture_buffer
+    del ctx
+
+
+def api_scene_patch(width=16, height=16):
+    import zlib
+    scene = _get_scene()
+    new_scene = _get_scene()
+    new_scene.update_frag_resources(color=ngl.UniformVec4(value=(1.0, 0.0, 0.0, 1.0)))
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    assert ctx.set_scene(new_scene) == 0
+    assert ctx.draw(0) == 0
+    ref_crc = zlib.crc32(capture_buffer)
+
+    # Live change of a uniform
+    assert ctx.set_scene(scene) == 0
+    assert ctx.draw(0) == 0
+    patch = ngl.node_diff(scene.serialize(), new_scene.serialize())
+    assert patch is not None
+    assert scene.apply_patch(patch) == 0
+    assert scene.serialize() == new_scene.serialize()
+    assert ctx.draw(0) == 0
+    assert zlib.crc32(capture_buffer) == ref_crc
+
+    # The geometry can not be live changed: the scene must be detached first
+    new_scene = _get_scene(ngl.Quad(corner=(-1.0, -1.0, 0.0), width=(2.0, 0.0, 0.0), height=(0.0, 2.0, 0.0)))
+    new_scene.update_frag_resources(color=ngl.UniformVec4(value=(1.0, 0.0, 0.0, 1.0)))
+    patch = ngl.node_diff(scene.serialize(), new_scene.serialize())
+    assert patch is not None
+    assert scene.apply_patch(patch) < 0
+    assert ctx.set_scene(None) == 0
+    assert scene.apply_patch(patch) == 0
+    assert scene.serialize() == new_scene.serialize()
+
+    # A malformed value fails the whole patch, leaving the scene unchanged
+    new_scene = _get_scene(ngl.Quad(corner=(-0.5, -1.0, 0.0), width=(1.0, 0.0, 0.0), height=(0.0, 2.0, 0.0)))
+    new_scene.update_frag_resources(color=ngl.UniformVec4(value=(0.0, 1.0, 0.0, 1.0)))
+    patch = ngl.node_diff(scene.serialize(), new_scene.serialize())
+    assert patch is not None
+    lines = patch.rstrip('\n').split('\n')
+    assert len(lines) > 2
+    lines[-1] = lines[-1].rsplit(':', 1)[0] + ':malformed'
+    scene_str = scene.serialize()
+    assert scene.apply_patch('\n'.join(lines) + '\n') < 0
+    assert scene.serialize() == scene_str
+
+    # Structural changes can not be expressed as a patch
+    assert ngl.node_diff(scene.serialize(), _get_scene(ngl.Circle()).serialize()) is None
+    del capture_buffer
+    del ctx
+
+
+def api_scene_swap(width=16, height=16):
+    import zlib
+    shared = _get_scene()
+    scenes = (
+        ngl.Group(children=(shared,)),
+        ngl.Group(children=(ngl.Translate(shared, vector=(0.5, 0.0, 0.0)), shared)),
+    )
+
+    ref_crcs = []
+    for scene in scenes:
+        capture_buffer = bytearray(width * height * 4)
+        ctx = ngl.Context()
+        assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+        assert ctx.set_scene(scene) == 0
+        assert ctx.draw(0) == 0
+        ref_crcs.append(zlib.crc32(capture_buffer))
+        del ctx
+
+    # The shared nodes are transferred from one scene to the other
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    for i in (0, 1, 0, 1, 1):
+        assert ctx.set_scene(scenes[i]) == 0
+        assert ctx.draw(0) == 0
+        assert zlib.crc32(capture_buffer) == ref_crcs[i]
+
+    # The shared nodes keep their resources: the texture rendered by the
+    # first scene only is still displayed by the second one, in which the
+    # RenderToTexture and its scene are released (no reference is kept on them)
+    texture = ngl.Texture2D(width=16, height=16)
+    render = _get_texture_render(texture)
+    rtt_scene = ngl.Group(children=(ngl.RenderToTexture(_get_scene(), [texture], clear_color=(0.0, 0.0, 1.0, 1.0)), render))
+    assert ctx.set_scene(rtt_scene) == 0
+    del rtt_scene
+    assert ctx.draw(0) == 0
+    ref_crc = zlib.crc32(capture_buffer)
+    capture_buffer[:] = bytearray(len(capture_buffer))
+    assert ctx.set_scene(render) == 0
+    for t in (0, 1):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == ref_crc
+    del capture_buffer
+    del ctx
+
+
+def _get_tint_scene(tint=(1.0, 1.0, 1.0, 1.0)):
+    # The color is constant before 1s and after 2s
+    animkf = [
+        ngl.AnimKeyFrameVec4(1, (1.0, 0.0, 0.0, 1.0)),
+        ngl.AnimKeyFrameVec4(2, (0.0, 1.0, 0.0, 1.0)),
+    ]
+    tint_node = ngl.UniformVec4(value=tint)
+    program = ngl.Program(vertex=_vert, fragment='void main() { ngl_out_color = color * tint; }')
+    scene = ngl.Render(ngl.Quad(), program)
+    scene.update_frag_resources(color=ngl.AnimatedVec4(animkf), tint=tint_node)
+    return scene, tint_node
+
+
+def _get_crc(scene, t, width=16, height=16, **config):
+    import zlib
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer,
+                         **config) == 0
+    assert ctx.set_scene(scene) == 0
+    assert ctx.draw(t) == 0
+    crc = zlib.crc32(capture_buffer)
+    del ctx
+    return crc
+
+
+def api_update_invariance(width=16, height=16):
+    import zlib
+    tint = (0.5, 0.5, 0.5, 1.0)
+    scene, tint_node = _get_tint_scene()
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    assert ctx.set_scene(scene) == 0
+
+    # Before the first key frame, the update of the scene is skipped
+    assert ctx.draw(0) == 0
+    crc = zlib.crc32(capture_buffer)
+    assert ctx.draw(0.5) == 0
+    assert zlib.crc32(capture_buffer) == crc
+    assert crc == _get_crc(_get_tint_scene()[0], 0.5, width, height)
+
+    # A live change invalidates the invariance
+    assert tint_node.set_value(*tint) == 0
+    assert ctx.draw(0.6) == 0
+    live_crc = zlib.crc32(capture_buffer)
+    assert live_crc != crc
+    assert live_crc == _get_crc(_get_tint_scene(tint)[0], 0.6, width, height)
+
+    # Leaving the invariance range
+    assert ctx.draw(1.5) == 0
+    assert zlib.crc32(capture_buffer) != live_crc
+    assert zlib.crc32(capture_buffer) == _get_crc(_get_tint_scene(tint)[0], 1.5, width, height)
+    del capture_buffer
+    del ctx
+
+
+def api_elide_static_frames(width=16, height=16):
+    import zlib
+    tint = (0.5, 0.5, 0.5, 1.0)
+    scene, tint_node = _get_tint_scene()
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer,
+                         elide_static_frames=1) == 0
+    assert ctx.set_scene(scene) == 0
+    assert ctx.draw(0) == 0
+    crc = zlib.crc32(capture_buffer)
+
+    # An elided frame leaves the capture buffer untouched
+    blank = bytearray(width * height * 4)
+    capture_buffer[:] = blank
+    assert ctx.draw(0.5) == 0
+    assert capture_buffer == blank
+
+    # A live change or an animation forces the frame to be drawn
+    assert tint_node.set_value(*tint) == 0
+    assert ctx.draw(0.6) == 0
+    live_crc = zlib.crc32(capture_buffer)
+    assert live_crc != crc
+    assert live_crc == _get_crc(_get_tint_scene(tint)[0], 0.6, width, height)
+    capture_buffer[:] = blank
+    assert ctx.draw(1.5) == 0
+    assert zlib.crc32(capture_buffer) == _get_crc(_get_tint_scene(tint)[0], 1.5, width, height)
+
+    # A new capture buffer invalidates the previous frame
+    capture_buffer = bytearray(width * height * 4)
+    assert ctx.set_capture_buffer(capture_buffer) == 0
+    assert ctx.draw(1.5) == 0
+    assert capture_buffer != blank
+    del capture_buffer
+    del ctx
+
+
+def _get_texture_render(texture):
+    vert = '''
+void main()
+{
+    ngl_out_pos = ngl_projection_matrix * ngl_modelview_matrix * ngl_position;
+    var_tex0_coord = (tex0_coord_matrix * vec4(ngl_uvcoord, 0.0, 1.0)).xy;
+}
+'''
+    frag = 'void main() { ngl_out_color = ngl_texvideo(tex0, var_tex0_coord); }'
+    program = ngl.Program(vertex=vert, fragment=frag)
+    program.update_vert_out_vars(var_tex0_coord=ngl.IOVec2())
+    render = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), program)
+    render.update_frag_resources(tex0=texture)
+    return render
+
+
+def _get_rtt_scene(child, cache=1):
+    texture = ngl.Texture2D(width=16, height=16)
+    rtt = ngl.RenderToTexture(child, [texture], clear_color=(0.0, 0.0, 1.0, 1.0), cache=cache)
+    return ngl.Group(children=(rtt, _get_texture_render(texture)))
+
+
+def api_rtt_cache(width=16, height=16):
+    import zlib
+    tint = (0.5, 0.5, 0.5, 1.0)
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+
+    # The cached texture is reused while the child is invariant, then
+    # invalidated by a live change and by the animation
+    scene, tint_node = _get_tint_scene()
+    assert ctx.set_scene(_get_rtt_scene(scene)) == 0
+    for t in (0, 0.5):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_crc(_get_rtt_scene(_get_tint_scene()[0], cache=0), t, width, height)
+    crc = zlib.crc32(capture_buffer)
+    assert tint_node.set_value(*tint) == 0
+    for t in (0.6, 1.5, 2.5, 3):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_crc(_get_rtt_scene(_get_tint_scene(tint)[0], cache=0), t, width, height)
+    assert zlib.crc32(capture_buffer) != crc
+
+    # A child without update callback is never evaluated: only the live
+    # changes can invalidate its cached output
+    scene, tint_node = _get_tint_scene()
+    assert ctx.set_scene(ngl.Group(children=(_get_rtt_scene(ngl.Identity()), scene))) == 0
+    for t in (0, 0.5):
+        assert ctx.draw(t) == 0
+    ref_scene = ngl.Group(children=(_get_rtt_scene(ngl.Identity(), cache=0), _get_tint_scene()[0]))
+    assert zlib.crc32(capture_buffer) == _get_crc(ref_scene, 0.5, width, height)
+    assert tint_node.set_value(*tint) == 0
+    assert ctx.draw(0.6) == 0
+    ref_scene = ngl.Group(children=(_get_rtt_scene(ngl.Identity(), cache=0), _get_tint_scene(tint)[0]))
+    assert zlib.crc32(capture_buffer) == _get_crc(ref_scene, 0.6, width, height)
+    del capture_buffer
+    del ctx
+
+
+def _get_transform_scene(vector=(0.0, 0.0, 0.0)):
+    # The outer translation is animated between 1s and 2s while the chain of
+    # transforms below it is static, and thus folded
+    animkf = [
+        ngl.AnimKeyFrameVec3(1, (-0.25, 0.0, 0.0)),
+        ngl.AnimKeyFrameVec3(2, (0.25, 0.0, 0.0)),
+    ]
+    translate = ngl.Translate(_get_scene(), vector=vector)
+    scene = ngl.Scale(translate, factors=(0.5, 0.5, 1.0))
+    scene = ngl.Translate(scene, vector=(0.0, 0.25, 0.0))
+    scene = ngl.Translate(scene, anim=ngl.AnimatedVec3(animkf))
+    return scene, translate
+
+
+def api_transform_folding(width=16, height=16):
+    import zlib
+    vector = (0.5, -0.5, 0.0)
+    scene, translate = _get_transform_scene()
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    assert ctx.set_scene(scene) == 0
+    for t in (0, 0.5):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_crc(_get_transform_scene()[0], t, width, height)
+    crc = zlib.crc32(capture_buffer)
+
+    # A live change in the folded chain invalidates the folded matrix, and the
+    # animation of the parent invalidates the world matrix
+    assert translate.set_vector(*vector) == 0
+    for t in (0.6, 1.5, 2.5):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_crc(_get_transform_scene(vector)[0], t, width, height)
+    assert zlib.crc32(capture_buffer) != crc
+    del capture_buffer
+    del ctx
+
+
+def _get_animations(index):
+    # Scalar and vector animations of various lengths, covering the easing
+    # boundaries and the approximated easings
+    o = index * 0.1
+    return dict(
+        f=ngl.AnimatedFloat([
+            ngl.AnimKeyFrameFloat(0.25, o),
+            ngl.AnimKeyFrameFloat(1.5, 0.8 - o, 'exp_in', easing_start_offset=0.2, easing_end_offset=0.9),
+            ngl.AnimKeyFrameFloat(4, 0.3, 'bounce_out'),
+        ]),
+        v2=ngl.AnimatedVec2([
+            ngl.AnimKeyFrameVec2(0, (o, 0.2)),
+            ngl.AnimKeyFrameVec2(3, (0.6, 0.1 + o), 'quadratic_in_out'),
+        ]),
+        v3=ngl.AnimatedVec3([
+            ngl.AnimKeyFrameVec3(0.5, (0.1, o, 0.4)),
+            ngl.AnimKeyFrameVec3(1, (0.3, 0.5, 0.2), 'sinus_out', easing_tolerance=1e-4),
+            ngl.AnimKeyFrameVec3(2, (0.7, 0.1, o), 'circular_in'),
+            ngl.AnimKeyFrameVec3(3.5, (0.2, 0.9, 0.5)),
+        ]),
+        v4=ngl.AnimatedVec4([
+            ngl.AnimKeyFrameVec4(1, (0.1, 0.2, 0.3, o)),
+            ngl.AnimKeyFrameVec4(2.5, (0.9 - o, 0.4, 0.7, 0.6), 'cubic_out'),
+        ]),
+    )
+
+
+def _get_animations_render(index, resources):
+    frag = 'void main() { ngl_out_color = vec4(f, v2.x + v2.y, v3.x * v3.y + v3.z, v4.x * v4.y + v4.z * v4.w); }'
+    program = ngl.Program(vertex=_vert, fragment=frag)
+    quad = ngl.Quad((-1 + index * 0.5, -1, 0), (0.5, 0, 0), (0, 2, 0))
+    render = ngl.Render(quad, program)
+    render.update_frag_resources(**resources)
+    return render
+
+
+def _get_animations_ref_crc(indices, t, width, height):
+    # Reference rendering with the values evaluated node by node
+    uniform_classes = dict(f=ngl.UniformFloat, v2=ngl.UniformVec2, v3=ngl.UniformVec3, v4=ngl.UniformVec4)
+    renders = []
+    for index in indices:
+        anims = _get_animations(index)
+        resources = {name: uniform_classes[name](value=anim.evaluate(t)) for name, anim in anims.items()}
+        renders.append(_get_animations_render(index, resources))
+    return _get_crc(ngl.Group(children=renders), t, width, height)
+
+
+def api_animengine(width=32, height=8):
+    import zlib
+    anims = [_get_animations(i) for i in range(3)]
+    renders = [_get_animations_render(i, anim) for i, anim in enumerate(anims)]
+
+    # The animations of the second render are registered once its time range
+    # is reached
+    scene = ngl.Group(children=(
+        renders[0],
+        ngl.TimeRangeFilter(renders[1], ranges=(ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(2))),
+    ))
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer,
+                         lazy_init=1) == 0
+    assert ctx.set_scene(scene) == 0
+    for t in (0, 0.75, 1.25, 1.75):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_animations_ref_crc((0,), t, width, height)
+    for t in (2.25, 2.75, 3.0):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_animations_ref_crc((0, 1), t, width, height)
+
+    # The animations of the first render are unregistered while the ones of
+    # the third render are registered
+    scene = ngl.Group(children=(renders[1], renders[2]))
+    assert ctx.set_scene(scene) == 0
+    for t in (3.25, 4.5, 0.75, 1.25):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_animations_ref_crc((1, 2), t, width, height)
+    del capture_buffer
+    del ctx
+
+
+def _get_update_threads_scene():
+    import array
+    # Every node updated by the update threads is shared between the two
+    # branches, the time remapping animation also being shared by the two
+    # streamed nodes
+    time_anim = ngl.AnimatedTime([ngl.AnimKeyFrameFloat(0, 0), ngl.AnimKeyFrameFloat(4, 8)])
+    timestamps = ngl.BufferInt64(data=array.array('q', (i * 1000000 for i in range(8))))
+    streamed_f = ngl.StreamedFloat(timestamps, ngl.BufferFloat(data=array.array('f', (i / 8 for i in range(8)))),
+                                   time_anim=time_anim)
+    streamed_v4 = ngl.StreamedVec4(timestamps, ngl.BufferVec4(data=array.array('f', (i / 64 for i in range(32)))),
+                                   time_anim=time_anim)
+    buffer = ngl.AnimatedBufferVec4([
+        ngl.AnimKeyFrameBuffer(0, array.array('f', (0.1, 0.2, 0.3, 1.0) * 4)),
+        ngl.AnimKeyFrameBuffer(3, array.array('f', (0.7, 0.4, 0.1, 1.0) * 4)),
+    ])
+    texture = ngl.Texture2D(data_src=buffer, width=2, height=2)
+    quat = ngl.AnimatedQuat([
+        ngl.AnimKeyFrameQuat(0, (0, 0, 0, 1)),
+        ngl.AnimKeyFrameQuat(4, (0, 0, -0.474, 0.880)),
+    ])
+
+    frag = 'void main() { ngl_out_color = texture(tex, vec2(0.5)) * f + v4; }'
+    branches = []
+    for i in range(2):
+        program = ngl.Program(vertex=_vert, fragment=frag)
+        quad = ngl.Quad((-0.5, -0.5, 0), (0.5, 0, 0), (0, 0.5, 0))
+        render = ngl.Render(quad, program)
+        render.update_frag_resources(tex=texture, f=streamed_f, v4=streamed_v4)
+        branches.append(ngl.Translate(ngl.RotateQuat(render, anim=quat), vector=(i - 0.5, 0, 0)))
+    return ngl.Group(children=branches)
+
+
+def api_update_threads(width=32, height=16):
+    import zlib
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer,
+                         update_threads=4) == 0
+    assert ctx.set_scene(_get_update_threads_scene()) == 0
+    crcs = []
+    for t in (0, 0.5, 1.25, 2.75, 3.5, 4.5, 1.75):
+        assert ctx.draw(t) == 0
+        crc = zlib.crc32(capture_buffer)
+        assert crc == _get_crc(_get_update_threads_scene(), t, width, height)
+        crcs.append(crc)
+    assert len(set(crcs)) == len(crcs)
+    del capture_buffer
+    del ctx
+
+
+def _get_timerange_scene(tint=(1.0, 1.0, 1.0, 1.0)):
+    scene, tint_node = _get_tint_scene(tint)
+    scene = ngl.TimeRangeFilter(scene, ranges=(ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(3)))
+    return scene, tint_node
+
+
+def api_lazy_init(width=16, height=16):
+    import zlib
+    tints = ((0.5, 0.5, 0.5, 1.0), (0.25, 0.5, 1.0, 1.0))
+    scene, tint_node = _get_timerange_scene()
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer,
+                         lazy_init=1) == 0
+    assert ctx.set_scene(scene) == 0
+    assert ctx.draw(0) == 0
+    assert zlib.crc32(capture_buffer) == _get_crc(_get_timerange_scene()[0], 0, width, height)
+
+    # A live change on the child not attached yet must be honored once the
+    # child is attached
+    assert tint_node.set_value(*tints[0]) == 0
+    for t in (0.5, 2.5, 3.5):
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == _get_crc(_get_timerange_scene(tints[0])[0], t, width, height)
+    crc = zlib.crc32(capture_buffer)
+
+    # The attached child follows the live changes like any other node
+    assert tint_node.set_value(*tints[1]) == 0
+    assert ctx.draw(3.6) == 0
+    assert zlib.crc32(capture_buffer) == _get_crc(_get_timerange_scene(tints[1])[0], 3.6, width, height)
+    assert zlib.crc32(capture_buffer) != crc
+    del capture_buffer
+    del ctx
+
+    # The child is only initialized once its time range is about to be
+    # reached: a child failing to initialize only fails the draws from there
+    for lazy_init in (0, 1):
+        child = ngl.TimeRangeFilter(_get_scene(), prefetch_time=-1)
+        scene = ngl.TimeRangeFilter(child, ranges=(ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(3)))
+        ctx = ngl.Context()
+        assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, lazy_init=lazy_init) == 0
+        if not lazy_init:
+            assert ctx.set_scene(scene) != 0
+            del ctx
+            continue
+        assert ctx.set_scene(scene) == 0
+        for t in (0, 1.5):
+            assert ctx.draw(t) == 0
+        assert ctx.draw(2.5) != 0
+        del ctx
+
+    # The HUD tracks the nodes of the child once attached
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, lazy_init=1, hud=1) == 0
+    assert ctx.set_scene(_get_timerange_scene()[0]) == 0
+    for t in (0, 2.5, 3.5):
+        assert ctx.draw(t) == 0
+    del ctx
+
+
 def api_ctx_ownership():
     ctx = ngl.Context()
     ctx2 = ngl.Context()
@@ -190,6 +773,103 @@ def _ret_to_fourcc(ret):
     return chr(x>>24) + chr(x>>16 & 0xff) + chr(x>>8 & 0xff) + chr(x&0xff)
 
 
+def _get_media_scene(frame_cache_size=0, time_anim=None):
+    vert = '''
+void main()
+{
+    ngl_out_pos = ngl_projection_matrix * ngl_modelview_matrix * ngl_position;
+    var_tex0_coord = (tex0_coord_matrix * vec4(ngl_uvcoord, 0.0, 1.0)).xy;
+}
+'''
+    frag = 'void main() { ngl_out_color = ngl_texvideo(tex0, var_tex0_coord); }'
+    media = ngl.Media('ngl-media-test.nut', frame_cache_size=frame_cache_size, time_anim=time_anim)
+    program = ngl.Program(vertex=vert, fragment=frag)
+    program.update_vert_out_vars(var_tex0_coord=ngl.IOVec2())
+    scene = ngl.Render(ngl.Quad((-1, -1, 0), (2, 0, 0), (0, 2, 0)), program)
+    scene.update_frag_resources(tex0=ngl.Texture2D(data_src=media))
+    return scene
+
+
+def api_media_frame_cache(width=64, height=64):
+    import zlib
+    # Scrub back and forth so that the cached frames get served again
+    times = (1.0, 2.0, 1.0, 1.5, 2.0, 1.0, 1.5)
+    crcs = []
+    for frame_cache_size in (0, 64 << 20):
+        capture_buffer = bytearray(width * height * 4)
+        ctx = ngl.Context()
+        assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+        assert ctx.set_scene(_get_media_scene(frame_cache_size)) == 0
+        frame_crcs = []
+        for t in times:
+            assert ctx.draw(t) == 0
+            frame_crcs.append(zlib.crc32(capture_buffer))
+        crcs.append(frame_crcs)
+        del capture_buffer
+        del ctx
+
+    # The cache hits must display the same frames as the decoding, and a
+    # cached frame must not be displayed for a time it does not cover
+    assert crcs[0] == crcs[1]
+    assert len(set(crcs[1][:2] + crcs[1][3:4])) == 3
+
+
+def api_media_time_remap(width=64, height=64):
+    import zlib
+
+    def get_crcs(scene, times):
+        capture_buffer = bytearray(width * height * 4)
+        ctx = ngl.Context()
+        assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+        assert ctx.set_scene(scene) == 0
+        crcs = []
+        for t in times:
+            assert ctx.draw(t) == 0
+            crcs.append(zlib.crc32(capture_buffer))
+        del ctx
+        return crcs
+
+    # Play the media twice as fast from 1s, starting to display it at 2s so
+    # that it is warmed up ahead of time
+    time_anim = ngl.AnimatedTime([
+        ngl.AnimKeyFrameFloat(0, 1),
+        ngl.AnimKeyFrameFloat(2, 1),
+        ngl.AnimKeyFrameFloat(6, 9),
+    ])
+    scene = _get_media_scene(time_anim=time_anim)
+    scene = ngl.TimeRangeFilter(scene, ranges=(ngl.TimeRangeModeNoop(0), ngl.TimeRangeModeCont(2)))
+    remapped_crcs = get_crcs(scene, (0.5, 2.0, 2.5, 3.0, 4.0))
+
+    expected_crcs = get_crcs(_get_media_scene(), (1.0, 3.0, 5.0, 9.0))
+    assert remapped_crcs[1:] == expected_crcs
+
+
+def api_media_upload_ring(width=64, height=64):
+    import zlib
+    # More frames than the 3 pixel unpack buffers of the upload ring
+    times = [0.5 + i * 0.25 for i in range(8)]
+    capture_buffer = bytearray(width * height * 4)
+    ctx = ngl.Context()
+    assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+    assert ctx.set_scene(_get_media_scene()) == 0
+    crcs = []
+    for t in times:
+        assert ctx.draw(t) == 0
+        crcs.append(zlib.crc32(capture_buffer))
+    del ctx
+
+    # Every upload must display its own frame, and the same one as a single
+    # upload into a fresh texture
+    assert len(set(crcs)) == len(times)
+    for t, crc in zip(times, crcs):
+        ctx = ngl.Context()
+        assert ctx.configure(offscreen=1, width=width, height=height, backend=_backend, capture_buffer=capture_buffer) == 0
+        assert ctx.set_scene(_get_media_scene()) == 0
+        assert ctx.draw(t) == 0
+        assert zlib.crc32(capture_buffer) == crc
+        del ctx
+
+
 def api_media_sharing_failure():
     import struct
     ctx = ngl.Context()